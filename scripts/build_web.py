@@ -0,0 +1,146 @@
+"""
+Pre-render the web UI at build time.
+
+Reads the HTML template from src/ota/html_content.h and the UI strings from
+src/ota/translations.h, renders one page per language, minifies and gzips it,
+and writes the result to src/ota/web_ui.h as PROGMEM byte arrays that the
+firmware serves directly with "Content-Encoding: gzip". The stylesheet and
+script in src/ota/assets_content.h get the same treatment, and a hash of
+them is substituted for {{ASSET_VERSION}} so their URLs can be cached forever.
+
+Runs as a PlatformIO pre-build script (extra_scripts = pre:scripts/build_web.py)
+and can also be run by hand: python scripts/build_web.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+LANGUAGES = ("en", "fr")  # Column order in translations.h / Language enum
+
+TEMPLATE_RE = re.compile(r'R"rawliteral\((.*?)\)rawliteral"', re.S)
+ASSET_RE = re.compile(
+    r'static const char (\w+)\[\] PROGMEM = R"rawliteral\((.*?)\)rawliteral"', re.S)
+ENTRY_RE = re.compile(
+    r'\{\s*"(\w+)",\s*"((?:[^"\\]|\\.)*)",\s*"((?:[^"\\]|\\.)*)"\s*\}')
+PLACEHOLDER_RE = re.compile(r"\{\{(\w+)\}\}")
+
+
+def unescape_c(text):
+    # Only \" and \\ are used in the table
+    return re.sub(r"\\(.)", r"\1", text)
+
+
+def load_template(path):
+    with open(path, encoding="utf-8") as f:
+        match = TEMPLATE_RE.search(f.read())
+    if not match:
+        raise RuntimeError("No raw literal found in %s" % path)
+    return match.group(1)
+
+
+def load_assets(path):
+    with open(path, encoding="utf-8") as f:
+        assets = dict(ASSET_RE.findall(f.read()))
+    if not assets:
+        raise RuntimeError("No assets found in %s" % path)
+    return assets
+
+
+def load_translations(path):
+    with open(path, encoding="utf-8") as f:
+        entries = ENTRY_RE.findall(f.read())
+    if not entries:
+        raise RuntimeError("No translations found in %s" % path)
+    return {key: (unescape_c(en), unescape_c(fr)) for key, en, fr in entries}
+
+
+def render(template, translations, lang_index, extra):
+    def substitute(match):
+        key = match.group(1)
+        if key in extra:
+            return extra[key]
+        if key not in translations:
+            raise RuntimeError("Missing translation for {{%s}}" % key)
+        return translations[key][lang_index]
+
+    return PLACEHOLDER_RE.sub(substitute, template)
+
+
+def minify(html):
+    # Conservative: drop comments and indentation but keep line breaks so
+    # the inline JavaScript never depends on automatic semicolon insertion.
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)
+    html = re.sub(r"/\*.*?\*/", "", html, flags=re.S)
+    lines = []
+    for line in html.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    return "\n".join(lines)
+
+
+def to_c_array(name, data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return ("static const uint8_t %s[] PROGMEM = {\n%s\n};\n"
+            "static const size_t %s_LEN = %d;\n" %
+            (name, "\n".join(rows), name, len(data)))
+
+
+def build(project_dir):
+    ota_dir = os.path.join(project_dir, "src", "ota")
+    template = load_template(os.path.join(ota_dir, "html_content.h"))
+    translations = load_translations(os.path.join(ota_dir, "translations.h"))
+    assets = load_assets(os.path.join(ota_dir, "assets_content.h"))
+
+    out = [
+        "// Generated by scripts/build_web.py from html_content.h,",
+        "// assets_content.h and translations.h - do not edit.",
+        "#ifndef WEB_UI_H",
+        "#define WEB_UI_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+    ]
+
+    digest = hashlib.sha1()
+    for name in sorted(assets):
+        data = minify(assets[name]).encode("utf-8")
+        digest.update(data)
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        out.append("// %s: %d bytes minified, %d bytes gzipped" %
+                   (name, len(data), len(packed)))
+        out.append(to_c_array("WEB_%s_GZ" % name, packed))
+    version = digest.hexdigest()[:8]
+    out.append('#define WEB_ASSETS_VERSION "%s"\n' % version)
+
+    for index, lang in enumerate(LANGUAGES):
+        html = render(template, translations, index, {"ASSET_VERSION": version})
+        page = minify(html).encode("utf-8")
+        packed = gzip.compress(page, compresslevel=9, mtime=0)
+        out.append("// %s: %d bytes rendered, %d bytes gzipped" %
+                   (lang, len(page), len(packed)))
+        out.append(to_c_array("WEB_UI_%s_GZ" % lang.upper(), packed))
+    out.append("#endif // WEB_UI_H")
+    content = "\n".join(out) + "\n"
+
+    # Only touch the header when it changes so incremental builds stay fast
+    target = os.path.join(ota_dir, "web_ui.h")
+    if os.path.exists(target):
+        with open(target, encoding="utf-8") as f:
+            if f.read() == content:
+                return
+    with open(target, "w", encoding="utf-8") as f:
+        f.write(content)
+    print("build_web.py: regenerated %s" % os.path.relpath(target, project_dir))
+
+
+if __name__ == "__main__":
+    build(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    build(env["PROJECT_DIR"])  # noqa: F821
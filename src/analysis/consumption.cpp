@@ -0,0 +1,142 @@
+#include "consumption.h"
+#include <math.h>
+#include "../constants.h"
+
+static const float SECONDS_PER_DAY = 86400.0f;
+
+ConsumptionEstimator::ConsumptionEstimator() {
+    reset();
+}
+
+void ConsumptionEstimator::reset() {
+    sumW = sumT = sumY = sumTT = sumTY = 0.0f;
+    scaleCm     = Forecast::INITIAL_SCALE_CM;
+    latest      = 0;
+    since       = 0;
+    samples     = 0;
+    refillVotes = 0;
+    jumpVotes   = 0;
+}
+
+void ConsumptionEstimator::restart(uint32_t timestamp, float distanceCm) {
+    reset();
+    latest  = timestamp;
+    since   = timestamp;
+    fold(0.0f, distanceCm);
+    samples = 1;
+}
+
+void ConsumptionEstimator::fold(float t, float y) {
+    sumW  += 1.0f;
+    sumT  += t;
+    sumY  += y;
+    sumTT += t * t;
+    sumTY += t * y;
+}
+
+// Age all readings by `days`: decay their weight and move the time origin
+// forward so the newest reading sits at t = 0
+void ConsumptionEstimator::shiftOrigin(float days) {
+    float decay = expf(-days / Forecast::TAU_DAYS);
+    sumW  *= decay;
+    sumT  *= decay;
+    sumY  *= decay;
+    sumTT *= decay;
+    sumTY *= decay;
+
+    // Sums over (t - days) expressed with the sums over t
+    sumTT = sumTT - 2.0f * days * sumT + days * days * sumW;
+    sumTY = sumTY - days * sumY;
+    sumT  = sumT - days * sumW;
+}
+
+float ConsumptionEstimator::predict(float t) const {
+    float det = sumW * sumTT - sumT * sumT;
+    if (samples < 2 || det <= 1e-6f * sumW * sumW) {
+        return sumY / sumW;   // All readings at (nearly) the same time
+    }
+    float slope = (sumW * sumTY - sumT * sumY) / det;
+    float intercept = (sumY - slope * sumT) / sumW;
+    return intercept + slope * t;
+}
+
+bool ConsumptionEstimator::add(uint32_t timestamp, float distanceCm) {
+    if (samples == 0) {
+        restart(timestamp, distanceCm);
+        return false;
+    }
+    if (timestamp <= latest) {
+        return false;   // Out of order or duplicate
+    }
+
+    shiftOrigin((timestamp - latest) / SECONDS_PER_DAY);
+    latest = timestamp;
+
+    float expected = predict(0.0f);
+    float residual = distanceCm - expected;
+
+    // Salt added: the distance falls suddenly. One low reading may be a
+    // glitch, so wait for confirmation before starting a new fit.
+    if (residual < -Forecast::REFILL_DROP_CM) {
+        jumpVotes = 0;
+        if (++refillVotes >= Forecast::REFILL_CONFIRM) {
+            restart(timestamp, distanceCm);
+            return true;
+        }
+        return false;
+    }
+    refillVotes = 0;
+
+    // A lasting jump the other way (a salt bridge collapsing, or a bad
+    // first reading) is not a refill, but the old line is just as useless
+    if (residual > Forecast::REFILL_DROP_CM) {
+        if (++jumpVotes >= Forecast::REFILL_CONFIRM) {
+            restart(timestamp, distanceCm);
+        }
+        return false;
+    }
+    jumpVotes = 0;
+
+    float limit = Forecast::HUBER_K * scaleCm;
+    float clipped = residual;
+    if (clipped > limit)  clipped = limit;
+    if (clipped < -limit) clipped = -limit;
+
+    fold(0.0f, expected + clipped);
+    scaleCm += Forecast::SCALE_ALPHA * (fabsf(clipped) - scaleCm);
+    if (scaleCm < Forecast::MIN_SCALE_CM) {
+        scaleCm = Forecast::MIN_SCALE_CM;
+    }
+    if (samples < UINT16_MAX) {
+        samples++;
+    }
+    return false;
+}
+
+bool ConsumptionEstimator::estimate(float emptyDistanceCm, ConsumptionEstimate& out) const {
+    if (samples < Forecast::MIN_SAMPLES ||
+        (latest - since) < Forecast::MIN_SPAN_DAYS * SECONDS_PER_DAY) {
+        return false;
+    }
+
+    float det = sumW * sumTT - sumT * sumT;
+    if (det <= 1e-6f * sumW * sumW) {
+        return false;
+    }
+    float slope = (sumW * sumTY - sumT * sumY) / det;
+    out.rateCmPerDay = slope;
+    out.levelCm = (sumY - slope * sumT) / sumW;
+
+    float days = -1.0f;
+    if (out.levelCm >= emptyDistanceCm) {
+        days = 0.0f;
+    } else if (slope >= Forecast::MIN_RATE_CM_PER_DAY) {
+        days = (emptyDistanceCm - out.levelCm) / slope;
+        if (days > Forecast::MAX_DAYS) {
+            days = -1.0f;
+        }
+    }
+    out.daysUntilEmpty = days;
+    out.emptyAt = days >= 0.0f ? latest + static_cast<uint32_t>(days * SECONDS_PER_DAY) : 0;
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef ANALYSIS_CONSUMPTION_H
+#define ANALYSIS_CONSUMPTION_H
+
+// Online salt consumption estimate. Deliberately free of Arduino headers so
+// it can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ConsumptionEstimate {
+    float    rateCmPerDay;     // Growth of the distance per day (salt used)
+    float    levelCm;          // Fitted distance at the latest reading
+    float    daysUntilEmpty;   // -1 when the level is not dropping
+    uint32_t emptyAt;          // Predicted Unix time of empty, 0 if none
+};
+
+/**
+ * Incremental robust line fit of distance against time since the last refill.
+ *
+ * Each reading updates exponentially weighted least-squares sums in O(1)
+ * (time constant Forecast::TAU_DAYS, so the rate follows changes in usage).
+ * Readings far from the current fit are clipped to a multiple of the
+ * running mean absolute residual before they are folded in (Huber-style),
+ * so single echo glitches barely move the line. Times are kept relative to
+ * the latest reading, which keeps the float sums well conditioned however
+ * long the tank goes between refills.
+ *
+ * A refill (the distance dropping well below the fit on consecutive
+ * readings) restarts the fit from the new level; so does a lasting jump
+ * upwards, without being reported as a refill.
+ */
+class ConsumptionEstimator {
+public:
+    ConsumptionEstimator();
+
+    void reset();
+
+    /**
+     * Fold in one reading (timestamps in increasing order)
+     *
+     * @return true if the reading confirmed a refill and restarted the fit
+     */
+    bool add(uint32_t timestamp, float distanceCm);
+
+    /**
+     * Current estimate
+     *
+     * @param emptyDistanceCm Distance at which the tank counts as empty
+     * @return false until enough readings span enough time since the refill
+     */
+    bool estimate(float emptyDistanceCm, ConsumptionEstimate& out) const;
+
+    // Timestamp of the latest reading folded in, 0 if none
+    uint32_t lastTimestamp() const { return latest; }
+
+private:
+    void  restart(uint32_t timestamp, float distanceCm);
+    void  fold(float t, float y);
+    void  shiftOrigin(float days);
+    float predict(float t) const;
+
+    // Weighted sums, time in days relative to the latest reading (t <= 0)
+    float sumW;
+    float sumT;
+    float sumY;
+    float sumTT;
+    float sumTY;
+
+    float    scaleCm;         // Running mean absolute residual
+    uint32_t latest;          // Origin of the time axis
+    uint32_t since;           // First reading of this fit (after the refill)
+    uint16_t samples;
+    uint8_t  refillVotes;     // Consecutive readings far below the fit
+    uint8_t  jumpVotes;       // Consecutive readings far above it
+};
+
+#endif // ANALYSIS_CONSUMPTION_H
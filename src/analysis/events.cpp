@@ -0,0 +1,113 @@
+#include "events.h"
+#include <math.h>
+#include "../constants.h"
+
+const char* levelEventName(LevelEventType type) {
+    switch (type) {
+        case LevelEventType::REFILL:       return "refill";
+        case LevelEventType::REGENERATION: return "regeneration";
+        default:                           return "glitch";
+    }
+}
+
+LevelEventDetector::LevelEventDetector() {
+    reset();
+}
+
+void LevelEventDetector::reset() {
+    windowCount   = 0;
+    windowPos     = 0;
+    holding       = false;
+    heldTimestamp = 0;
+    heldCm        = 0.0f;
+}
+
+// Median of the accepted readings (three at most, so no sorting needed)
+float LevelEventDetector::reference() const {
+    if (windowCount < 3) {
+        return windowCount == 1 ? window[0] : (window[0] + window[1]) / 2.0f;
+    }
+    float a = window[0], b = window[1], c = window[2];
+    return fmaxf(fminf(a, b), fminf(fmaxf(a, b), c));
+}
+
+void LevelEventDetector::accept(float distanceCm) {
+    window[windowPos] = distanceCm;
+    windowPos = (windowPos + 1) % 3;
+    if (windowCount < 3) {
+        windowCount++;
+    }
+}
+
+static bool departs(float deviation) {
+    return fabsf(deviation) >= Events::STEP_MIN_CM;
+}
+
+bool LevelEventDetector::add(uint32_t timestamp, float distanceCm, LevelEvent& out) {
+    if (windowCount == 0) {
+        accept(distanceCm);
+        return false;
+    }
+
+    float ref = reference();
+    float deviation = distanceCm - ref;
+
+    if (!holding) {
+        if (departs(deviation)) {
+            holding       = true;
+            heldTimestamp = timestamp;
+            heldCm        = distanceCm;
+        } else {
+            accept(distanceCm);
+        }
+        return false;
+    }
+
+    // Second reading after a departure: confirms a step or exposes a glitch
+    holding = false;
+    float heldDeviation = heldCm - ref;
+    float tolerance = fmaxf(Events::CONFIRM_TOLERANCE_CM, 0.25f * fabsf(heldDeviation));
+    bool sameWay = departs(deviation) && (deviation > 0) == (heldDeviation > 0);
+
+    if (sameWay && fabsf(distanceCm - heldCm) <= tolerance) {
+        float level = (heldCm + distanceCm) / 2.0f;
+        float delta = level - ref;
+
+        // The reference restarts at the new level
+        windowCount = 0;
+        windowPos   = 0;
+        accept(heldCm);
+        accept(distanceCm);
+
+        out.timestamp = heldTimestamp;
+        out.deltaCm   = delta;
+        out.levelCm   = level;
+        if (delta <= -Events::REFILL_MIN_CM) {
+            out.type = LevelEventType::REFILL;
+            return true;
+        }
+        if (delta >= Events::STEP_MIN_CM) {
+            out.type = LevelEventType::REGENERATION;
+            return true;
+        }
+        return false;   // Small settling drop: not worth an event
+    }
+
+    bool glitch = fabsf(heldDeviation) >= Events::GLITCH_MIN_CM;
+    if (glitch) {
+        out.timestamp = heldTimestamp;
+        out.type      = LevelEventType::GLITCH;
+        out.deltaCm   = heldDeviation;
+        out.levelCm   = ref;
+    }
+
+    // The new reading is judged on its own
+    if (departs(deviation)) {
+        holding       = true;
+        heldTimestamp = timestamp;
+        heldCm        = distanceCm;
+    } else {
+        accept(distanceCm);
+    }
+    return glitch;
+}
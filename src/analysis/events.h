@@ -0,0 +1,63 @@
+#ifndef ANALYSIS_EVENTS_H
+#define ANALYSIS_EVENTS_H
+
+// Level event classification. Deliberately free of Arduino headers so it
+// can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class LevelEventType : uint8_t {
+    REFILL       = 0,   // Large sudden drop in distance (salt added)
+    REGENERATION = 1,   // Lasting step up in distance (salt dissolved)
+    GLITCH       = 2    // Single reading away from the level, then back
+};
+
+struct LevelEvent {
+    uint32_t       timestamp;   // Of the first reading showing the change
+    LevelEventType type;
+    float          deltaCm;     // Distance change (negative = level rose)
+    float          levelCm;     // Distance after the event (before, for a glitch)
+};
+
+// "refill", "regeneration" or "glitch"
+const char* levelEventName(LevelEventType type);
+
+/**
+ * Classifies the reading stream into refill, regeneration and glitch events.
+ *
+ * The reference level is the median of the last three accepted readings.
+ * A reading that departs from it is held back until the next one: if that
+ * one departs the same way the change is real (a refill when the distance
+ * fell by Events::REFILL_MIN_CM or more, a regeneration step when it rose
+ * by Events::STEP_MIN_CM or more) and the reference moves to the new
+ * level; if it is back near the reference, the held reading was a glitch.
+ * O(1) time and memory per reading.
+ */
+class LevelEventDetector {
+public:
+    LevelEventDetector();
+
+    void reset();
+
+    /**
+     * Feed one valid reading (in time order)
+     *
+     * @param out Receives the event, if any
+     * @return true if an event was recognised
+     */
+    bool add(uint32_t timestamp, float distanceCm, LevelEvent& out);
+
+private:
+    float reference() const;
+    void  accept(float distanceCm);
+
+    float    window[3];        // Last accepted readings (ring)
+    uint8_t  windowCount;
+    uint8_t  windowPos;
+    bool     holding;          // A departing reading awaits confirmation
+    uint32_t heldTimestamp;
+    float    heldCm;
+};
+
+#endif // ANALYSIS_EVENTS_H
@@ -0,0 +1,129 @@
+#include "level_filter.h"
+#include <math.h>
+#include <string.h>
+#include "../sensor/distance.h"
+
+// ---------------------------------------------------------------------------
+// Kalman
+// ---------------------------------------------------------------------------
+void KalmanLevelFilter::reset() {
+    initialised  = false;
+    lastRejected = false;
+    rejects      = 0;
+}
+
+float KalmanLevelFilter::update(float distanceCm, float elapsedHours,
+                                const LevelFilterConfig& cfg) {
+    float r2 = cfg.measurementNoiseCm * cfg.measurementNoiseCm;
+    lastRejected = false;
+
+    if (!initialised) {
+        initialised = true;
+        estimate = distanceCm;
+        variance = r2;
+        return estimate;
+    }
+
+    // Predict: the level wanders by processNoise per sqrt(hour)
+    if (elapsedHours < 0.0f) {
+        elapsedHours = 0.0f;
+    }
+    variance += cfg.processNoiseCm * cfg.processNoiseCm * elapsedHours;
+
+    // Gate on the innovation before letting the reading in
+    float innovation = distanceCm - estimate;
+    float s = variance + r2;
+    if (innovation * innovation > cfg.gateSigma * cfg.gateSigma * s) {
+        // Count only a run of rejects that agree with each other
+        bool agrees = rejects > 0 &&
+                      (distanceCm < estimate) == (rejectedCm < estimate) &&
+                      fabsf(distanceCm - rejectedCm) <= cfg.gateSigma * cfg.measurementNoiseCm;
+        rejects    = agrees ? rejects + 1 : 1;
+        rejectedCm = distanceCm;
+
+        uint8_t needed = innovation < 0.0f ? Filter::MAX_CONSECUTIVE_REJECTS
+                                           : Filter::MAX_REJECTS_RISING;
+        if (rejects < needed) {
+            lastRejected = true;
+            return estimate;
+        }
+        // Persistently off: the level really moved
+        rejects  = 0;
+        estimate = distanceCm;
+        variance = r2;
+        return estimate;
+    }
+    rejects = 0;
+
+    float gain = variance / s;
+    estimate += gain * innovation;
+    variance *= (1.0f - gain);
+    return estimate;
+}
+
+// ---------------------------------------------------------------------------
+// Hampel
+// ---------------------------------------------------------------------------
+void HampelLevelFilter::reset() {
+    count        = 0;
+    pos          = 0;
+    lastRejected = false;
+}
+
+float HampelLevelFilter::update(float distanceCm, const LevelFilterConfig& cfg) {
+    uint8_t window = cfg.window;
+    if (window < 3) window = 3;
+    if (window > Filter::MAX_WINDOW) window = Filter::MAX_WINDOW;
+
+    history[pos] = distanceCm;
+    pos = (pos + 1) % window;
+    if (count < window) {
+        count++;
+    }
+    lastRejected = false;
+
+    float sorted[Filter::MAX_WINDOW];
+    memcpy(sorted, history, count * sizeof(float));
+    float median = medianOfReadings(sorted, count);
+
+    for (uint8_t i = 0; i < count; i++) {
+        sorted[i] = fabsf(history[i] - median);
+    }
+    float sigma = 1.4826f * medianOfReadings(sorted, count);
+    if (sigma < Filter::MIN_SIGMA_CM) {
+        sigma = Filter::MIN_SIGMA_CM;
+    }
+
+    if (fabsf(distanceCm - median) > cfg.gateSigma * sigma) {
+        lastRejected = true;
+        return median;
+    }
+    return distanceCm;
+}
+
+// ---------------------------------------------------------------------------
+// Estimator stage
+// ---------------------------------------------------------------------------
+void LevelEstimator::configure(const LevelFilterConfig& cfg) {
+    if (cfg.type != config.type || cfg.window != config.window) {
+        kalman.reset();
+        hampel.reset();
+    }
+    config = cfg;
+}
+
+float LevelEstimator::update(float distanceCm, float elapsedHours) {
+    switch (config.type) {
+        case LevelFilterType::KALMAN: return kalman.update(distanceCm, elapsedHours, config);
+        case LevelFilterType::HAMPEL: return hampel.update(distanceCm, config);
+        default:                      return distanceCm;
+    }
+}
+
+bool LevelEstimator::rejected() const {
+    switch (config.type) {
+        case LevelFilterType::KALMAN: return kalman.rejected();
+        case LevelFilterType::HAMPEL: return hampel.rejected();
+        default:                      return false;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef ANALYSIS_LEVEL_FILTER_H
+#define ANALYSIS_LEVEL_FILTER_H
+
+// Level estimation across readings. Deliberately free of Arduino headers
+// so it can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../constants.h"
+
+enum class LevelFilterType : uint8_t {
+    NONE   = 0,   // Readings used as measured
+    KALMAN = 1,
+    HAMPEL = 2
+};
+
+struct LevelFilterConfig {
+    LevelFilterType type;
+    float   processNoiseCm;       // Kalman: expected level drift per sqrt(hour)
+    float   measurementNoiseCm;   // Kalman: reading noise (1 sigma)
+    float   gateSigma;            // Outlier threshold in sigmas (both filters)
+    uint8_t window;               // Hampel: readings in the sliding window
+};
+
+/**
+ * 1-D Kalman filter on the distance with a random-walk level model.
+ *
+ * Readings whose innovation exceeds gateSigma standard deviations are
+ * rejected. Rejected readings that agree with each other (within gateSigma
+ * reading sigmas) and lie on the same side of the estimate mean the level
+ * really moved: the filter re-initialises on them after
+ * Filter::MAX_CONSECUTIVE_REJECTS shorter distances, so a refill is followed
+ * within a few readings. Salt is never used up that fast, so a longer
+ * distance has to persist for Filter::MAX_REJECTS_RISING readings; a few
+ * hours of condensation cannot pass for a low level.
+ */
+class KalmanLevelFilter {
+public:
+    void  reset();
+    float update(float distanceCm, float elapsedHours, const LevelFilterConfig& cfg);
+    bool  rejected() const { return lastRejected; }
+
+private:
+    bool    initialised = false;
+    bool    lastRejected = false;
+    uint8_t rejects = 0;
+    float   rejectedCm = 0.0f;    // Last rejected reading
+    float   estimate = 0.0f;
+    float   variance = 0.0f;
+};
+
+/**
+ * Hampel filter: a reading further than gateSigma robust standard
+ * deviations (1.4826 x MAD) from the median of the last `window` readings
+ * is replaced by that median.
+ */
+class HampelLevelFilter {
+public:
+    void  reset();
+    float update(float distanceCm, const LevelFilterConfig& cfg);
+    bool  rejected() const { return lastRejected; }
+
+private:
+    float   history[Filter::MAX_WINDOW];
+    uint8_t count = 0;
+    uint8_t pos = 0;
+    bool    lastRejected = false;
+};
+
+/**
+ * The estimator stage between the sensor and the alert logic: runs the
+ * configured filter, and starts it afresh when the configuration changes.
+ */
+class LevelEstimator {
+public:
+    void configure(const LevelFilterConfig& cfg);
+
+    /**
+     * @param distanceCm Valid reading (>= 0)
+     * @param elapsedHours Time since the previous reading
+     * @return Estimated distance in cm
+     */
+    float update(float distanceCm, float elapsedHours);
+
+    // The last reading was treated as an outlier
+    bool rejected() const;
+
+private:
+    LevelFilterConfig config = { LevelFilterType::NONE, 0.0f, 0.0f, 0.0f, 0 };
+    KalmanLevelFilter kalman;
+    HampelLevelFilter hampel;
+};
+
+#endif // ANALYSIS_LEVEL_FILTER_H
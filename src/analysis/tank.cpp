@@ -0,0 +1,193 @@
+#include "tank.h"
+#include <algorithm>
+#include <cmath>
+#include <stdlib.h>
+#include "../measurement/snapshot.h"
+
+static constexpr float PI_F = 3.14159265f;
+
+// Simpson sub-intervals per table step (exact for every shape but the
+// horizontal cylinder, whose error stays well below 0.1%)
+static constexpr int SIMPSON_STEPS = 4;
+
+// ---------------------------------------------------------------------------
+// Cross-sections
+// ---------------------------------------------------------------------------
+static float profileArea(const TankGeometry& g, float h) {
+    const TankProfilePoint* p = g.profile;
+    int last = g.profilePoints - 1;
+    if (h <= p[0].heightCm)    return p[0].areaCm2;
+    if (h >= p[last].heightCm) return p[last].areaCm2;
+
+    int i = 1;
+    while (p[i].heightCm < h) {
+        i++;
+    }
+    float frac = (h - p[i - 1].heightCm) / (p[i].heightCm - p[i - 1].heightCm);
+    return p[i - 1].areaCm2 + frac * (p[i].areaCm2 - p[i - 1].areaCm2);
+}
+
+// Horizontal cross-section at h cm above the empty level, in cm2. Unknown
+// dimensions become 1 (or the fill height for a cylinder's diameter), which
+// keeps the shape of the curve for the percentage.
+static float crossSection(const TankGeometry& g, float height, float h) {
+    float d1 = g.dim1Cm > 0.0f ? g.dim1Cm : 1.0f;
+    float d2 = g.dim2Cm > 0.0f ? g.dim2Cm : 1.0f;
+
+    switch (g.shape) {
+        case TankShape::VERTICAL_CYLINDER:
+            return PI_F * d1 * d1 / 4.0f;
+
+        case TankShape::HORIZONTAL_CYLINDER: {
+            float diameter = g.dim1Cm > 0.0f ? g.dim1Cm : height;
+            float y = std::min(std::max(h, 0.0f), diameter);
+            return 2.0f * std::sqrt(y * (diameter - y)) * d2;
+        }
+
+        case TankShape::CONE: {
+            float bottom = std::max(g.dim1Cm, 0.0f);
+            float top    = std::max(g.dim2Cm, 0.0f);
+            if (bottom == 0.0f && top == 0.0f) {
+                bottom = top = 1.0f;
+            }
+            float r = (bottom + (top - bottom) * h / height) / 2.0f;
+            return PI_F * r * r;
+        }
+
+        case TankShape::PROFILE:
+            return profileArea(g, h);
+
+        default:
+            return d1 * d2;
+    }
+}
+
+static bool volumeKnown(const TankGeometry& g) {
+    switch (g.shape) {
+        case TankShape::VERTICAL_CYLINDER:   return g.dim1Cm > 0.0f;
+        case TankShape::CONE:                return g.dim1Cm > 0.0f || g.dim2Cm > 0.0f;
+        case TankShape::PROFILE:             return true;
+        default:                             return g.dim1Cm > 0.0f && g.dim2Cm > 0.0f;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Model
+// ---------------------------------------------------------------------------
+bool TankModel::build(const TankGeometry& g) {
+    ok = false;
+    emptyCm  = g.emptyCm;
+    heightCm = g.emptyCm - g.fullCm;
+    if (!(heightCm > 0.0f) ||
+        (g.shape == TankShape::PROFILE && g.profilePoints < 2)) {
+        return false;
+    }
+    densityKgPerL = g.saltDensityKgPerL;
+    hasVolume     = volumeKnown(g);
+
+    // Composite Simpson over each step, accumulated in cm3
+    float step = heightCm / (Tank::LUT_POINTS - 1);
+    float sub  = step / SIMPSON_STEPS;
+    float cm3  = 0.0f;
+    lut[0] = 0.0f;
+    for (int i = 1; i < Tank::LUT_POINTS; i++) {
+        float h0 = (i - 1) * step;
+        for (int k = 0; k < SIMPSON_STEPS; k++) {
+            float a = h0 + k * sub;
+            cm3 += sub / 6.0f * (crossSection(g, heightCm, a) +
+                                 4.0f * crossSection(g, heightCm, a + sub / 2.0f) +
+                                 crossSection(g, heightCm, a + sub));
+        }
+        lut[i] = cm3 / 1000.0f;
+    }
+
+    ok = lut[Tank::LUT_POINTS - 1] > 0.0f;
+    return ok;
+}
+
+void TankModel::convert(float distanceCm, TankLevel& out) const {
+    if (!ok || distanceCm < 0.0f) {
+        out.percent = out.liters = out.saltKg = -1.0f;
+        return;
+    }
+
+    // Same clamp-and-interpolate lookup as soundSpeedCmPerUs()
+    float x = (emptyCm - distanceCm) / heightCm * (Tank::LUT_POINTS - 1);
+    x = std::fmin(std::fmax(x, 0.0f), static_cast<float>(Tank::LUT_POINTS - 1));
+    int i = std::min(static_cast<int>(x), Tank::LUT_POINTS - 2);
+    float liters = lut[i] + (x - i) * (lut[i + 1] - lut[i]);
+
+    out.percent = liters / lut[Tank::LUT_POINTS - 1] * 100.0f;
+    out.liters  = hasVolume ? liters : -1.0f;
+    out.saltKg  = hasVolume ? liters * densityKgPerL : -1.0f;
+}
+
+bool TankModel::percentTable(float* out) const {
+    if (!ok) {
+        return false;
+    }
+    for (int i = 0; i < Tank::LUT_POINTS; i++) {
+        out[i] = lut[i] / lut[Tank::LUT_POINTS - 1] * 100.0f;
+    }
+    return true;
+}
+
+int parseTankProfile(const char* text, TankProfilePoint* out, int maxPoints) {
+    int n = 0;
+    const char* s = text;
+
+    while (*s) {
+        if (n == maxPoints) {
+            return -1;
+        }
+
+        char* end;
+        float h = strtof(s, &end);
+        if (end == s || *end != ':') {
+            return -1;
+        }
+        s = end + 1;
+        float area = strtof(s, &end);
+        if (end == s || area < 0.0f || (n > 0 && h <= out[n - 1].heightCm)) {
+            return -1;
+        }
+        out[n].heightCm = h;
+        out[n].areaCm2  = area;
+        n++;
+
+        s = end;
+        while (*s == ' ') s++;
+        if (*s == ',') {
+            s++;
+        } else if (*s) {
+            return -1;
+        }
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Shared model (single writer: the main loop, republishing only when the
+// configuration changes, so readers practically never have to retry)
+// ---------------------------------------------------------------------------
+static Snapshot<TankModel> shared[Tank::MAX_TANKS];
+
+void tankSetModel(uint8_t tank, const TankModel& model) {
+    if (tank < Tank::MAX_TANKS) {
+        shared[tank].publish(model);
+    }
+}
+
+void tankLevel(uint8_t tank, float distanceCm, TankLevel& out) {
+    TankModel model;
+    if (tank >= Tank::MAX_TANKS || !shared[tank].read(model)) {
+        out.percent = out.liters = out.saltKg = -1.0f;
+        return;
+    }
+    model.convert(distanceCm, out);
+}
+
+bool tankPercentTable(uint8_t tank, float* out) {
+    TankModel model;
+    return tank < Tank::MAX_TANKS && shared[tank].read(model) && model.percentTable(out);
+}
@@ -0,0 +1,86 @@
+#ifndef ANALYSIS_TANK_H
+#define ANALYSIS_TANK_H
+
+// Tank geometry: distance to fill level, volume and salt mass. Deliberately
+// free of Arduino headers so it can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../constants.h"
+
+enum class TankShape : uint8_t {
+    RECTANGULAR         = 0,   // dim1 x dim2 (width x length)
+    VERTICAL_CYLINDER   = 1,   // dim1 = diameter
+    HORIZONTAL_CYLINDER = 2,   // dim1 = diameter, dim2 = length
+    CONE                = 3,   // Truncated cone: dim1 = bottom, dim2 = top diameter
+    PROFILE             = 4    // Cross-section area given at a few heights
+};
+
+struct TankProfilePoint {
+    float heightCm;            // Above the empty level
+    float areaCm2;             // Horizontal cross-section at that height
+};
+
+struct TankGeometry {
+    TankShape shape;
+    float     fullCm;          // Distance from the sensor when full
+    float     emptyCm;         // and when empty
+    float     dim1Cm;          // Meaning depends on the shape, 0 if not known
+    float     dim2Cm;
+    uint8_t   profilePoints;
+    TankProfilePoint profile[Tank::MAX_PROFILE_POINTS];
+    float     saltDensityKgPerL;
+};
+
+struct TankLevel {
+    float percent;             // 0-100, -1 without a valid model
+    float liters;              // -1 if the dimensions are not set
+    float saltKg;              // -1 if the dimensions are not set
+};
+
+/**
+ * Distance-to-volume model of a tank.
+ *
+ * build() integrates the cross-section of the shape over the fill range
+ * once into a table of Tank::LUT_POINTS cumulative volumes; a conversion is
+ * then a single interpolated lookup. With the dimensions left at 0 the
+ * shape is still used for the percentage (a horizontal cylinder is assumed
+ * to span the fill range), but no volume is reported.
+ */
+class TankModel {
+public:
+    // false if the geometry is unusable (convert() then reports -1, as it
+    // does for a model never built)
+    bool build(const TankGeometry& geometry);
+
+    void convert(float distanceCm, TankLevel& out) const;
+
+    // Percentage at each table step from empty to full (for the web chart)
+    bool percentTable(float* out) const;
+
+private:
+    float lut[Tank::LUT_POINTS];   // Liters (or unit-area volume) at each step
+    float emptyCm;
+    float heightCm;
+    float densityKgPerL;
+    bool  hasVolume;
+    bool  ok = false;              // Until build() succeeds
+};
+
+/**
+ * Parse a profile written as "height:area" pairs, e.g. "0:1200,30:1800,60:2000"
+ *
+ * @return Number of points, or -1 on a syntax error, a height that does not
+ *         increase, a negative area, or more than maxPoints pairs
+ */
+int parseTankProfile(const char* text, TankProfilePoint* out, int maxPoints);
+
+// The model behind every distance-to-level conversion of each tank, so the
+// alert logic and the API cannot disagree. Published from the main loop
+// only (at setup and when a /config change is applied); read from any task.
+// Each conversion copies the whole model (~150 bytes) out of the snapshot.
+void tankSetModel(uint8_t tank, const TankModel& model);
+void tankLevel(uint8_t tank, float distanceCm, TankLevel& out);
+bool tankPercentTable(uint8_t tank, float* out);   // Tank::LUT_POINTS entries
+
+#endif // ANALYSIS_TANK_H
@@ -1,15 +1,47 @@
 #include "bark.h"
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
 #include "../secrets.h"
 #include "../logger.h"
+#include "../net/https_client.h"
 
 #ifndef BARK_SERVER
 // Default Bark server if not defined in secrets.h
 #define BARK_SERVER "https://api.day.app"
 #endif
 
+#ifndef BARK_CA_CERT
+// PEM root certificate of BARK_SERVER (secrets.h); without one the server
+// certificate is not checked
+#define BARK_CA_CERT nullptr
+#endif
+
+// One connection to the Bark server, kept open between notifications
+static HttpsClient bark("bark", BARK_SERVER, BARK_CA_CERT);
+
+// Percent-encode one path segment: every byte outside the RFC 3986
+// unreserved set, so a tank name cannot end the path ('?', '#', '/') or
+// the request line (CR, LF); UTF-8 names go out byte by byte
+static String encodeSegment(const char* text) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    String out;
+    if (!text) {
+        return out;
+    }
+    out.reserve(strlen(text) * 3);
+    for (const char* p = text; *p; p++) {
+        uint8_t c = static_cast<uint8_t>(*p);
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '.' || c == '_' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += HEX_DIGITS[c >> 4];
+            out += HEX_DIGITS[c & 0x0F];
+        }
+    }
+    return out;
+}
+
 bool barkSendLowSaltNotification(const char* barkKey, float distanceCm, float percentFull) {
     // Validate inputs
     if (!barkKey || barkKey[0] == '\0') {
@@ -22,46 +54,31 @@ bool barkSendLowSaltNotification(const char* barkKey, float distanceCm, float pe
         return false;
     }
 
-    // Build notification URL
+    // Build notification path
     // Example: https://api.day.app/<key>/Salt%20Level%20Low/Distance%2045.0cm%20(30%25%20full)
-    String url = String(BARK_SERVER) + "/" + barkKey +
-                 "/Salt%20Level%20Low/" +
-                 "Distance%20" + String(distanceCm, 1) + "cm%20(" +
-                 String(percentFull, 0) + "%25%20full)";
+    String path = String("/") + encodeSegment(barkKey) +
+                  "/Salt%20Level%20Low/" +
+                  "Distance%20" + String(distanceCm, 1) + "cm%20(" +
+                  String(percentFull, 0) + "%25%20full)";
 
-    Logger::infof("Bark URL: %s", url.c_str());
+    Logger::infof("Bark URL: %s%s", BARK_SERVER, path.c_str());
 
-    WiFiClientSecure client;
-    client.setInsecure();  // Skip certificate verification (acceptable for home LAN)
-
-    HTTPClient https;
-    if (!https.begin(client, url)) {
-        Logger::error("Bark: HTTPS begin failed");
-        return false;
-    }
-
-    // Set timeout
-    https.setTimeout(10000); // 10 seconds
-
-    int httpCode = https.GET();
+    String payload;
+    int httpCode = bark.request("GET", path, String(), String(), &payload);
     
     if (httpCode > 0) {
         Logger::infof("Bark HTTP status: %d", httpCode);
         
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = https.getString();
+        if (httpCode == 200) {
             Logger::debugf("Bark response: %s", payload.c_str());
-            https.end();
             return true;
         } else {
-            String payload = https.getString();
             Logger::warnf("Bark unexpected response code: %d, body: %s", httpCode, payload.c_str());
         }
     } else {
-        Logger::errorf("Bark request failed: %s", https.errorToString(httpCode).c_str());
+        Logger::error("Bark request failed: no response");
     }
 
-    https.end();
     return false;
 }
 
@@ -76,31 +93,15 @@ bool barkSendCustomNotification(const char* barkKey, const char* title, const ch
         return false;
     }
 
-    // URL encode the title and message
-    String encodedTitle = String(title);
-    encodedTitle.replace(" ", "%20");
-    
-    String encodedMessage = String(message);
-    encodedMessage.replace(" ", "%20");
-
-    String url = String(BARK_SERVER) + "/" + barkKey + 
-                 "/" + encodedTitle + "/" + encodedMessage;
+    // The title and message carry the user's tank name
+    String path = String("/") + encodeSegment(barkKey) + "/" + encodeSegment(title) +
+                  "/" + encodeSegment(message);
 
-    Logger::debugf("Bark custom notification URL: %s", url.c_str());
-
-    WiFiClientSecure client;
-    client.setInsecure();
-
-    HTTPClient https;
-    if (!https.begin(client, url)) {
-        Logger::error("Bark: HTTPS begin failed");
-        return false;
-    }
+    Logger::debugf("Bark custom notification URL: %s%s", BARK_SERVER, path.c_str());
 
-    https.setTimeout(10000);
-    int httpCode = https.GET();
+    int httpCode = bark.request("GET", path, String(), String());
     
-    bool success = (httpCode == HTTP_CODE_OK);
+    bool success = (httpCode == 200);
     
     if (success) {
         Logger::info("Bark custom notification sent successfully");
@@ -108,6 +109,5 @@ bool barkSendCustomNotification(const char* barkKey, const char* title, const ch
         Logger::errorf("Bark custom notification failed: HTTP %d", httpCode);
     }
     
-    https.end();
     return success;
 }
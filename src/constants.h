@@ -6,28 +6,48 @@ namespace Pins {
     constexpr int TRIG = 5;      // GPIO5  -> JSN-SR04T Trig
     constexpr int ECHO = 18;     // GPIO18 -> JSN-SR04T Echo
     constexpr int RESET_BTN = 0; // GPIO0  -> Boot button (built-in on most ESP32 boards)
+    constexpr int TEMP_PROBE = 4; // GPIO4  -> DS18B20 data (optional, 4.7k pull-up)
 }
 
 // Timing constants
 namespace Timing {
-    constexpr unsigned long MEASURE_INTERVAL_MS = 3600000UL;     // 1 hour
+    constexpr unsigned long MEASURE_INTERVAL_MS = 3600000UL;     // 1 hour (longest adaptive interval)
+    constexpr uint16_t MIN_MEASURE_INTERVAL_S = 60;              // Default shortest adaptive interval
+    constexpr unsigned long ALERT_TICK_MS = 3600000UL;           // Alert counters advance once an hour
+    constexpr unsigned long ALERT_TICK_SLACK_MS = 60000UL;       // A reading this early still takes the tick
     constexpr unsigned long SENSOR_TIMEOUT_US = 30000;           // 30ms timeout
     constexpr unsigned long WIFI_CHECK_INTERVAL_MS = 300000UL;   // 5 minutes
     constexpr unsigned long MQTT_RECONNECT_DELAY_MS = 5000;      // 5 seconds
     constexpr unsigned long SENSOR_READING_DELAY_MS = 50;        // Between multiple readings
+    constexpr unsigned long BURST_TIME_BUDGET_MS = 1000;         // A burst stops pinging after this
+    constexpr unsigned long SENSOR_SWITCH_GAP_MS = 100;          // Quiet time before another sensor pings
+    constexpr unsigned long TEMPERATURE_READ_INTERVAL_MS = 60000UL; // DS18B20 polling period
+    constexpr unsigned long TEMPERATURE_CONVERSION_MS = 750;     // DS18B20 12-bit conversion time
+    constexpr unsigned long TEMPERATURE_MAX_AGE_MS = 10800000UL; // 3 hours; older readings are ignored
     constexpr unsigned long RESET_BUTTON_HOLD_MS = 5000;         // 5 seconds hold to reset
     constexpr unsigned long BUTTON_DEBOUNCE_MS = 50;             // Debounce delay
+    constexpr unsigned long MEASURE_WAIT_TIMEOUT_MS = 2000;      // Max wait for an on-demand burst
+    constexpr uint16_t STATUS_MAX_AGE_S = 60;                    // Serve cached sample if younger
+    constexpr unsigned long STATIC_ASSET_MAX_AGE_S = 31536000UL; // 1 year (URLs are versioned)
+    constexpr unsigned long EVENT_HEALTH_INTERVAL_MS = 5000;     // Health push to live clients
+    constexpr uint32_t EVENT_RETRY_MS = 3000;                    // Browser reconnect delay (SSE)
+    constexpr uint32_t MIN_VALID_EPOCH = 1700000000UL;           // Before this, SNTP has not synced
 }
 
 // Sensor configuration constants
 namespace Sensor {
-    constexpr float SOUND_SPEED_CM_PER_US = 0.0343f;  // Speed of sound in air
+    constexpr float SOUND_SPEED_CM_PER_US = 0.0343f;  // Speed of sound in air at 20 C (no temperature known)
+    constexpr float AIR_TEMP_MIN_C = -40.0f;           // Range of the speed-of-sound table;
+    constexpr float AIR_TEMP_MAX_C = 60.0f;            // readings outside it are rejected
+    constexpr float AIR_TEMP_STEP_C = 5.0f;            // Table resolution (interpolated between)
     constexpr float HYSTERESIS_CM = 3.0f;              // Hysteresis for warning reset
     constexpr float DEFAULT_FULL_DISTANCE_CM = 20.0f;  // Hardware minimum (tank full)
     constexpr float DEFAULT_EMPTY_DISTANCE_CM = 58.0f; // Maximum depth (tank empty)
     constexpr float DEFAULT_WARN_DISTANCE_CM = 45.0f;  // Warning threshold
-    constexpr int MAX_READING_ATTEMPTS = 3;            // Multiple readings for accuracy
-    constexpr float MAX_READING_VARIANCE_CM = 5.0f;    // Maximum acceptable variance
+    constexpr int MIN_READINGS = 2;                    // Valid readings before a burst may stop
+    constexpr int MAX_READING_ATTEMPTS = 9;            // Ping budget of a burst
+    constexpr float MAX_READING_VARIANCE_CM = 1.0f;    // Burst done once the readings' MAD is below this
+    constexpr float ADAPTIVE_CHANGE_CM = 1.0f;         // Change between bursts that means "level moving"
 }
 
 // Network constants
@@ -35,9 +55,30 @@ namespace Network {
     constexpr int WIFI_MAX_CONNECT_ATTEMPTS = 20;
     constexpr int WIFI_CONNECT_DELAY_MS = 500;
     constexpr int HTTP_PORT = 80;
+    constexpr uint32_t HTTP_RX_TIMEOUT_S = 10;          // Drop connections idle this long
+    constexpr int HTTP_MAX_CONCURRENT_REQUESTS = 8;     // Beyond this, answer 503
+    constexpr size_t HTTP_JSON_SLOTS = 4;               // JSON bodies waiting to be sent
+    constexpr size_t HTTP_PENDING_MEASUREMENTS = 4;     // /measure responses waiting for a burst
+    constexpr size_t EVENT_MAX_CLIENTS = 4;             // Open /events streams
     constexpr int WATCHDOG_TIMEOUT_SECONDS = 10;
     constexpr unsigned long PROVISIONING_TIMEOUT_MS = 600000UL;  // 10 minutes
     constexpr int AP_CHANNEL = 6;
+    constexpr const char* NTP_SERVER = "pool.ntp.org";
+    constexpr uint32_t HTTPS_TIMEOUT_MS = 10000;        // Handshake, and each response read
+    constexpr uint32_t HTTPS_IDLE_MS = 30000;           // Keep-alive before the TLS session is freed
+    constexpr size_t HTTPS_MAX_CLIENTS = 4;             // Hosts with a shared connection
+    constexpr size_t HTTPS_HOST_LENGTH = 64;
+    constexpr size_t HTTPS_RESPONSE_LENGTH = 256;       // Body kept for the log; the rest is skipped
+}
+
+// FreeRTOS task configuration
+namespace Tasks {
+    constexpr uint32_t MEASURE_STACK_SIZE = 4096;
+    constexpr int MEASURE_PRIORITY = 2;          // Above loop() (priority 1)
+    constexpr int MEASURE_CORE = 1;              // APP_CPU; WiFi/TCP stack lives on core 0
+    constexpr uint32_t NOTIFY_STACK_SIZE = 8192; // mbedTLS handshake
+    constexpr int NOTIFY_PRIORITY = 1;           // Same as loop(); blocks in socket waits
+    constexpr int NOTIFY_CORE = 1;
 }
 
 // String length limits
@@ -45,15 +86,91 @@ namespace Limits {
     constexpr size_t BARK_KEY_LENGTH = 128;
     constexpr size_t OTA_PASSWORD_LENGTH = 64;
     constexpr size_t NTFY_TOPIC_LENGTH = 64;
+    constexpr size_t TANK_PROFILE_LENGTH = 96;   // "height:area" pairs of a profiled tank
     constexpr size_t TOPIC_BUFFER_LENGTH = 128;
-    constexpr size_t JSON_BUFFER_LENGTH = 512;
+    constexpr size_t JSON_BUFFER_LENGTH = 1024;   // API responses (room for escaped strings)
+    constexpr size_t CONFIG_JSON_LENGTH = 1536;   // /api/config (every tank's settings)
+    constexpr size_t NOTIFY_JSON_LENGTH = 1536;   // /api/notifications (queue and HTTPS counters)
+    constexpr size_t JSON_SLOT_LENGTH = 1536;     // Pooled response body (largest of the above)
+    constexpr size_t HTTP_MAX_BODY_LENGTH = 2048; // Largest buffered request body (not OTA)
     constexpr size_t WIFI_SSID_LENGTH = 32;
     constexpr size_t WIFI_PASSWORD_LENGTH = 64;
 }
 
+// Measurement history (flash ring buffer)
+namespace History {
+    constexpr const char* PARTITION_LABEL = "history";
+    constexpr uint8_t PARTITION_SUBTYPE = 0x40;                  // Custom data subtype, see partitions.csv
+    constexpr size_t MAX_SECTORS = 256;                          // 1 MB at 4 KB per sector
+    constexpr size_t RAM_RECORDS = 64;                           // Buffered before a flash write
+    constexpr unsigned long FLUSH_INTERVAL_MS = 6UL * 3600000UL; // Flush at least every 6 hours
+    constexpr uint32_t DEFAULT_RANGE_S = 7UL * 86400UL;          // /api/history without from=
+    constexpr size_t HOURLY_BUCKETS = 168;                       // Rollup tiers: 1 week of hours,
+    constexpr size_t DAILY_BUCKETS = 366;                        // a year of days
+    constexpr size_t WEEKLY_BUCKETS = 156;                       // and 3 years of weeks
+    constexpr size_t MAX_CHART_POINTS = 2000;                    // Upper bound for /api/history?points=
+}
+
+// Level estimation between the sensor and the alert logic (see analysis/level_filter.h)
+namespace Filter {
+    constexpr uint8_t DEFAULT_TYPE = 1;               // LevelFilterType::KALMAN
+    constexpr float PROCESS_NOISE_CM = 0.3f;          // Kalman: level drift per sqrt(hour)
+    constexpr float MEASUREMENT_NOISE_CM = 1.0f;      // Kalman: reading noise (1 sigma)
+    constexpr float GATE_SIGMA = 3.0f;                // Outlier threshold (both filters)
+    constexpr uint8_t DEFAULT_WINDOW = 7;             // Hampel window (readings)
+    constexpr uint8_t MAX_WINDOW = 15;
+    constexpr uint8_t MAX_CONSECUTIVE_REJECTS = 3;    // Kalman: then accept a refill (shorter distance)
+    constexpr uint8_t MAX_REJECTS_RISING = 24;        // Kalman: a longer distance must last this long
+    constexpr float MIN_SIGMA_CM = 0.3f;              // Hampel: floor for the robust sigma
+}
+
+// Tank geometry (see analysis/tank.h)
+namespace Tank {
+    constexpr uint8_t MAX_TANKS = 3;                       // One JSN-SR04T (two GPIOs) per tank
+    constexpr size_t NAME_LENGTH = 16;
+    constexpr uint8_t DEFAULT_SHAPE = 0;                   // TankShape::RECTANGULAR (linear)
+    constexpr int LUT_POINTS = 33;                         // Volume table entries over the fill range
+    constexpr int MAX_PROFILE_POINTS = 8;
+    constexpr float MAX_DIMENSION_CM = 500.0f;
+    constexpr float DEFAULT_SALT_DENSITY_KG_PER_L = 0.75f; // Bulk density of salt pellets
+}
+
+// Consumption forecast (see analysis/consumption.h)
+namespace Forecast {
+    constexpr float TAU_DAYS = 14.0f;                 // Weight of a reading halves in ~10 days
+    constexpr uint16_t MIN_SAMPLES = 12;              // Readings since refill before estimating
+    constexpr float MIN_SPAN_DAYS = 1.0f;             // and the time they must span
+    constexpr float HUBER_K = 2.5f;                   // Clip residuals beyond K x mean abs residual
+    constexpr float SCALE_ALPHA = 0.05f;              // Smoothing of the residual scale
+    constexpr float INITIAL_SCALE_CM = 1.0f;
+    constexpr float MIN_SCALE_CM = 0.3f;              // Below sensor resolution, never trust less
+    constexpr float REFILL_DROP_CM = 5.0f;            // Distance this far below the fit...
+    constexpr uint8_t REFILL_CONFIRM = 2;             // ...on this many readings in a row = refill
+    constexpr float MIN_RATE_CM_PER_DAY = 0.02f;      // Slower than this counts as not consuming
+    constexpr float MAX_DAYS = 3650.0f;               // Longer forecasts are reported as none
+    constexpr uint32_t REPLAY_S = 30UL * 86400UL;     // History replayed into the fit at boot
+}
+
+// Level event detection (see analysis/events.h)
+namespace Events {
+    constexpr float STEP_MIN_CM = 0.8f;            // Smallest lasting change (regeneration step)
+    constexpr float REFILL_MIN_CM = 5.0f;          // Drop in distance that means salt was added
+    constexpr float GLITCH_MIN_CM = 3.0f;          // Smallest one-off departure reported as a glitch
+    constexpr float CONFIRM_TOLERANCE_CM = 1.0f;   // Second reading this close to the first confirms
+    constexpr size_t LOG_LENGTH = 32;              // Events kept (RAM ring, mirrored to NVS)
+}
+
 // Notification configuration
 namespace Notification {
     constexpr uint8_t CONSECUTIVE_LOW_THRESHOLD = 8;   // Hours of low level before alert
+    constexpr uint8_t FORECAST_ALERT_DAYS = 0;         // Alert ahead of empty (0 = off)
+    constexpr size_t QUEUE_LENGTH = 4;                 // Alerts waiting for delivery
+    constexpr uint8_t BARK_MAX_ATTEMPTS = 5;
+    constexpr uint8_t NTFY_MAX_ATTEMPTS = 5;
+    constexpr uint32_t RETRY_BASE_MS = 15000;          // Doubles with every failed attempt
+    constexpr uint32_t RETRY_MAX_MS = 600000;          // 10 minutes
+    constexpr uint32_t WIFI_WAIT_MS = 5000;            // Re-check while WiFi is down
+    constexpr uint32_t OUTBOX_FLUSH_MS = 60000;        // Batching of retry counter writes
 }
 
 #endif // CONSTANTS_H
\ No newline at end of file
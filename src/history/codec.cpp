@@ -0,0 +1,97 @@
+#include "codec.h"
+
+// Map signed to unsigned so small magnitudes of either sign stay small
+static uint32_t zigzag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+// LEB128: 7 bits per byte, high bit set on all but the last
+static bool putVarint(uint8_t* out, size_t& pos, size_t maxLen, uint32_t v) {
+    do {
+        if (pos >= maxLen) {
+            return false;
+        }
+        uint8_t byte = v & 0x7F;
+        v >>= 7;
+        out[pos++] = v ? (byte | 0x80) : byte;
+    } while (v);
+    return true;
+}
+
+size_t historyEncode(const HistoryRecord* records, size_t count, uint8_t* out, size_t maxLen) {
+    size_t pos = 0;
+    if (count == 0) {
+        return 0;
+    }
+
+    // Unsigned arithmetic throughout: wraps identically in the decoder
+    uint32_t prevTimestamp = records[0].timestamp;
+    uint32_t prevDelta = 0;
+    int32_t  prevDistance = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const HistoryRecord& rec = records[i];
+
+        uint32_t delta = rec.timestamp - prevTimestamp;
+        uint32_t deltaOfDelta = delta - prevDelta;
+        prevTimestamp = rec.timestamp;
+        prevDelta = delta;
+
+        int32_t change = static_cast<int32_t>(rec.distanceMm) - prevDistance;
+        prevDistance = rec.distanceMm;
+        uint32_t value = (zigzag(change) << 1) | (rec.flags & HISTORY_FLAG_SCHEDULED);
+
+        if (!putVarint(out, pos, maxLen, zigzag(static_cast<int32_t>(deltaOfDelta))) ||
+            !putVarint(out, pos, maxLen, value)) {
+            return 0;
+        }
+    }
+    return pos;
+}
+
+// ---------------------------------------------------------------------------
+// Decoder
+// ---------------------------------------------------------------------------
+HistoryDecoder::HistoryDecoder(const uint8_t* data, size_t len, uint32_t firstTimestamp,
+                               size_t count)
+    : data(data), len(len), pos(0), remaining(count),
+      prevTimestamp(firstTimestamp), prevDelta(0), prevDistance(0) {}
+
+bool HistoryDecoder::readVarint(uint32_t& out) {
+    out = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) {
+            return false;
+        }
+        uint8_t byte = data[pos++];
+        out |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;  // Longer than any uint32_t encoding
+}
+
+bool HistoryDecoder::next(HistoryRecord& out) {
+    uint32_t deltaOfDelta;
+    uint32_t value;
+    if (remaining == 0 || !readVarint(deltaOfDelta) || !readVarint(value)) {
+        remaining = 0;
+        return false;
+    }
+    remaining--;
+
+    prevDelta += static_cast<uint32_t>(unzigzag(deltaOfDelta));
+    prevTimestamp += prevDelta;
+    prevDistance += unzigzag(value >> 1);
+
+    out.timestamp  = prevTimestamp;
+    out.distanceMm = static_cast<int16_t>(prevDistance);
+    out.flags      = value & HISTORY_FLAG_SCHEDULED;
+    out.reserved   = 0;
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+
+// Compact encoding for blocks of history records. Deliberately free of
+// Arduino headers so it can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One reading (also the in-RAM layout before encoding)
+struct HistoryRecord {
+    uint32_t timestamp;    // Unix time (UTC) of the reading
+    int16_t  distanceMm;   // Distance in mm, -1 if the burst failed
+    uint8_t  flags;        // HISTORY_FLAG_*
+    uint8_t  reserved;
+};
+
+static const uint8_t HISTORY_FLAG_SCHEDULED = 0x01;  // Interval burst (not on demand)
+
+// Worst case per record: 5-byte timestamp varint + 3-byte distance varint
+static const size_t HISTORY_MAX_ENCODED_RECORD = 8;
+
+/**
+ * Encode records (in time order) as one block
+ *
+ * Timestamps are stored as zigzag varints of the delta-of-delta (0 for a
+ * perfectly regular interval, so one byte), distances as zigzag varints of
+ * the change in mm with the scheduled flag in the low bit (one byte while
+ * the level moves less than 32 mm). A regular hourly log costs about two
+ * bytes per reading instead of eight. Only HISTORY_FLAG_SCHEDULED is kept.
+ *
+ * @param records Records to encode; records[0].timestamp must be stored
+ *                alongside the block and passed to the decoder
+ * @param count Number of records
+ * @param out Destination buffer
+ * @param maxLen Capacity of out
+ * @return Encoded length, or 0 if it does not fit
+ */
+size_t historyEncode(const HistoryRecord* records, size_t count, uint8_t* out, size_t maxLen);
+
+// Sequential decoder for one block produced by historyEncode()
+class HistoryDecoder {
+public:
+    HistoryDecoder(const uint8_t* data, size_t len, uint32_t firstTimestamp, size_t count);
+
+    // Next record; false at the end of the block or on malformed data
+    bool next(HistoryRecord& out);
+
+private:
+    bool readVarint(uint32_t& out);
+
+    const uint8_t* data;
+    size_t         len;
+    size_t         pos;
+    size_t         remaining;
+    uint32_t       prevTimestamp;
+    uint32_t       prevDelta;
+    int32_t        prevDistance;
+};
+
+#endif // HISTORY_CODEC_H
@@ -0,0 +1,90 @@
+#include "event_log.h"
+#include <Preferences.h>
+#include "../logger.h"
+
+static const char* NVS_NAMESPACE = "events";
+static const char* NVS_KEY       = "log";
+
+static int16_t toMm(float cm) {
+    long mm = lroundf(cm * 10.0f);
+    if (mm > INT16_MAX) mm = INT16_MAX;
+    if (mm < INT16_MIN) mm = INT16_MIN;
+    return static_cast<int16_t>(mm);
+}
+
+void EventLog::begin() {
+    mutex = xSemaphoreCreateMutex();
+
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, true);  // Read-only
+    size_t length = prefs.getBytesLength(NVS_KEY);
+    if (length > 0 && length <= sizeof(entries) && length % sizeof(StoredEvent) == 0) {
+        prefs.getBytes(NVS_KEY, entries, length);
+        used = length / sizeof(StoredEvent);
+    }
+    prefs.end();
+    head = 0;
+
+    Logger::infof("Event log: %u events restored", static_cast<unsigned>(used));
+}
+
+// Write the ring out oldest first. Caller holds the mutex.
+void EventLog::save() {
+    StoredEvent ordered[Events::LOG_LENGTH];
+    for (size_t i = 0; i < used; i++) {
+        ordered[i] = entries[(head + i) % Events::LOG_LENGTH];
+    }
+
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, false);
+    if (prefs.putBytes(NVS_KEY, ordered, used * sizeof(StoredEvent)) == 0) {
+        Logger::error("Event log: NVS write failed");
+    }
+    prefs.end();
+}
+
+void EventLog::add(const LevelEvent& event) {
+    StoredEvent stored;
+    stored.timestamp = event.timestamp;
+    stored.deltaMm   = toMm(event.deltaCm);
+    stored.levelMm   = toMm(event.levelCm);
+    stored.type      = static_cast<uint8_t>(event.type);
+    memset(stored.reserved, 0, sizeof(stored.reserved));
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (used == Events::LOG_LENGTH) {
+        entries[head] = stored;
+        head = (head + 1) % Events::LOG_LENGTH;
+    } else {
+        entries[(head + used) % Events::LOG_LENGTH] = stored;
+        used++;
+    }
+    if (event.type != LevelEventType::GLITCH) {
+        save();
+    }
+    xSemaphoreGive(mutex);
+}
+
+size_t EventLog::read(size_t first, LevelEvent* out, size_t maxEvents) {
+    size_t n = 0;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (size_t i = first; i < used && n < maxEvents; i++) {
+        const StoredEvent& stored = entries[(head + i) % Events::LOG_LENGTH];
+        out[n].timestamp = stored.timestamp;
+        out[n].type      = static_cast<LevelEventType>(stored.type);
+        out[n].deltaCm   = stored.deltaMm / 10.0f;
+        out[n].levelCm   = stored.levelMm / 10.0f;
+        n++;
+    }
+    xSemaphoreGive(mutex);
+
+    return n;
+}
+
+size_t EventLog::count() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    size_t n = used;
+    xSemaphoreGive(mutex);
+    return n;
+}
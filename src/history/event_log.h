@@ -0,0 +1,53 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+#include "../analysis/events.h"
+#include "../constants.h"
+
+/**
+ * The last Events::LOG_LENGTH level events, oldest first.
+ *
+ * Entries are packed to 12 bytes and the whole ring is mirrored to NVS as
+ * one blob when a refill or regeneration is logged; glitches are kept in
+ * RAM and saved along with the next of those, so a noisy sensor does not
+ * wear the flash.
+ *
+ * add() belongs to the main loop; read() may be called from any task (the
+ * web server) and is serialised by a mutex.
+ */
+class EventLog {
+public:
+    // Restore the log saved in NVS
+    void begin();
+
+    void add(const LevelEvent& event);
+
+    /**
+     * Copy events in time order
+     *
+     * @param first Index of the first event to copy (0 = oldest)
+     * @return Number of events copied
+     */
+    size_t read(size_t first, LevelEvent* out, size_t maxEvents);
+
+    size_t count();
+
+private:
+    struct StoredEvent {
+        uint32_t timestamp;
+        int16_t  deltaMm;
+        int16_t  levelMm;
+        uint8_t  type;
+        uint8_t  reserved[3];
+    };
+
+    void save();
+
+    SemaphoreHandle_t mutex = nullptr;
+    StoredEvent       entries[Events::LOG_LENGTH];   // Ring, oldest at head
+    size_t            head = 0;
+    size_t            used = 0;
+};
+
+#endif // EVENT_LOG_H
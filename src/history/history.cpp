@@ -0,0 +1,445 @@
+#include "history.h"
+#include "../logger.h"
+
+static const uint32_t UNWRITTEN = 0xFFFFFFFFUL;   // Erased flash
+
+// ---------------------------------------------------------------------------
+// Flash helpers
+// ---------------------------------------------------------------------------
+bool HistoryStore::readBlockHeader(uint32_t sector, uint32_t offset, BlockHeader& out) {
+    if (offset + sizeof(BlockHeader) > SECTOR_SIZE ||
+        esp_partition_read(partition, sector * SECTOR_SIZE + offset, &out, sizeof(out)) != ESP_OK) {
+        return false;
+    }
+    return out.firstTimestamp != UNWRITTEN &&
+           out.length <= MAX_BLOCK_LENGTH &&
+           offset + sizeof(BlockHeader) + out.length <= SECTOR_SIZE;
+}
+
+// Walk the block headers to index a sector; returns its first free offset
+uint32_t HistoryStore::scanSector(uint32_t sector) {
+    uint32_t offset = sizeof(SectorHeader);
+    BlockHeader block;
+
+    firstTimestamp[sector] = UNWRITTEN;
+    sectorRecords[sector] = 0;
+    while (readBlockHeader(sector, offset, block)) {
+        if (sectorRecords[sector] == 0) {
+            firstTimestamp[sector] = block.firstTimestamp;
+        }
+        sectorRecords[sector] += block.count;
+        offset += sizeof(BlockHeader) + block.length;
+    }
+    return offset;
+}
+
+bool HistoryStore::startSector(uint32_t sector, uint32_t sequence) {
+    esp_err_t err = esp_partition_erase_range(partition, sector * SECTOR_SIZE, SECTOR_SIZE);
+    if (err == ESP_OK) {
+        SectorHeader header = { SECTOR_MAGIC, sequence, { UNWRITTEN, UNWRITTEN } };
+        err = esp_partition_write(partition, sector * SECTOR_SIZE, &header, sizeof(header));
+    }
+    if (err != ESP_OK) {
+        Logger::errorf("History: cannot start sector %u (%s)",
+                       static_cast<unsigned>(sector), esp_err_to_name(err));
+        return false;
+    }
+
+    firstTimestamp[sector] = UNWRITTEN;
+    sectorRecords[sector] = 0;
+    headSector = sector;
+    headSequence = sequence;
+    headOffset = sizeof(SectorHeader);
+    return true;
+}
+
+// Encode the RAM ring as one block and append it to the head sector,
+// moving on (and recycling the oldest sector) when it does not fit.
+// Caller holds the mutex.
+void HistoryStore::writePending() {
+    size_t length = historyEncode(pending, pendingCount,
+                                  blockBuffer + sizeof(BlockHeader), MAX_BLOCK_LENGTH);
+    if (length == 0) {
+        Logger::error("History: block encoding failed, readings dropped");
+        pendingCount = 0;
+        return;
+    }
+
+    BlockHeader header;
+    header.firstTimestamp = pending[0].timestamp;
+    header.length         = static_cast<uint16_t>(length);
+    header.count          = static_cast<uint8_t>(pendingCount);
+    header.reserved       = 0xFF;
+    memcpy(blockBuffer, &header, sizeof(header));
+    size_t total = sizeof(header) + length;
+
+    if (headOffset + total > SECTOR_SIZE) {
+        uint32_t next = (headSector + 1) % sectorCount;
+        if (next == oldestSector) {
+            storedRecords -= sectorRecords[oldestSector];
+            oldestSector = (oldestSector + 1) % sectorCount;
+        }
+        if (!startSector(next, headSequence + 1)) {
+            return;
+        }
+    }
+
+    esp_err_t err = esp_partition_write(partition, headSector * SECTOR_SIZE + headOffset,
+                                        blockBuffer, total);
+    if (err != ESP_OK) {
+        // The area may be half-programmed: continue in a fresh sector next time
+        Logger::errorf("History: flash write failed (%s)", esp_err_to_name(err));
+        headOffset = SECTOR_SIZE;
+        return;
+    }
+
+    if (sectorRecords[headSector] == 0) {
+        firstTimestamp[headSector] = header.firstTimestamp;
+    }
+    sectorRecords[headSector] += header.count;
+    storedRecords += header.count;
+    headOffset += total;
+
+    Logger::debugf("History: flushed %u readings in %u bytes",
+                   static_cast<unsigned>(pendingCount), static_cast<unsigned>(total));
+    pendingCount = 0;
+}
+
+// Decode the blocks of one sector that overlap [from, to], counting the
+// first matches off skip. Caller holds the mutex (blockBuffer is shared
+// with writePending()).
+size_t HistoryStore::readSector(uint32_t sector, uint32_t from, uint32_t to, uint32_t& skip,
+                                HistoryRecord* out, size_t maxRecords, bool& pastRange) {
+    size_t n = 0;
+    uint32_t offset = sizeof(SectorHeader);
+    BlockHeader block;
+    bool have = readBlockHeader(sector, offset, block);
+
+    while (have && n < maxRecords) {
+        if (block.firstTimestamp > to) {
+            pastRange = true;
+            break;
+        }
+
+        uint32_t nextOffset = offset + sizeof(BlockHeader) + block.length;
+        BlockHeader nextBlock;
+        bool hasNext = readBlockHeader(sector, nextOffset, nextBlock);
+
+        // Decode only if the range does not start after the next block does
+        if (!hasNext || nextBlock.firstTimestamp >= from) {
+            size_t payload = sector * SECTOR_SIZE + offset + sizeof(BlockHeader);
+            if (esp_partition_read(partition, payload, blockBuffer, block.length) != ESP_OK) {
+                Logger::errorf("History: flash read failed in sector %u",
+                               static_cast<unsigned>(sector));
+                break;
+            }
+
+            HistoryDecoder decoder(blockBuffer, block.length, block.firstTimestamp, block.count);
+            HistoryRecord rec;
+            while (n < maxRecords && decoder.next(rec)) {
+                if (rec.timestamp > to) {
+                    pastRange = true;
+                    return n;
+                }
+                if (rec.timestamp < from) {
+                    continue;
+                }
+                if (skip > 0) {
+                    skip--;
+                } else {
+                    out[n++] = rec;
+                }
+            }
+        }
+
+        block = nextBlock;
+        offset = nextOffset;
+        have = hasNext;
+    }
+    return n;
+}
+
+// Replay the flash log into the rollup tiers (boot only, before any reader)
+void HistoryStore::rebuildRollups() {
+    HistoryRecord batch[32];
+    HistoryPosition pos;
+    size_t n;
+
+    hourly.clear();
+    daily.clear();
+    weekly.clear();
+
+    unsigned long startMs = millis();
+    do {
+        n = read(pos, UNWRITTEN - 1, batch, 32);
+        for (size_t i = 0; i < n; i++) {
+            if (batch[i].distanceMm >= 0) {
+                hourly.add(batch[i].timestamp, batch[i].distanceMm);
+                daily.add(batch[i].timestamp, batch[i].distanceMm);
+                weekly.add(batch[i].timestamp, batch[i].distanceMm);
+            }
+        }
+        if (n > 0) {
+            newestTimestamp = batch[n - 1].timestamp;
+        }
+    } while (n == 32);
+
+    Logger::infof("History: rollups rebuilt in %lu ms", millis() - startMs);
+}
+
+RollupTier* HistoryStore::rollupTier(HistoryTier tier) {
+    switch (tier) {
+        case HistoryTier::HOUR: return &hourly;
+        case HistoryTier::DAY:  return &daily;
+        case HistoryTier::WEEK: return &weekly;
+        default:                return nullptr;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+bool HistoryStore::begin(const char* partitionLabel) {
+    mutex = xSemaphoreCreateMutex();
+    lastFlushMs = millis();
+
+    partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA,
+        static_cast<esp_partition_subtype_t>(History::PARTITION_SUBTYPE),
+        partitionLabel);
+    if (!partition) {
+        Logger::error("History partition not found - readings are kept in RAM only");
+        return false;
+    }
+
+    sectorCount = partition->size / SECTOR_SIZE;
+    if (sectorCount > History::MAX_SECTORS) {
+        sectorCount = History::MAX_SECTORS;
+    }
+    if (sectorCount < 2) {
+        Logger::error("History partition too small");
+        partition = nullptr;
+        return false;
+    }
+
+    // Newest sector is the head, the one with the lowest sequence the oldest
+    bool found = false;
+    uint32_t minSequence = 0;
+    storedRecords = 0;
+    for (uint32_t s = 0; s < sectorCount; s++) {
+        firstTimestamp[s] = UNWRITTEN;
+        sectorRecords[s] = 0;
+
+        SectorHeader header;
+        if (esp_partition_read(partition, s * SECTOR_SIZE, &header, sizeof(header)) != ESP_OK ||
+            header.magic != SECTOR_MAGIC) {
+            continue;
+        }
+
+        uint32_t end = scanSector(s);
+        storedRecords += sectorRecords[s];
+
+        if (!found || header.sequence > headSequence) {
+            headSequence = header.sequence;
+            headSector = s;
+            headOffset = end;
+        }
+        if (!found || header.sequence < minSequence) {
+            minSequence = header.sequence;
+            oldestSector = s;
+        }
+        found = true;
+    }
+
+    if (!found) {
+        Logger::info("History partition empty - formatting");
+        oldestSector = 0;
+        if (!startSector(0, 1)) {
+            partition = nullptr;
+            return false;
+        }
+    }
+
+    Logger::infof("History: %u sectors, %u readings stored",
+                  static_cast<unsigned>(sectorCount), static_cast<unsigned>(count()));
+    rebuildRollups();
+    return true;
+}
+
+void HistoryStore::append(uint32_t timestamp, float distanceCm, bool scheduled) {
+    HistoryRecord rec;
+    long mm = distanceCm < 0 ? -1 : lroundf(distanceCm * 10.0f);
+    rec.timestamp  = timestamp;
+    rec.distanceMm = static_cast<int16_t>(mm > INT16_MAX ? INT16_MAX : mm);
+    rec.flags      = scheduled ? HISTORY_FLAG_SCHEDULED : 0;
+    rec.reserved   = 0;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (timestamp > newestTimestamp) {
+        newestTimestamp = timestamp;
+    }
+    if (rec.distanceMm >= 0) {
+        hourly.add(timestamp, rec.distanceMm);
+        daily.add(timestamp, rec.distanceMm);
+        weekly.add(timestamp, rec.distanceMm);
+    }
+
+    if (pendingCount == History::RAM_RECORDS) {
+        // Only reachable without a partition (or after write errors): drop the oldest
+        memmove(pending, pending + 1, (pendingCount - 1) * sizeof(HistoryRecord));
+        pendingCount--;
+    }
+    pending[pendingCount++] = rec;
+    bool full = (pendingCount == History::RAM_RECORDS);
+    xSemaphoreGive(mutex);
+
+    if (full) {
+        flush();
+    }
+}
+
+void HistoryStore::loop() {
+    if (pendingCount > 0 && millis() - lastFlushMs >= History::FLUSH_INTERVAL_MS) {
+        flush();
+    }
+}
+
+void HistoryStore::flush() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (partition && pendingCount > 0) {
+        writePending();
+    }
+    lastFlushMs = millis();
+    xSemaphoreGive(mutex);
+}
+
+size_t HistoryStore::read(uint32_t from, uint32_t to, HistoryRecord* out, size_t maxRecords,
+                          uint32_t skip) {
+    size_t n = 0;
+    bool pastRange = false;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (partition) {
+        uint32_t s = oldestSector;
+        for (;;) {
+            // Sectors are in time order: stop once one starts after the range
+            if (firstTimestamp[s] != UNWRITTEN && firstTimestamp[s] > to) {
+                pastRange = true;
+                break;
+            }
+
+            // Skip a sector entirely if the next one still starts before the range
+            uint32_t next = (s + 1) % sectorCount;
+            bool before = (s != headSector) && firstTimestamp[next] != UNWRITTEN &&
+                          firstTimestamp[next] < from;
+            if (!before && sectorRecords[s] > 0) {
+                n += readSector(s, from, to, skip, out + n, maxRecords - n, pastRange);
+            }
+
+            if (pastRange || n >= maxRecords || s == headSector) {
+                break;
+            }
+            s = next;
+        }
+    }
+
+    for (size_t i = 0; i < pendingCount && n < maxRecords && !pastRange; i++) {
+        if (pending[i].timestamp < from || pending[i].timestamp > to) {
+            continue;
+        }
+        if (skip > 0) {
+            skip--;
+        } else {
+            out[n++] = pending[i];
+        }
+    }
+    xSemaphoreGive(mutex);
+
+    return n;
+}
+
+size_t HistoryStore::read(HistoryPosition& pos, uint32_t to, HistoryRecord* out, size_t maxRecords) {
+    size_t n = read(pos.from, to, out, maxRecords, pos.skip);
+    pos.advance(out, n);
+    return n;
+}
+
+void HistoryPosition::advance(const HistoryRecord* page, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    // Records of the page's last second; all of them if the page did not
+    // get past the second it started in
+    uint32_t last = page[n - 1].timestamp;
+    uint32_t same = 0;
+    while (same < n && page[n - 1 - same].timestamp == last) {
+        same++;
+    }
+    skip = (last == from) ? skip + same : same;
+    from = last;
+}
+
+uint32_t HistoryStore::count() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t total = storedRecords + pendingCount;
+    xSemaphoreGive(mutex);
+    return total;
+}
+
+uint32_t HistoryStore::newest() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t timestamp = newestTimestamp;
+    xSemaphoreGive(mutex);
+    return timestamp;
+}
+
+uint32_t HistoryStore::tierWidth(HistoryTier tier) {
+    switch (tier) {
+        case HistoryTier::HOUR: return 3600UL;
+        case HistoryTier::DAY:  return 86400UL;
+        case HistoryTier::WEEK: return 604800UL;
+        default:                return 0;
+    }
+}
+
+HistoryTier HistoryStore::pickTier(uint32_t from, uint32_t step) {
+    static const HistoryTier COARSEST_FIRST[] = {
+        HistoryTier::WEEK, HistoryTier::DAY, HistoryTier::HOUR
+    };
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    // Nothing is stored before the oldest raw reading, so a tier that goes
+    // back that far is complete even if from is earlier
+    uint32_t oldestRaw = UNWRITTEN;
+    if (partition && sectorRecords[oldestSector] > 0) {
+        oldestRaw = firstTimestamp[oldestSector];
+    } else if (pendingCount > 0) {
+        oldestRaw = pending[0].timestamp;
+    }
+    uint32_t needed = from > oldestRaw ? from : oldestRaw;
+
+    HistoryTier picked = HistoryTier::RAW;
+    for (size_t i = 0; i < sizeof(COARSEST_FIRST) / sizeof(COARSEST_FIRST[0]); i++) {
+        RollupTier* t = rollupTier(COARSEST_FIRST[i]);
+        if (t->width() <= step && t->oldestStart() <= needed) {
+            picked = COARSEST_FIRST[i];
+            break;
+        }
+    }
+    xSemaphoreGive(mutex);
+    return picked;
+}
+
+size_t HistoryStore::readRollup(HistoryTier tier, uint32_t from, uint32_t to,
+                                RollupBucket* out, size_t maxBuckets) {
+    RollupTier* t = rollupTier(tier);
+    if (!t) {
+        return 0;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    size_t n = t->read(from, to, out, maxBuckets);
+    xSemaphoreGive(mutex);
+    return n;
+}
@@ -0,0 +1,160 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "codec.h"
+#include "rollup.h"
+#include "../constants.h"
+
+// Resolution a history query is answered from
+enum class HistoryTier : uint8_t {
+    RAW,
+    HOUR,
+    DAY,
+    WEEK
+};
+
+// Resume point of a paged read. Several readings can share a second (an
+// on-demand burst next to a scheduled one), so a page ending inside that
+// second resumes at it and skips what was already returned; resuming at
+// last.timestamp + 1 would drop the rest.
+struct HistoryPosition {
+    uint32_t from;   // Timestamp to continue from
+    uint32_t skip;   // Records at from already returned
+
+    explicit HistoryPosition(uint32_t start = 0) : from(start), skip(0) {}
+
+    // Move past a page of n records (in time order, from this position)
+    void advance(const HistoryRecord* page, size_t n);
+};
+
+/**
+ * Fixed-memory measurement history.
+ *
+ * New readings collect in a small RAM ring and are appended to a dedicated
+ * flash partition in batches (when the ring fills or FLUSH_INTERVAL_MS
+ * passes). Each batch is written as one compressed block (see codec.h)
+ * behind an 8-byte header holding its first timestamp, so range queries
+ * walk the headers and only decode blocks that overlap the range.
+ *
+ * The partition is used as a circular log of 4 KB sectors, each starting
+ * with a header carrying a sequence number; once it is full the oldest
+ * sector is erased and reused. A per-sector index of first timestamps and
+ * record counts is kept in RAM. Nothing is allocated after begin().
+ *
+ * Hourly, daily and weekly rollups (count/min/max/mean/variance) are kept
+ * in RAM alongside, updated in O(1) by append() and rebuilt from flash at
+ * boot, so long ranges can be answered without touching the raw log.
+ *
+ * append()/loop()/flush() belong to the main loop; read() may be called
+ * from any task (the web server) and is serialised by a mutex.
+ */
+class HistoryStore {
+public:
+    // Find and scan the partition; false if it is missing (history then
+    // lives in RAM only)
+    bool begin(const char* partitionLabel);
+
+    void append(uint32_t timestamp, float distanceCm, bool scheduled);
+
+    // Flush when the interval elapses
+    void loop();
+
+    // Write buffered readings to flash now (e.g. before a restart)
+    void flush();
+
+    /**
+     * Copy stored readings in time order
+     *
+     * @param from First timestamp to return (inclusive)
+     * @param to Last timestamp to return (inclusive)
+     * @param out Destination array
+     * @param maxRecords Capacity of out
+     * @param skip Records at the start of the range to leave out
+     * @return Number of records copied; fewer than maxRecords means the
+     *         range is exhausted
+     */
+    size_t read(uint32_t from, uint32_t to, HistoryRecord* out, size_t maxRecords,
+                uint32_t skip = 0);
+
+    // Next page of a paged read, moving pos past the records returned
+    size_t read(HistoryPosition& pos, uint32_t to, HistoryRecord* out, size_t maxRecords);
+
+    // Readings currently stored (flash and RAM)
+    uint32_t count();
+
+    // Timestamp of the latest reading stored, 0 if none
+    uint32_t newest();
+
+    /**
+     * Coarsest rollup tier whose buckets are no wider than step and that
+     * reaches back to from (or to the oldest raw reading); RAW otherwise
+     */
+    HistoryTier pickTier(uint32_t from, uint32_t step);
+
+    // Bucket width of a tier in seconds (0 for RAW)
+    static uint32_t tierWidth(HistoryTier tier);
+
+    /**
+     * Copy rollup buckets overlapping [from, to] in time order
+     *
+     * @return Number of buckets copied; resume with from = last.start + tierWidth()
+     */
+    size_t readRollup(HistoryTier tier, uint32_t from, uint32_t to,
+                      RollupBucket* out, size_t maxBuckets);
+
+private:
+    struct SectorHeader {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t reserved[2];
+    };
+
+    struct BlockHeader {
+        uint32_t firstTimestamp;   // 0xFFFFFFFF: no block here (erased flash)
+        uint16_t length;           // Encoded payload bytes following the header
+        uint8_t  count;            // Records in the block
+        uint8_t  reserved;
+    };
+
+    static const uint32_t SECTOR_SIZE = 4096;
+    static const uint32_t SECTOR_MAGIC = 0x32534948;  // "HIS2"
+    static const size_t   MAX_BLOCK_LENGTH = History::RAM_RECORDS * HISTORY_MAX_ENCODED_RECORD;
+
+    bool     readBlockHeader(uint32_t sector, uint32_t offset, BlockHeader& out);
+    uint32_t scanSector(uint32_t sector);
+    bool     startSector(uint32_t sector, uint32_t sequence);
+    void     writePending();
+    size_t   readSector(uint32_t sector, uint32_t from, uint32_t to, uint32_t& skip,
+                        HistoryRecord* out, size_t maxRecords, bool& pastRange);
+    void     rebuildRollups();
+    RollupTier* rollupTier(HistoryTier tier);
+
+    const esp_partition_t* partition = nullptr;
+    SemaphoreHandle_t      mutex = nullptr;
+
+    uint32_t sectorCount = 0;
+    uint32_t oldestSector = 0;
+    uint32_t headSector = 0;
+    uint32_t headSequence = 0;
+    uint32_t headOffset = 0;                        // Next free byte in the head sector
+    uint32_t storedRecords = 0;                     // Records in flash
+    uint32_t firstTimestamp[History::MAX_SECTORS];  // Per sector, for skipping on read
+    uint16_t sectorRecords[History::MAX_SECTORS];
+
+    HistoryRecord pending[History::RAM_RECORDS];
+    size_t        pendingCount = 0;
+    unsigned long lastFlushMs = 0;
+    uint32_t      newestTimestamp = 0;
+    uint8_t       blockBuffer[sizeof(BlockHeader) + MAX_BLOCK_LENGTH];  // Under the mutex
+
+    RollupBucket hourlyBuckets[History::HOURLY_BUCKETS];
+    RollupBucket dailyBuckets[History::DAILY_BUCKETS];
+    RollupBucket weeklyBuckets[History::WEEKLY_BUCKETS];
+    RollupTier   hourly{3600UL, 0, hourlyBuckets, History::HOURLY_BUCKETS};
+    RollupTier   daily{86400UL, 0, dailyBuckets, History::DAILY_BUCKETS};
+    RollupTier   weekly{604800UL, 345600UL, weeklyBuckets, History::WEEKLY_BUCKETS};  // Mondays
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,127 @@
+#include "lttb.h"
+#include <math.h>
+
+void LttbDownsampler::begin(uint32_t from, uint32_t to, size_t points) {
+    rangeFrom   = from;
+    rangeSpan   = to - from + 1;
+    bucketCount = points > 3 ? static_cast<uint32_t>(points - 2) : 1;
+    started     = false;
+    finished    = false;
+    pending.count = 0;
+    current.count = 0;
+    queueHead = 0;
+    queueLen  = 0;
+}
+
+uint32_t LttbDownsampler::bucketOf(uint32_t timestamp) const {
+    uint64_t span = rangeSpan ? rangeSpan : (1ULL << 32);
+    uint64_t index = static_cast<uint64_t>(timestamp - rangeFrom) * bucketCount / span;
+    return index < bucketCount ? static_cast<uint32_t>(index) : bucketCount - 1;
+}
+
+void LttbDownsampler::emit(const LttbPoint& p) {
+    if (queueLen == QUEUE_LENGTH) {
+        return;   // Not reachable when pop() is drained after every call
+    }
+    queue[(queueHead + queueLen) % QUEUE_LENGTH] = p;
+    queueLen++;
+    anchor = p;
+}
+
+void LttbDownsampler::fold(Bucket& b, const LttbPoint& p, float relTime) {
+    if (b.count == 0) {
+        for (size_t i = 0; i < 4; i++) {
+            b.candidates[i] = p;
+        }
+        b.sumTime = 0.0f;
+        b.sumValue = 0.0f;
+    }
+    b.candidates[1] = p;
+    if (p.value < b.candidates[2].value) b.candidates[2] = p;
+    if (p.value > b.candidates[3].value) b.candidates[3] = p;
+    b.sumTime += relTime;
+    b.sumValue += p.value;
+    b.count++;
+}
+
+// Emit the candidate of b spanning the largest triangle with the anchor
+// and (nextTime, nextValue)
+void LttbDownsampler::select(const Bucket& b, float nextTime, float nextValue) {
+    float ax = static_cast<float>(anchor.timestamp - rangeFrom);
+    float ay = anchor.value;
+    const LttbPoint* best = nullptr;
+    float bestArea = -1.0f;
+
+    for (size_t i = 0; i < 4; i++) {
+        const LttbPoint& c = b.candidates[i];
+        if (c.timestamp <= anchor.timestamp) {
+            continue;
+        }
+        float bx = static_cast<float>(c.timestamp - rangeFrom);
+        float area = fabsf((ax - nextTime) * (c.value - ay) - (ax - bx) * (nextValue - ay));
+        if (area > bestArea) {
+            bestArea = area;
+            best = &c;
+        }
+    }
+    if (best) {
+        emit(*best);
+    }
+}
+
+void LttbDownsampler::add(uint32_t timestamp, float value) {
+    if (finished) {
+        return;
+    }
+
+    LttbPoint p = { timestamp, value };
+    lastSample = p;
+    if (!started) {
+        started = true;
+        emit(p);
+        return;
+    }
+
+    uint32_t index = bucketOf(timestamp);
+    if (current.count > 0 && index != current.index) {
+        // current is complete: its mean decides the pending bucket
+        if (pending.count > 0) {
+            select(pending, current.sumTime / current.count, current.sumValue / current.count);
+        }
+        pending = current;
+        current.count = 0;
+    }
+    fold(current, p, static_cast<float>(timestamp - rangeFrom));
+    current.index = index;
+}
+
+void LttbDownsampler::finish() {
+    if (!started || finished) {
+        return;
+    }
+    finished = true;
+
+    if (pending.count > 0) {
+        if (current.count > 0) {
+            select(pending, current.sumTime / current.count, current.sumValue / current.count);
+        } else {
+            select(pending, static_cast<float>(lastSample.timestamp - rangeFrom), lastSample.value);
+        }
+    }
+    if (current.count > 0) {
+        select(current, static_cast<float>(lastSample.timestamp - rangeFrom), lastSample.value);
+    }
+    if (anchor.timestamp != lastSample.timestamp) {
+        emit(lastSample);
+    }
+}
+
+bool LttbDownsampler::pop(LttbPoint& out) {
+    if (queueLen == 0) {
+        return false;
+    }
+    out = queue[queueHead];
+    queueHead = (queueHead + 1) % QUEUE_LENGTH;
+    queueLen--;
+    return true;
+}
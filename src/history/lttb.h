@@ -0,0 +1,77 @@
+#ifndef HISTORY_LTTB_H
+#define HISTORY_LTTB_H
+
+// Streaming Largest-Triangle-Three-Buckets downsampling. Deliberately free
+// of Arduino headers so it can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct LttbPoint {
+    uint32_t timestamp;
+    float    value;
+};
+
+/**
+ * Reduce a time series to about a requested number of points in one pass.
+ *
+ * [from, to] is split into equal time buckets. Classic LTTB keeps, from
+ * each bucket, the sample forming the largest triangle with the point kept
+ * from the previous bucket and the mean of the next one, which keeps
+ * spikes (refills) that averaging would flatten. Here each bucket is
+ * reduced on the fly to its first, last, minimum and maximum samples (the
+ * only candidates that matter visually), so memory is constant and the
+ * choice for a bucket is made as soon as the following one is complete.
+ *
+ * Usage: begin(), then add() samples in time order, draining pop() after
+ * each; finish() once the input is exhausted and drain pop() again. The
+ * first and last samples are always kept; empty buckets yield nothing.
+ */
+class LttbDownsampler {
+public:
+    /**
+     * @param from Start of the range (Unix time)
+     * @param to End of the range (inclusive)
+     * @param points Target number of points (at least 3)
+     */
+    void begin(uint32_t from, uint32_t to, size_t points);
+
+    void add(uint32_t timestamp, float value);
+
+    // Flush the last buckets after the final add()
+    void finish();
+
+    // Next selected point; false when none is ready
+    bool pop(LttbPoint& out);
+
+private:
+    struct Bucket {
+        LttbPoint candidates[4];   // First, last, min, max
+        size_t    count;           // Samples folded in
+        uint32_t  index;
+        float     sumTime;         // Relative to rangeFrom, for the mean
+        float     sumValue;
+    };
+
+    static const size_t QUEUE_LENGTH = 4;
+
+    uint32_t bucketOf(uint32_t timestamp) const;
+    void     emit(const LttbPoint& p);
+    void     select(const Bucket& b, float nextTime, float nextValue);
+    static void fold(Bucket& b, const LttbPoint& p, float relTime);
+
+    uint32_t  rangeFrom;
+    uint32_t  rangeSpan;       // to - from + 1, 0 meaning 2^32
+    uint32_t  bucketCount;
+    bool      started;
+    bool      finished;
+    LttbPoint anchor;          // Last point emitted (the triangle's "A")
+    LttbPoint lastSample;
+    Bucket    pending;         // Complete, waiting for the next bucket's mean
+    Bucket    current;         // Being filled
+    LttbPoint queue[QUEUE_LENGTH];
+    size_t    queueHead;
+    size_t    queueLen;
+};
+
+#endif // HISTORY_LTTB_H
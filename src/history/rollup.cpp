@@ -0,0 +1,89 @@
+#include "rollup.h"
+#include <math.h>
+
+float RollupBucket::stddevMm() const {
+    return count > 1 ? sqrtf(m2 / (count - 1)) : 0.0f;
+}
+
+RollupTier::RollupTier(uint32_t width, uint32_t alignment, RollupBucket* storage, size_t capacity)
+    : bucketWidth(width), alignment(alignment), buckets(storage), capacity(capacity) {
+    clear();
+}
+
+void RollupTier::clear() {
+    head = 0;
+    used = 0;
+}
+
+uint32_t RollupTier::bucketStart(uint32_t timestamp) const {
+    return timestamp - (timestamp - alignment) % bucketWidth;
+}
+
+size_t RollupTier::indexOf(size_t age) const {
+    return (head + capacity - age) % capacity;
+}
+
+uint32_t RollupTier::oldestStart() const {
+    return used ? buckets[indexOf(used - 1)].start : 0xFFFFFFFFUL;
+}
+
+void RollupTier::add(uint32_t timestamp, int16_t distanceMm) {
+    uint32_t start = bucketStart(timestamp);
+    RollupBucket* bucket = nullptr;
+
+    if (used == 0 || start > buckets[head].start) {
+        // New bucket, recycling the oldest once the ring is full
+        if (used > 0) {
+            head = (head + 1) % capacity;
+        }
+        if (used < capacity) {
+            used++;
+        }
+        bucket = &buckets[head];
+        bucket->start    = start;
+        bucket->count    = 0;
+        bucket->minMm    = distanceMm;
+        bucket->maxMm    = distanceMm;
+        bucket->reserved = 0;
+        bucket->meanMm   = 0.0f;
+        bucket->m2       = 0.0f;
+    } else {
+        // Current bucket, or (rarely, after a clock step) an older one
+        for (size_t age = 0; age < used; age++) {
+            RollupBucket& b = buckets[indexOf(age)];
+            if (b.start == start) {
+                bucket = &b;
+                break;
+            }
+            if (b.start < start) {
+                return;   // Falls in a gap with no bucket: drop it
+            }
+        }
+        if (!bucket || bucket->count == 0xFFFF) {
+            return;
+        }
+    }
+
+    // Welford's online update
+    float x = distanceMm;
+    bucket->count++;
+    float delta = x - bucket->meanMm;
+    bucket->meanMm += delta / bucket->count;
+    bucket->m2 += delta * (x - bucket->meanMm);
+    if (distanceMm < bucket->minMm) bucket->minMm = distanceMm;
+    if (distanceMm > bucket->maxMm) bucket->maxMm = distanceMm;
+}
+
+size_t RollupTier::read(uint32_t from, uint32_t to, RollupBucket* out, size_t maxBuckets) const {
+    size_t n = 0;
+    for (size_t age = used; age > 0 && n < maxBuckets; age--) {
+        const RollupBucket& b = buckets[indexOf(age - 1)];
+        if (b.start > to) {
+            break;
+        }
+        if (b.start + bucketWidth > from) {
+            out[n++] = b;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,70 @@
+#ifndef HISTORY_ROLLUP_H
+#define HISTORY_ROLLUP_H
+
+// Incremental fixed-width aggregates over the history. Deliberately free
+// of Arduino headers so it can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Aggregate of the readings in [start, start + width)
+struct RollupBucket {
+    uint32_t start;     // Unix time of the bucket start
+    uint16_t count;     // Valid readings folded in
+    int16_t  minMm;
+    int16_t  maxMm;
+    uint16_t reserved;
+    float    meanMm;    // Welford running mean
+    float    m2;        // Welford sum of squared deviations
+
+    // Sample standard deviation in mm (0 below two readings)
+    float stddevMm() const;
+};
+
+/**
+ * One resolution tier (e.g. hourly) as a ring of buckets.
+ *
+ * add() is O(1) for readings in the current or a new bucket and folds them
+ * in with Welford's update, so no raw samples are kept; when the ring is
+ * full the oldest bucket is reused. Storage is supplied by the owner.
+ */
+class RollupTier {
+public:
+    /**
+     * @param width Bucket width in seconds
+     * @param alignment Unix time of any bucket boundary (e.g. a Monday for weeks)
+     * @param storage Bucket array owned by the caller
+     * @param capacity Number of buckets in storage
+     */
+    RollupTier(uint32_t width, uint32_t alignment, RollupBucket* storage, size_t capacity);
+
+    void clear();
+
+    // Fold in one reading; readings older than the ring are dropped
+    void add(uint32_t timestamp, int16_t distanceMm);
+
+    /**
+     * Copy buckets overlapping [from, to] in time order
+     *
+     * @return Number of buckets copied; resume with from = last.start + width()
+     */
+    size_t read(uint32_t from, uint32_t to, RollupBucket* out, size_t maxBuckets) const;
+
+    uint32_t width() const { return bucketWidth; }
+
+    // Start of the oldest bucket held, or 0xFFFFFFFF if empty
+    uint32_t oldestStart() const;
+
+private:
+    uint32_t bucketStart(uint32_t timestamp) const;
+    size_t   indexOf(size_t age) const;   // 0 = newest
+
+    uint32_t      bucketWidth;
+    uint32_t      alignment;
+    RollupBucket* buckets;
+    size_t        capacity;
+    size_t        head;      // Newest bucket
+    size_t        used;
+};
+
+#endif // HISTORY_ROLLUP_H
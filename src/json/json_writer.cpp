@@ -0,0 +1,220 @@
+#include "json_writer.h"
+#include <string.h>
+#include <math.h>
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+    : buf(buffer), cap(capacity) {
+    reset();
+}
+
+void JsonWriter::reset() {
+    len = 0;
+    hasMembers = 0;
+    depth = 0;
+    afterKey = false;
+    overflow = (cap == 0);
+    if (cap > 0) {
+        buf[0] = '\0';
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Low-level output (always keeps the buffer NUL-terminated)
+// ---------------------------------------------------------------------------
+void JsonWriter::put(char c) {
+    if (overflow || len + 1 >= cap) {
+        overflow = true;
+        return;
+    }
+    buf[len++] = c;
+    buf[len] = '\0';
+}
+
+void JsonWriter::put(const char* s, size_t n) {
+    if (overflow || len + n >= cap) {
+        overflow = true;
+        return;
+    }
+    memcpy(buf + len, s, n);
+    len += n;
+    buf[len] = '\0';
+}
+
+void JsonWriter::putUnsigned(unsigned long v) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+
+    char out[20];
+    for (size_t i = 0; i < n; i++) {
+        out[i] = digits[n - 1 - i];
+    }
+    put(out, n);
+}
+
+void JsonWriter::putEscaped(const char* s) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    put('"');
+    for (; *s && !overflow; s++) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        switch (c) {
+            case '"':  put("\\\"", 2); break;
+            case '\\': put("\\\\", 2); break;
+            case '\n': put("\\n", 2);  break;
+            case '\r': put("\\r", 2);  break;
+            case '\t': put("\\t", 2);  break;
+            case '\b': put("\\b", 2);  break;
+            case '\f': put("\\f", 2);  break;
+            default:
+                if (c < 0x20) {
+                    char esc[6] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF] };
+                    put(esc, sizeof(esc));
+                } else {
+                    put(static_cast<char>(c));  // UTF-8 passes through untouched
+                }
+        }
+    }
+    put('"');
+}
+
+// Comma before every array element / object member except the first
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (depth == 0) {
+        return;
+    }
+    uint32_t bit = 1UL << (depth - 1);
+    if (hasMembers & bit) {
+        put(',');
+    }
+    hasMembers |= bit;
+}
+
+// ---------------------------------------------------------------------------
+// Structure
+// ---------------------------------------------------------------------------
+JsonWriter& JsonWriter::open(char c) {
+    separate();
+    if (depth >= MAX_DEPTH) {
+        overflow = true;
+        return *this;
+    }
+    put(c);
+    depth++;
+    hasMembers &= ~(1UL << (depth - 1));
+    return *this;
+}
+
+JsonWriter& JsonWriter::close(char c) {
+    if (depth == 0) {
+        overflow = true;
+        return *this;
+    }
+    depth--;
+    put(c);
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginObject() { return open('{'); }
+JsonWriter& JsonWriter::endObject()   { return close('}'); }
+JsonWriter& JsonWriter::beginArray()  { return open('['); }
+JsonWriter& JsonWriter::endArray()    { return close(']'); }
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separate();
+    putEscaped(name ? name : "");
+    put(':');
+    afterKey = true;
+    return *this;
+}
+
+// ---------------------------------------------------------------------------
+// Values
+// ---------------------------------------------------------------------------
+JsonWriter& JsonWriter::value(const char* str) {
+    if (!str) {
+        return nullValue();
+    }
+    separate();
+    putEscaped(str);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    separate();
+    if (b) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long v) {
+    separate();
+    if (v < 0) {
+        put('-');
+        putUnsigned(0UL - static_cast<unsigned long>(v));
+    } else {
+        putUnsigned(static_cast<unsigned long>(v));
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long v) {
+    separate();
+    putUnsigned(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(float v, uint8_t decimals) {
+    // Sensor values are small; anything that does not fit the fixed-point
+    // path below is not a meaningful reading
+    if (isnan(v) || isinf(v) || fabsf(v) >= 1e9f) {
+        return nullValue();
+    }
+    if (decimals > MAX_DECIMALS) {
+        decimals = MAX_DECIMALS;
+    }
+
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+
+    // Round half away from zero at the requested precision
+    bool negative = v < 0;
+    double scaled = fabs(static_cast<double>(v)) * scale + 0.5;
+    uint64_t fixed = static_cast<uint64_t>(scaled);
+    unsigned long whole = static_cast<unsigned long>(fixed / scale);
+    uint32_t fraction = static_cast<uint32_t>(fixed % scale);
+
+    separate();
+    if (negative && fixed != 0) {
+        put('-');
+    }
+    putUnsigned(whole);
+    if (decimals > 0) {
+        char digits[MAX_DECIMALS];
+        for (int i = decimals - 1; i >= 0; i--) {
+            digits[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        put('.');
+        put(digits, decimals);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::nullValue() {
+    separate();
+    put("null", 4);
+    return *this;
+}
@@ -0,0 +1,78 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+// Allocation-free JSON writer. Deliberately free of Arduino headers so it
+// can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Builds a JSON document into a caller-owned buffer.
+ *
+ * Commas are inserted automatically, strings are escaped and numbers are
+ * formatted without printf (newlib's float formatting can allocate). If the
+ * buffer fills up the writer stops, ok() turns false and the buffer holds a
+ * NUL-terminated prefix - callers should report an error rather than send it.
+ *
+ *     JsonWriter w(buf, sizeof(buf));
+ *     w.beginObject().field("distance", 42.5f, 2).field("ok", true).endObject();
+ */
+class JsonWriter {
+public:
+    static const uint8_t MAX_DEPTH = 16;
+    static const uint8_t MAX_DECIMALS = 6;
+
+    JsonWriter(char* buffer, size_t capacity);
+
+    // Start over with an empty document
+    void reset();
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    // Object member name; the next value belongs to it
+    JsonWriter& key(const char* name);
+
+    JsonWriter& value(const char* str);            // nullptr writes null
+    JsonWriter& value(bool b);
+    JsonWriter& value(int v)           { return value(static_cast<long>(v)); }
+    JsonWriter& value(unsigned v)      { return value(static_cast<unsigned long>(v)); }
+    JsonWriter& value(long v);
+    JsonWriter& value(unsigned long v);
+    JsonWriter& value(float v, uint8_t decimals);  // NaN/inf write null
+    JsonWriter& nullValue();
+
+    // key() + value() shorthands
+    template <typename T>
+    JsonWriter& field(const char* name, T v) { return key(name).value(v); }
+    JsonWriter& field(const char* name, float v, uint8_t decimals) {
+        return key(name).value(v, decimals);
+    }
+
+    bool        ok() const       { return !overflow && depth == 0; }
+    bool        overflowed() const { return overflow; }
+    size_t      length() const   { return len; }
+    const char* c_str() const    { return buf; }
+
+private:
+    void separate();
+    void put(char c);
+    void put(const char* s, size_t n);
+    void putUnsigned(unsigned long v);
+    void putEscaped(const char* s);
+    JsonWriter& open(char c);
+    JsonWriter& close(char c);
+
+    char*    buf;
+    size_t   cap;
+    size_t   len;
+    uint32_t hasMembers;   // Bit per nesting level: something written already
+    uint8_t  depth;
+    bool     afterKey;
+    bool     overflow;
+};
+
+#endif // JSON_WRITER_H
@@ -1,6 +1,5 @@
 #include <Arduino.h>
 #include <WiFi.h>
-#include <algorithm>
 #include <Preferences.h>
 #include "esp_task_wdt.h"
 #include "secrets.h"
@@ -9,23 +8,45 @@
 
 #include "wifi/wifi.h"
 #include "mqtt/mqtt.h"
-#include "bark/bark.h"
-#include "ntfy/ntfy.h"
+#include "notify/notifier.h"
 #include "ota/ota.h"
+#include "sensor/echo.h"
+#include "sensor/temperature.h"
+#include "measurement/measurement.h"
+#include "history/history.h"
+#include "history/event_log.h"
+#include "analysis/consumption.h"
+#include "analysis/events.h"
+#include "analysis/level_filter.h"
+#include "analysis/tank.h"
 
 // ---------------------------------------------------------------------------
 // Globals
 // ---------------------------------------------------------------------------
 saltlevel::Config gConfig;
 saltlevel::OTA    ota;
+LevelSensor*      sensors[Tank::MAX_TANKS] = {};  // Created once the config is loaded
+HistoryStore      history;
+ConsumptionEstimator consumption;
+LevelEventDetector eventDetector;
+EventLog          eventLog;
+LevelEstimator    levelEstimator;
 
-bool warningSent = false;
-unsigned long lastMeasure = 0;
-unsigned long lastWifiCheck = 0;
+// Alert and publishing state, one per tank
+struct TankState {
+    bool     warningSent;
+    uint8_t  consecutiveLowReadings;   // Consecutive low-level tracking for notification filtering
+    uint8_t  consecutiveHighReadings;  // For reset after recovery
+    uint32_t lastSampleSequence;
+    uint32_t nextAlertTickMs;          // Hourly grid the alert counters follow
+    float    lastPublishedCm;
+    bool     alertTickSeen;
+    bool     alertQueued;              // Low-salt alert handed to the notifier, not settled yet
+};
+TankState tanks[Tank::MAX_TANKS];
 
-// Consecutive low-level tracking for notification filtering
-uint8_t consecutiveLowReadings = 0;
-uint8_t consecutiveHighReadings = 0;  // For reset after recovery
+uint32_t lastFilteredMs = 0;
+unsigned long lastWifiCheck = 0;
 
 // Reset button state
 unsigned long resetButtonPressStart = 0;
@@ -37,28 +58,65 @@ bool resetInProgress = false;
 // ---------------------------------------------------------------------------
 static Preferences notificationPrefs;
 
+// NVS keys of a tank's alert state; the first tank keeps the original keys
+struct NotifyKeys {
+    char low[12];
+    char high[12];
+    char sent[12];
+};
+
+static NotifyKeys notifyKeys(uint8_t tank) {
+    NotifyKeys keys;
+    if (tank == 0) {
+        strcpy(keys.low, "consec_low");
+        strcpy(keys.high, "consec_high");
+        strcpy(keys.sent, "warn_sent");
+    } else {
+        snprintf(keys.low, sizeof(keys.low), "t%u_low", tank);
+        snprintf(keys.high, sizeof(keys.high), "t%u_high", tank);
+        snprintf(keys.sent, sizeof(keys.sent), "t%u_sent", tank);
+    }
+    return keys;
+}
+
 void loadNotificationState() {
     notificationPrefs.begin("notify", true);  // Read-only
-    consecutiveLowReadings = notificationPrefs.getUChar("consec_low", 0);
-    consecutiveHighReadings = notificationPrefs.getUChar("consec_high", 0);
-    warningSent = notificationPrefs.getBool("warn_sent", false);
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        NotifyKeys keys = notifyKeys(i);
+        TankState& tank = tanks[i];
+        tank.consecutiveLowReadings = notificationPrefs.getUChar(keys.low, 0);
+        tank.consecutiveHighReadings = notificationPrefs.getUChar(keys.high, 0);
+        tank.warningSent = notificationPrefs.getBool(keys.sent, false);
+        tank.lastPublishedCm = -1.0f;
+    }
     notificationPrefs.end();
     
     Logger::infof("Notification state loaded: low=%u, high=%u, warningSent=%s",
-                 consecutiveLowReadings, consecutiveHighReadings,
-                 warningSent ? "true" : "false");
+                 tanks[0].consecutiveLowReadings, tanks[0].consecutiveHighReadings,
+                 tanks[0].warningSent ? "true" : "false");
 }
 
-void saveNotificationState() {
+void saveNotificationState(uint8_t tankIndex) {
+    NotifyKeys keys = notifyKeys(tankIndex);
+    const TankState& tank = tanks[tankIndex];
     notificationPrefs.begin("notify", false);  // Read-write
-    notificationPrefs.putUChar("consec_low", consecutiveLowReadings);
-    notificationPrefs.putUChar("consec_high", consecutiveHighReadings);
-    notificationPrefs.putBool("warn_sent", warningSent);
+    notificationPrefs.putUChar(keys.low, tank.consecutiveLowReadings);
+    notificationPrefs.putUChar(keys.high, tank.consecutiveHighReadings);
+    notificationPrefs.putBool(keys.sent, tank.warningSent);
     notificationPrefs.end();
     
-    Logger::debugf("Notification state saved: low=%u, high=%u, warningSent=%s",
-                  consecutiveLowReadings, consecutiveHighReadings,
-                  warningSent ? "true" : "false");
+    Logger::debugf("Notification state of tank %u saved: low=%u, high=%u, warningSent=%s",
+                  tankIndex, tank.consecutiveLowReadings, tank.consecutiveHighReadings,
+                  tank.warningSent ? "true" : "false");
+}
+
+// Mirror the alert state to the web UI's live event stream
+void publishNotificationState(uint8_t tankIndex) {
+    saltlevel::NotificationState state;
+    state.warningSent     = tanks[tankIndex].warningSent;
+    state.consecutiveLow  = tanks[tankIndex].consecutiveLowReadings;
+    state.consecutiveHigh = tanks[tankIndex].consecutiveHighReadings;
+    ota.setNotificationState(state, tankIndex);
 }
 
 // ---------------------------------------------------------------------------
@@ -101,6 +159,11 @@ void checkResetButton() {
                 notificationPrefs.end();
                 Logger::info("Notification state cleared");
                 
+                // Clear queued alerts (they hold the Bark key and ntfy topic)
+                prefs.begin("outbox", false);
+                prefs.clear();
+                prefs.end();
+                
                 Logger::warn("All settings cleared. Device will restart in 2 seconds...");
                 delay(2000);
                 ESP.restart();
@@ -120,73 +183,172 @@ void checkResetButton() {
 }
 
 // ---------------------------------------------------------------------------
-// Distance measurement with median filtering
+// Distance measurement (performed by the measurement task)
 // ---------------------------------------------------------------------------
-float readDistanceCm() {
-    const int attempts = Sensor::MAX_READING_ATTEMPTS;
-    float readings[attempts];
-    int validReadings = 0;
-    
-    for (int i = 0; i < attempts; i++) {
-        digitalWrite(Pins::TRIG, LOW);
-        delayMicroseconds(2);
-        
-        digitalWrite(Pins::TRIG, HIGH);
-        delayMicroseconds(10);
-        digitalWrite(Pins::TRIG, LOW);
-        
-        unsigned long duration = pulseIn(Pins::ECHO, HIGH, Timing::SENSOR_TIMEOUT_US);
-        
-        if (duration > 0) {
-            float distance = (duration * Sensor::SOUND_SPEED_CM_PER_US) / 2.0f;
-            readings[validReadings++] = distance;
-            Logger::debugf("Reading %d: %.2f cm", i + 1, distance);
-        } else {
-            Logger::debug("Reading timeout");
-        }
-        
-        if (i < attempts - 1) {
-            delay(Timing::SENSOR_READING_DELAY_MS);
-        }
-    }
-    
-    if (validReadings == 0) {
-        Logger::warn("All sensor readings failed");
+// Blocking wrapper for callers that need a fresh value right away (boot).
+// Scheduled measurements are picked up from the snapshot in loop().
+float readDistanceCm(uint8_t tank) {
+    MeasurementSample sample;
+    if (!measurementFresh(Timing::MEASURE_WAIT_TIMEOUT_MS, sample, tank)) {
         return -1.0f;
     }
-    
-    if (validReadings == 1) {
-        Logger::infof("Single valid reading: %.2f cm", readings[0]);
-        return readings[0];
+    return sample.distanceCm;
+}
+
+// ---------------------------------------------------------------------------
+// Consumption forecast (fitted on every reading since the last refill)
+// ---------------------------------------------------------------------------
+void publishForecast() {
+    saltlevel::ForecastState state = {};
+    ConsumptionEstimate estimate;
+    if (consumption.estimate(gConfig.tanks[0].emptyDistanceCm, estimate)) {
+        state.valid          = true;
+        state.rateCmPerDay   = estimate.rateCmPerDay;
+        state.daysUntilEmpty = estimate.daysUntilEmpty;
+        state.emptyAt        = estimate.emptyAt;
     }
-    
-    // Calculate median for robustness
-    std::sort(readings, readings + validReadings);
-    float median = readings[validReadings / 2];
-    
-    Logger::infof("Median of %d readings: %.2f cm", validReadings, median);
-    return median;
+    ota.setForecast(state);
+}
+
+void updateForecast(uint32_t timestamp, float distance) {
+    if (distance < 0) {
+        return;
+    }
+    if (consumption.add(timestamp, distance)) {
+        Logger::infof("Refill detected (%.1f cm), consumption estimate restarted", distance);
+    }
+    publishForecast();
+}
+
+// Seed the fit and the event detector from the stored history so a reboot
+// does not lose them (events found again here are already in the log)
+void replayHistory() {
+    uint32_t newest = history.newest();
+    if (newest == 0) {
+        return;
+    }
+
+    HistoryRecord batch[32];
+    HistoryPosition pos(newest > Forecast::REPLAY_S ? newest - Forecast::REPLAY_S : 0);
+    size_t n;
+    do {
+        n = history.read(pos, newest, batch, 32);
+        for (size_t i = 0; i < n; i++) {
+            if (batch[i].distanceMm >= 0) {
+                float distance = batch[i].distanceMm / 10.0f;
+                LevelEvent ignored;
+                consumption.add(batch[i].timestamp, distance);
+                eventDetector.add(batch[i].timestamp, distance, ignored);
+            }
+        }
+    } while (n == 32);
+}
+
+// True when the forecast says the first tank empties within the configured days
+bool forecastRunningOut() {
+    ConsumptionEstimate estimate;
+    return gConfig.forecastAlertDays > 0 &&
+           consumption.estimate(gConfig.tanks[0].emptyDistanceCm, estimate) &&
+           estimate.daysUntilEmpty >= 0.0f &&
+           estimate.daysUntilEmpty <= gConfig.forecastAlertDays;
 }
 
 // ---------------------------------------------------------------------------
-// Level calculation
+// Level events (refills, regeneration steps, sensor glitches)
 // ---------------------------------------------------------------------------
-float computeFullPercent(float distanceCm) {
-    if (gConfig.emptyDistanceCm == gConfig.fullDistanceCm) {
-        Logger::error("Invalid config: empty == full distance");
-        return -1.0f;
+void detectEvents(uint32_t timestamp, float distance) {
+    LevelEvent event;
+    if (distance < 0 || !eventDetector.add(timestamp, distance, event)) {
+        return;
     }
-    
-    float full  = gConfig.fullDistanceCm;
-    float empty = gConfig.emptyDistanceCm;
-    
-    float percent = (empty - distanceCm) / (empty - full) * 100.0f;
-    
-    // Clamp to valid range
-    if (percent < 0)   percent = 0;
-    if (percent > 100) percent = 100;
-    
-    return percent;
+
+    Logger::infof("Level event: %s (%+.1f cm, now %.1f cm)",
+                 levelEventName(event.type), event.deltaCm, event.levelCm);
+    eventLog.add(event);
+    mqttPublishEvent(levelEventName(event.type), event.timestamp, event.deltaCm, event.levelCm);
+}
+
+// ---------------------------------------------------------------------------
+// Level estimation (filters single splashes and echoes before the alert logic)
+// ---------------------------------------------------------------------------
+float estimateLevel(const MeasurementSample& sample) {
+    LevelFilterConfig filter;
+    filter.type               = static_cast<LevelFilterType>(gConfig.levelFilter);
+    filter.processNoiseCm     = gConfig.filterProcessNoiseCm;
+    filter.measurementNoiseCm = gConfig.filterMeasurementNoiseCm;
+    filter.gateSigma          = gConfig.filterGateSigma;
+    filter.window             = gConfig.filterWindow;
+    levelEstimator.configure(filter);
+
+    float hours = lastFilteredMs ? (sample.timestampMs - lastFilteredMs) / 3600000.0f : 0.0f;
+    lastFilteredMs = sample.timestampMs;
+
+    float level = levelEstimator.update(sample.distanceCm, hours);
+    if (levelEstimator.rejected()) {
+        Logger::infof("Reading %.2f cm looks like an outlier, using %.2f cm",
+                     sample.distanceCm, level);
+    }
+    return level;
+}
+
+// ---------------------------------------------------------------------------
+// Low-salt notifications
+// ---------------------------------------------------------------------------
+// Configured tank name, or "Tank N" when none is set
+void tankLabel(uint8_t tank, char* out, size_t len) {
+    if (gConfig.tanks[tank].name[0] != '\0') {
+        snprintf(out, len, "%s", gConfig.tanks[tank].name);
+    } else {
+        snprintf(out, len, "Tank %u", tank + 1);
+    }
+}
+
+// Hand a low-salt alert for Bark and ntfy to the notifier task; the message
+// names the tank when more than one is fitted
+bool queueLowSaltAlert(uint8_t tank, float distance, float percent) {
+    int fitted = 0;
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        if (measurementHasTank(i)) {
+            fitted++;
+        }
+    }
+
+    char label[Tank::NAME_LENGTH + 8] = "";
+    if (fitted > 1) {
+        tankLabel(tank, label, sizeof(label));
+    }
+
+    LowSaltAlert alert;
+    alert.tank       = tank;
+    alert.distanceCm = distance;
+    alert.percent    = percent;
+    alert.label      = label;
+    alert.barkKey    = gConfig.barkEnabled ? gConfig.barkKey : nullptr;
+    alert.ntfyTopic  = gConfig.ntfyEnabled ? gConfig.ntfyTopic : nullptr;
+    return notifierEnqueue(alert);
+}
+
+// A queued alert settled: the warning only counts as sent once a channel
+// confirmed it, otherwise the next low reading queues it again
+void onNotificationResult(const NotificationResult& result) {
+    TankState& tank = tanks[result.tank];
+    if (!tank.alertQueued) {
+        // Level recovered while the alert was in flight
+        return;
+    }
+    tank.alertQueued = false;
+
+    char label[Tank::NAME_LENGTH + 8];
+    tankLabel(result.tank, label, sizeof(label));
+    if (!result.delivered) {
+        Logger::errorf("%s: low salt alert not delivered, retrying at the next reading", label);
+        return;
+    }
+
+    tank.warningSent = true;
+    Logger::infof("%s: low salt alert delivered", label);
+    saveNotificationState(result.tank);
+    publishNotificationState(result.tank);
 }
 
 // ---------------------------------------------------------------------------
@@ -198,95 +360,177 @@ float computeFullPercent(float distanceCm) {
 //
 // Notification sent after N consecutive hours with distance >= threshold (low salt)
 // Notification reset after N consecutive hours with distance < threshold (refilled)
+//
+// With a forecast alert configured, a predicted empty date of the first tank
+// within that many days counts as a low reading too, so the alert can go out
+// ahead of time. Every tank has its own counters and warning flag.
 // ---------------------------------------------------------------------------
-void handleNotifications(float distance, float percent) {
-    if (distance < 0 || gConfig.warnDistanceCm <= 0 || percent < 0.0f) {
+void handleNotifications(uint8_t tankIndex, float distance, float percent) {
+    TankState& tank = tanks[tankIndex];
+    float warnCm = gConfig.tanks[tankIndex].warnDistanceCm;
+    if (distance < 0 || warnCm <= 0 || percent < 0.0f) {
         return;
     }
+
+    char label[Tank::NAME_LENGTH + 8];
+    tankLabel(tankIndex, label, sizeof(label));
     
     // Check if salt level is low (distance >= threshold means less salt)
-    bool isLowLevel = (distance >= gConfig.warnDistanceCm);
+    bool runningOut = tankIndex == 0 && forecastRunningOut();
+    bool isLowLevel = (distance >= warnCm) || runningOut;
     
     if (isLowLevel) {
         // Reset high counter when level is low
-        if (consecutiveHighReadings > 0) {
-            Logger::debugf("Level dropped again, resetting high counter from %u to 0",
-                          consecutiveHighReadings);
-            consecutiveHighReadings = 0;
+        if (tank.consecutiveHighReadings > 0) {
+            Logger::debugf("%s: level dropped again, resetting high counter from %u to 0",
+                          label, tank.consecutiveHighReadings);
+            tank.consecutiveHighReadings = 0;
         }
         
         // Increment consecutive low readings counter
-        if (consecutiveLowReadings < 255) {
-            consecutiveLowReadings++;
+        if (tank.consecutiveLowReadings < 255) {
+            tank.consecutiveLowReadings++;
         }
         
-        Logger::infof("Low level detected (%.1f cm >= %.1f cm). Consecutive low: %u/%u",
-                     distance, gConfig.warnDistanceCm,
-                     consecutiveLowReadings, gConfig.consecutiveHoursThreshold);
+        if (runningOut && distance < warnCm) {
+            Logger::infof("%s: forecast empty within %u days. Consecutive low: %u/%u",
+                         label, gConfig.forecastAlertDays,
+                         tank.consecutiveLowReadings, gConfig.consecutiveHoursThreshold);
+        } else {
+            Logger::infof("%s: low level detected (%.1f cm >= %.1f cm). Consecutive low: %u/%u",
+                         label, distance, warnCm,
+                         tank.consecutiveLowReadings, gConfig.consecutiveHoursThreshold);
+        }
         
-        // Check if we should send a warning (consecutive hours threshold met)
-        if (!warningSent && consecutiveLowReadings >= gConfig.consecutiveHoursThreshold) {
-            Logger::infof("Threshold met for %u consecutive hours, sending notifications...",
-                         consecutiveLowReadings);
-            
-            // Try Bark (iOS)
-            if (gConfig.barkEnabled && gConfig.barkKey[0] != '\0') {
-                if (barkSendLowSaltNotification(gConfig.barkKey, distance, percent)) {
-                    Logger::info("Bark notification sent successfully");
-                } else {
-                    Logger::error("Bark notification failed");
-                }
-            }
-            
-            // Try ntfy (Android/Multi-platform)
-            if (gConfig.ntfyEnabled && gConfig.ntfyTopic[0] != '\0') {
-                if (ntfySendLowSaltNotification(gConfig.ntfyTopic, distance, percent)) {
-                    Logger::info("ntfy notification sent successfully");
-                } else {
-                    Logger::error("ntfy notification failed");
-                }
-            }
-            
-            // Set warning flag if any notification was enabled
-            if (gConfig.barkEnabled || gConfig.ntfyEnabled) {
-                warningSent = true;
-            }
-        } else if (!warningSent) {
-            Logger::infof("Waiting for %u more consecutive low readings before notification",
-                         gConfig.consecutiveHoursThreshold - consecutiveLowReadings);
+        // Check if we should send a warning (consecutive hours threshold met).
+        // warningSent is set once the notifier confirms delivery.
+        if (!tank.warningSent && tank.alertQueued) {
+            Logger::infof("%s: low salt alert waiting for delivery", label);
+        } else if (!tank.warningSent && tank.consecutiveLowReadings >= gConfig.consecutiveHoursThreshold) {
+            Logger::infof("%s: threshold met for %u consecutive hours, sending notifications...",
+                         label, tank.consecutiveLowReadings);
+            tank.alertQueued = queueLowSaltAlert(tankIndex, distance, percent);
+        } else if (!tank.warningSent) {
+            Logger::infof("%s: waiting for %u more consecutive low readings before notification",
+                         label, gConfig.consecutiveHoursThreshold - tank.consecutiveLowReadings);
         }
     } else {
         // Salt level is OK (distance < threshold means tank was refilled)
         
+        // An alert still in flight no longer sets the warning
+        if (tank.alertQueued) {
+            notifierCancel(tankIndex);
+            tank.alertQueued = false;
+        }
+        
         // Reset low counter when salt level is OK
-        if (consecutiveLowReadings > 0) {
-            Logger::debugf("Salt refilled, resetting low counter from %u to 0",
-                          consecutiveLowReadings);
-            consecutiveLowReadings = 0;
+        if (tank.consecutiveLowReadings > 0) {
+            Logger::debugf("%s: salt refilled, resetting low counter from %u to 0",
+                          label, tank.consecutiveLowReadings);
+            tank.consecutiveLowReadings = 0;
         }
         
         // Increment consecutive OK readings counter
-        if (consecutiveHighReadings < 255) {
-            consecutiveHighReadings++;
+        if (tank.consecutiveHighReadings < 255) {
+            tank.consecutiveHighReadings++;
         }
         
-        Logger::infof("Salt OK (%.1f cm < %.1f cm threshold). Consecutive OK: %u/%u",
-                     distance, gConfig.warnDistanceCm,
-                     consecutiveHighReadings, gConfig.consecutiveHoursThreshold);
+        Logger::infof("%s: salt OK (%.1f cm < %.1f cm threshold). Consecutive OK: %u/%u",
+                     label, distance, warnCm,
+                     tank.consecutiveHighReadings, gConfig.consecutiveHoursThreshold);
         
         // Reset warning only after N consecutive hours with OK level
-        if (warningSent && consecutiveHighReadings >= gConfig.consecutiveHoursThreshold) {
-            warningSent = false;
-            Logger::infof("Salt OK for %u consecutive hours, warning reset - ready for new alerts",
-                         consecutiveHighReadings);
-        } else if (warningSent) {
-            Logger::infof("Waiting for %u more consecutive OK readings before reset",
-                         gConfig.consecutiveHoursThreshold - consecutiveHighReadings);
+        if (tank.warningSent && tank.consecutiveHighReadings >= gConfig.consecutiveHoursThreshold) {
+            tank.warningSent = false;
+            Logger::infof("%s: salt OK for %u consecutive hours, warning reset - ready for new alerts",
+                         label, tank.consecutiveHighReadings);
+        } else if (tank.warningSent) {
+            Logger::infof("%s: waiting for %u more consecutive OK readings before reset",
+                         label, gConfig.consecutiveHoursThreshold - tank.consecutiveHighReadings);
         }
     }
     
     // Save state to survive reboot
-    saveNotificationState();
+    saveNotificationState(tankIndex);
+    publishNotificationState(tankIndex);
+}
+
+// ---------------------------------------------------------------------------
+// History (every completed burst, stamped with wall-clock time)
+// ---------------------------------------------------------------------------
+void recordHistory(const MeasurementSample& sample) {
+    time_t now = time(nullptr);
+    if (now < static_cast<time_t>(Timing::MIN_VALID_EPOCH)) {
+        Logger::debug("Clock not synced yet, reading not stored in history");
+        return;
+    }
+    uint32_t timestamp = static_cast<uint32_t>(now) - measurementAgeMs(sample) / 1000;
+    history.append(timestamp, sample.distanceCm, sample.scheduled);
+    updateForecast(timestamp, sample.distanceCm);
+    detectEvents(timestamp, sample.distanceCm);
+}
+
+// ---------------------------------------------------------------------------
+// Periodic measurement result (scheduled sample read from the snapshot)
+// ---------------------------------------------------------------------------
+// The schedule speeds up while the level moves. The alert filter counts
+// hours, so it only runs on "ticks": the first reading at each point of an
+// hourly grid. The grid is kept in elapsed time, not in the spacing between
+// readings, so with a maximum interval under an hour (say 40 min) a tick
+// still comes about once an hour rather than every second reading. MQTT
+// gets the ticks plus any reading that moved noticeably, which keeps the
+// traffic of a stable tank at one message an hour. The level filter and the
+// forecast follow the first tank only.
+void onPeriodicMeasurement(const MeasurementSample& sample) {
+    TankState& state = tanks[sample.tank];
+    float distance = sample.distanceCm;
+    bool tick = !state.alertTickSeen ||
+                static_cast<int32_t>(sample.timestampMs + Timing::ALERT_TICK_SLACK_MS -
+                                     state.nextAlertTickMs) >= 0;
+    if (tick) {
+        // After a gap the grid restarts instead of counting the missed hours
+        bool behind = !state.alertTickSeen ||
+                      static_cast<int32_t>(sample.timestampMs - state.nextAlertTickMs) >=
+                      static_cast<int32_t>(Timing::ALERT_TICK_MS);
+        state.alertTickSeen = true;
+        state.nextAlertTickMs = (behind ? sample.timestampMs : state.nextAlertTickMs) +
+                                Timing::ALERT_TICK_MS;
+    }
+
+    if (distance < 0) {
+        Logger::errorf("Tank %u measurement failed: out of range / no echo", sample.tank + 1);
+    } else {
+        float level = sample.tank == 0 ? estimateLevel(sample) : distance;
+        TankLevel tank;
+        tankLevel(sample.tank, level, tank);
+        Logger::infof("Tank %u distance: %.2f cm (estimate %.2f cm), Level: %.1f%%",
+                     sample.tank + 1, distance, level, tank.percent);
+        
+        // Handle notifications (Bark and ntfy) on the estimate, not the raw reading
+        if (tick) {
+            handleNotifications(sample.tank, level, tank.percent);
+        }
+    }
+
+    bool moved = distance >= 0 && state.lastPublishedCm >= 0 &&
+                 fabsf(distance - state.lastPublishedCm) >= Sensor::ADAPTIVE_CHANGE_CM;
+    if (!tick && !moved) {
+        return;
+    }
+    
+    // Publish to MQTT
+    if (mqttPublishTankDistance(sample.tank, distance)) {
+        Logger::debug("MQTT publish successful");
+        state.lastPublishedCm = distance;
+    } else {
+        Logger::warn("MQTT publish failed");
+    }
+
+    ConsumptionEstimate estimate;
+    if (tick && sample.tank == 0 &&
+        consumption.estimate(gConfig.tanks[0].emptyDistanceCm, estimate)) {
+        mqttPublishForecast(estimate.rateCmPerDay, estimate.daysUntilEmpty);
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -314,20 +558,46 @@ void setup() {
     esp_task_wdt_init(Network::WATCHDOG_TIMEOUT_SECONDS, true);
     esp_task_wdt_add(NULL);
     
-    // Initialize hardware pins
-    pinMode(Pins::TRIG, OUTPUT);
-    pinMode(Pins::ECHO, INPUT);
+    // Initialize hardware pins (the level sensors follow the config, below)
     pinMode(Pins::RESET_BTN, INPUT_PULLUP);  // Use internal pull-up
     Logger::info("GPIO pins configured");
     
+    // Air temperature for the speed of sound (optional probe, or pushed)
+    temperatureSetup();
+    
+    // Measurement history lives in its own flash partition
+    history.begin(History::PARTITION_LABEL);
+    eventLog.begin();
+    replayHistory();
+    
     // Load notification state from NVS (survives reboot)
     loadNotificationState();
     
-    // Set default configuration
-    gConfig.fullDistanceCm  = Sensor::DEFAULT_FULL_DISTANCE_CM;
-    gConfig.emptyDistanceCm = Sensor::DEFAULT_EMPTY_DISTANCE_CM;
-    gConfig.warnDistanceCm  = Sensor::DEFAULT_WARN_DISTANCE_CM;
+    // Set default configuration: one tank on the board's sensor pins
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        saltlevel::TankConfig& tank = gConfig.tanks[i];
+        tank.name[0]         = '\0';
+        tank.trigPin         = i == 0 ? Pins::TRIG : -1;
+        tank.echoPin         = i == 0 ? Pins::ECHO : -1;
+        tank.fullDistanceCm  = Sensor::DEFAULT_FULL_DISTANCE_CM;
+        tank.emptyDistanceCm = Sensor::DEFAULT_EMPTY_DISTANCE_CM;
+        tank.warnDistanceCm  = Sensor::DEFAULT_WARN_DISTANCE_CM;
+    }
     gConfig.consecutiveHoursThreshold = Notification::CONSECUTIVE_LOW_THRESHOLD;
+    gConfig.forecastAlertDays = Notification::FORECAST_ALERT_DAYS;
+    gConfig.statusMaxAgeS   = Timing::STATUS_MAX_AGE_S;
+    gConfig.measureMinIntervalS = Timing::MIN_MEASURE_INTERVAL_S;
+    gConfig.measureMaxIntervalS = Timing::MEASURE_INTERVAL_MS / 1000UL;
+    gConfig.levelFilter     = Filter::DEFAULT_TYPE;
+    gConfig.filterProcessNoiseCm     = Filter::PROCESS_NOISE_CM;
+    gConfig.filterMeasurementNoiseCm = Filter::MEASUREMENT_NOISE_CM;
+    gConfig.filterGateSigma = Filter::GATE_SIGMA;
+    gConfig.filterWindow    = Filter::DEFAULT_WINDOW;
+    gConfig.tankShape       = Tank::DEFAULT_SHAPE;
+    gConfig.tankDim1Cm      = 0.0f;
+    gConfig.tankDim2Cm      = 0.0f;
+    gConfig.saltDensityKgPerL = Tank::DEFAULT_SALT_DENSITY_KG_PER_L;
+    gConfig.tankProfile[0]  = '\0';
     gConfig.language        = saltlevel::Language::ENGLISH;
     
     // Set OTA password from secrets.h or default
@@ -369,35 +639,71 @@ void setup() {
         }
     }
     
+    // Wall-clock time for history timestamps (UTC)
+    configTime(0, 0, Network::NTP_SERVER);
+    
     // Initialize OTA (will load config from NVS, overriding defaults)
     ota.setConfig(&gConfig);
-    ota.setDistanceCallback(readDistanceCm);
-    ota.setPublishCallback(mqttPublishDistance);
+    ota.setHistory(&history);
+    ota.setEventLog(&eventLog);
+    ota.setPublishCallback(mqttPublishTankDistance);
     ota.setup();
     
+    // One sensor per configured tank, handed over to the measurement task
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        const saltlevel::TankConfig& tank = gConfig.tanks[i];
+        if (tank.trigPin >= 0 && tank.echoPin >= 0) {
+            sensors[i] = new EchoSensor(tank.trigPin, tank.echoPin);
+            sensors[i]->begin();
+            Logger::infof("Tank %u sensor: trig GPIO %d, echo GPIO %d",
+                         i + 1, tank.trigPin, tank.echoPin);
+        }
+    }
+    measurementSetup(sensors);
+    
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        publishNotificationState(i);
+    }
+    publishForecast();
+    
     
     Logger::infof("ntfy notifications: %s (topic: %s)", 
                  gConfig.ntfyEnabled ? "ENABLED" : "DISABLED",
                  gConfig.ntfyTopic);
     
     Logger::infof("Configuration loaded - Tank: %.1f-%.1f cm, Warn: %.1f cm",
-                 gConfig.fullDistanceCm, gConfig.emptyDistanceCm, gConfig.warnDistanceCm);
+                 gConfig.tanks[0].fullDistanceCm, gConfig.tanks[0].emptyDistanceCm,
+                 gConfig.tanks[0].warnDistanceCm);
     
     // Initialize MQTT
     mqttSetup();
     
+    // Bark and ntfy requests run in their own task; alerts left in the
+    // outbox before the reboot are replayed and settle as usual
+    notifierSetup();
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        tanks[i].alertQueued = notifierHasAlert(i);
+    }
+    
     // Initial measurement at boot
     Logger::info("Performing initial measurement...");
-    float distance = readDistanceCm();
-    
-    if (distance < 0) {
-        Logger::error("Initial measurement failed: out of range / no echo");
-    } else {
-        float percent = computeFullPercent(distance);
-        Logger::infof("Initial reading: %.2f cm (%.1f%% full)", distance, percent);
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        if (!measurementHasTank(i)) {
+            continue;
+        }
+        float distance = readDistanceCm(i);
+        
+        if (distance < 0) {
+            Logger::errorf("Tank %u initial measurement failed: out of range / no echo", i + 1);
+        } else {
+            TankLevel tank;
+            tankLevel(i, distance, tank);
+            Logger::infof("Tank %u initial reading: %.2f cm (%.1f%% full)",
+                         i + 1, distance, tank.percent);
+        }
+        
+        mqttPublishTankDistance(i, distance);
     }
-    
-    mqttPublishDistance(distance);
     Logger::info("Setup complete - entering main loop");
 }
 
@@ -427,31 +733,34 @@ void loop() {
     // Handle OTA and MQTT
     ota.loop();
     mqttLoop();
-    
-    // Periodic measurement
-    if (now - lastMeasure >= Timing::MEASURE_INTERVAL_MS) {
-        lastMeasure = now;
-        
-        Logger::info("--- Periodic measurement ---");
-        float distance = readDistanceCm();
-        
-        if (distance < 0) {
-            Logger::error("Measurement failed: out of range / no echo");
-        } else {
-            float percent = computeFullPercent(distance);
-            Logger::infof("Distance: %.2f cm, Level: %.1f%%", distance, percent);
-            
-            // Handle notifications (Bark and ntfy)
-            handleNotifications(distance, percent);
+    temperatureLoop();
+    
+    // Schedule bounds may have been changed from the web UI
+    measurementSetIntervalBounds(gConfig.measureMinIntervalS * 1000UL,
+                                 gConfig.measureMaxIntervalS * 1000UL);
+    
+    // Pick up new samples from the measurement task: all of the first tank's
+    // go to the history, scheduled ones also drive notifications and MQTT
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        MeasurementSample sample;
+        if (!measurementLatest(sample, i) || sample.sequence == tanks[i].lastSampleSequence) {
+            continue;
         }
-        
-        // Publish to MQTT
-        if (mqttPublishDistance(distance)) {
-            Logger::debug("MQTT publish successful");
-        } else {
-            Logger::warn("MQTT publish failed");
+        tanks[i].lastSampleSequence = sample.sequence;
+        if (i == 0) {
+            recordHistory(sample);
+        }
+        if (sample.scheduled) {
+            onPeriodicMeasurement(sample);
         }
     }
+    history.loop();
+    
+    // Settle low-salt alerts the notifier task has finished with
+    NotificationResult result;
+    while (notifierPoll(result)) {
+        onNotificationResult(result);
+    }
     
     // Small delay to prevent tight loop
     delay(10);
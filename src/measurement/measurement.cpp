@@ -0,0 +1,230 @@
+#include "measurement.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include <atomic>
+#include "../logger.h"
+#include "../sensor/distance.h"
+#include "../sensor/temperature.h"
+
+// ---------------------------------------------------------------------------
+// Globals
+// ---------------------------------------------------------------------------
+// One per tank. The schedule and sensor are owned by the task; the snapshot
+// and interval are read from other tasks.
+struct TankChannel {
+    LevelSensor*                sensor = nullptr;
+    Snapshot<MeasurementSample> latest;
+    IntervalScheduler           scheduler;
+    std::atomic<uint32_t>       intervalMs{Timing::MEASURE_INTERVAL_MS};
+    std::atomic<uint32_t>       burstsStarted{0};   // Sequence of the burst in flight or last done
+    unsigned long               lastScheduledMs = 0;
+    bool                        burstScheduled = false;
+};
+
+static TaskHandle_t          taskHandle = nullptr;
+static TankChannel           channels[Tank::MAX_TANKS];
+static std::atomic<uint32_t> pendingRequests(0);   // Bit per tank
+static std::atomic<uint32_t> freshRequests(0);     // Subset that a burst in flight cannot serve
+static int                   activeTank = -1;      // Burst in flight, -1 if none
+static int                   lastTank = -1;        // Sensor that pinged last
+static unsigned long         lastBurstEndMs = 0;
+
+// Adaptive schedule bounds, set from the main loop
+static std::atomic<uint32_t> minIntervalMs(Timing::MEASURE_INTERVAL_MS);
+static std::atomic<uint32_t> maxIntervalMs(Timing::MEASURE_INTERVAL_MS);
+
+// ---------------------------------------------------------------------------
+// Task (owns the sensors)
+// ---------------------------------------------------------------------------
+static void onBurstComplete(float distanceCm, void* ctx) {
+    uint8_t tank = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(ctx));
+    TankChannel& ch = channels[tank];
+
+    // Single-flight: anyone who asked before this point gets this result,
+    // so drop their pending requests instead of firing another burst -
+    // unless they asked for a burst that starts after their request
+    pendingRequests.fetch_and(~(1u << tank));
+    if (freshRequests & (1u << tank)) {
+        pendingRequests.fetch_or(1u << tank);
+    }
+    activeTank = -1;
+    lastBurstEndMs = millis();
+
+    MeasurementSample sample;
+    sample.distanceCm  = distanceCm;
+    sample.timestampMs = lastBurstEndMs;
+    sample.sequence    = ch.burstsStarted;
+    sample.tank        = tank;
+    sample.scheduled   = ch.burstScheduled;
+    ch.latest.publish(sample);
+
+    // Every burst, on-demand ones included, tells the schedule whether the
+    // level is moving
+    ch.scheduler.setBounds(minIntervalMs, maxIntervalMs);
+    uint32_t next = ch.scheduler.update(distanceCm);
+    if (next != ch.intervalMs) {
+        Logger::infof("Tank %u: measurement interval now %u s",
+                      tank + 1, static_cast<unsigned>(next / 1000));
+        ch.intervalMs = next;
+    }
+}
+
+// Requested tanks first, then the most overdue scheduled one. Returns -1
+// and the time until the next one is due if there is nothing to do.
+static int pickTank(unsigned long now, unsigned long& waitMs) {
+    uint32_t requested = pendingRequests;
+    int next = -1;
+    unsigned long mostOverdue = 0;
+    waitMs = Timing::MEASURE_INTERVAL_MS;
+
+    for (int i = 0; i < Tank::MAX_TANKS; i++) {
+        TankChannel& ch = channels[i];
+        if (!ch.sensor) {
+            continue;
+        }
+        if (requested & (1u << i)) {
+            return i;
+        }
+
+        unsigned long interval = ch.intervalMs;
+        unsigned long elapsed = now - ch.lastScheduledMs;
+        if (elapsed >= interval) {
+            if (next < 0 || elapsed - interval > mostOverdue) {
+                next = i;
+                mostOverdue = elapsed - interval;
+            }
+        } else if (interval - elapsed < waitMs) {
+            waitMs = interval - elapsed;
+        }
+    }
+    return next;
+}
+
+static void measurementTask(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        if (activeTank >= 0) {
+            // Echo edges are captured by interrupt; just step the state machine
+            channels[activeTank].sensor->poll();
+            vTaskDelay(1);
+            continue;
+        }
+
+        // Sleep until the next scheduled burst or an on-demand request
+        unsigned long waitMs;
+        unsigned long now = millis();
+        int tank = pickTank(now, waitMs);
+        if (tank < 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+            continue;
+        }
+
+        // Let the previous sensor's echoes die out before another one pings,
+        // so it cannot pick them up as its own (crosstalk)
+        if (tank != lastTank && now - lastBurstEndMs < Timing::SENSOR_SWITCH_GAP_MS) {
+            vTaskDelay(pdMS_TO_TICKS(Timing::SENSOR_SWITCH_GAP_MS - (now - lastBurstEndMs)));
+            continue;
+        }
+
+        TankChannel& ch = channels[tank];
+        ch.burstScheduled = (now - ch.lastScheduledMs >= ch.intervalMs);
+        if (ch.burstScheduled) {
+            ch.lastScheduledMs = now;
+            Logger::infof("--- Periodic measurement (tank %d) ---", tank + 1);
+        }
+
+        // Compensate for the air temperature when one is known
+        TemperatureReading temperature;
+        ch.sensor->setSoundSpeed(temperatureCurrent(temperature)
+                                 ? soundSpeedCmPerUs(temperature.celsius)
+                                 : Sensor::SOUND_SPEED_CM_PER_US);
+
+        // Fresh requests made so far are served by this burst. Cleared before
+        // the sequence moves on, so a request that reads the new sequence
+        // (see measurementRequest) always leaves its bit set.
+        freshRequests.fetch_and(~(1u << tank));
+        ch.burstsStarted++;
+        activeTank = tank;
+        lastTank = tank;
+        ch.sensor->startBurst(onBurstComplete, reinterpret_cast<void*>(static_cast<uintptr_t>(tank)));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+void measurementSetup(LevelSensor* const* sensors) {
+    unsigned long now = millis();
+    int fitted = 0;
+    for (int i = 0; i < Tank::MAX_TANKS; i++) {
+        channels[i].sensor = sensors[i];
+        channels[i].lastScheduledMs = now;
+        if (sensors[i]) {
+            fitted++;
+        }
+    }
+
+    BaseType_t ok = xTaskCreatePinnedToCore(measurementTask, "measure",
+                                            Tasks::MEASURE_STACK_SIZE, nullptr,
+                                            Tasks::MEASURE_PRIORITY, &taskHandle,
+                                            Tasks::MEASURE_CORE);
+    if (ok != pdPASS) {
+        Logger::error("Failed to start measurement task");
+        return;
+    }
+
+    Logger::infof("Measurement task started on core %d (%d sensors)", Tasks::MEASURE_CORE, fitted);
+}
+
+bool measurementHasTank(uint8_t tank) {
+    return tank < Tank::MAX_TANKS && channels[tank].sensor != nullptr;
+}
+
+bool measurementLatest(MeasurementSample& out, uint8_t tank) {
+    return measurementHasTank(tank) && channels[tank].latest.read(out);
+}
+
+void measurementRequest(uint8_t tank, bool fresh) {
+    if (taskHandle && measurementHasTank(tank)) {
+        if (fresh) {
+            freshRequests.fetch_or(1u << tank);
+        }
+        pendingRequests.fetch_or(1u << tank);
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
+uint32_t measurementLastStarted(uint8_t tank) {
+    return tank < Tank::MAX_TANKS ? channels[tank].burstsStarted.load() : 0;
+}
+
+bool measurementFresh(unsigned long timeoutMs, MeasurementSample& out, uint8_t tank) {
+    uint32_t before = measurementLastStarted(tank);
+
+    measurementRequest(tank, true);
+
+    unsigned long start = millis();
+    while (millis() - start < timeoutMs) {
+        if (measurementLatest(out, tank) && out.sequence > before) {
+            return true;
+        }
+        delay(5);
+    }
+
+    Logger::warn("Timed out waiting for measurement");
+    return false;
+}
+
+unsigned long measurementAgeMs(const MeasurementSample& sample) {
+    return millis() - sample.timestampMs;
+}
+
+void measurementSetIntervalBounds(uint32_t minMs, uint32_t maxMs) {
+    minIntervalMs = minMs;
+    maxIntervalMs = maxMs;
+}
+
+uint32_t measurementIntervalMs(uint8_t tank) {
+    return tank < Tank::MAX_TANKS ? channels[tank].intervalMs.load() : 0;
+}
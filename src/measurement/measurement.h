@@ -0,0 +1,54 @@
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+
+#include <Arduino.h>
+#include "../constants.h"
+#include "../sensor/level_sensor.h"
+
+// Latest result published by the measurement task
+struct MeasurementSample {
+    float    distanceCm;   // Median of the burst, -1 if every ping failed
+    uint32_t timestampMs;  // millis() when the burst completed
+    uint32_t sequence;     // Number of the tank's burst, counted when it starts
+    uint8_t  tank;         // Index into Config::tanks
+    bool     scheduled;    // true for interval bursts, false for on-demand ones
+};
+
+/**
+ * Start the measurement task; it takes ownership of the sensors
+ *
+ * @param sensors One entry per tank (Tank::MAX_TANKS), nullptr where no
+ *                sensor is fitted. Bursts never overlap across sensors.
+ */
+void measurementSetup(LevelSensor* const* sensors);
+
+// Whether a sensor is fitted for the tank
+bool measurementHasTank(uint8_t tank);
+
+// Lock-free read of a tank's most recent sample; false until its first burst completes
+bool measurementLatest(MeasurementSample& out, uint8_t tank = 0);
+
+// Ask the task for an out-of-schedule burst (returns immediately). Requests
+// arriving while a burst is pending or in flight are served by that burst;
+// with fresh, one in flight does not count and another burst follows it.
+void measurementRequest(uint8_t tank = 0, bool fresh = false);
+
+// Sequence of the tank's last started burst. Read it before a fresh
+// request: samples with a higher sequence started after the request.
+uint32_t measurementLastStarted(uint8_t tank = 0);
+
+// Request a burst that starts after this call and wait for its result;
+// false on timeout
+bool measurementFresh(unsigned long timeoutMs, MeasurementSample& out, uint8_t tank = 0);
+
+// Age of a sample in milliseconds
+unsigned long measurementAgeMs(const MeasurementSample& sample);
+
+// Bounds of the adaptive schedule (see scheduler.h) for every tank; applied
+// from the next burst
+void measurementSetIntervalBounds(uint32_t minMs, uint32_t maxMs);
+
+// Current delay between scheduled bursts of a tank
+uint32_t measurementIntervalMs(uint8_t tank = 0);
+
+#endif // MEASUREMENT_H
@@ -0,0 +1,30 @@
+#include "scheduler.h"
+#include <math.h>
+#include "../constants.h"
+
+IntervalScheduler::IntervalScheduler()
+    : minMs(Timing::MEASURE_INTERVAL_MS), maxMs(Timing::MEASURE_INTERVAL_MS),
+      current(Timing::MEASURE_INTERVAL_MS), lastCm(0.0f), haveLast(false) {}
+
+void IntervalScheduler::setBounds(uint32_t newMinMs, uint32_t newMaxMs) {
+    minMs = newMinMs;
+    maxMs = newMaxMs < newMinMs ? newMinMs : newMaxMs;
+    if (current < minMs) current = minMs;
+    if (current > maxMs) current = maxMs;
+}
+
+uint32_t IntervalScheduler::update(float distanceCm) {
+    if (distanceCm < 0) {
+        return current;
+    }
+
+    if (haveLast && fabsf(distanceCm - lastCm) >= Sensor::ADAPTIVE_CHANGE_CM) {
+        current = minMs;
+    } else {
+        // Back off: double, saturating at the maximum
+        current = (current > maxMs / 2) ? maxMs : current * 2;
+    }
+    lastCm = distanceCm;
+    haveLast = true;
+    return current;
+}
@@ -0,0 +1,43 @@
+#ifndef MEASUREMENT_SCHEDULER_H
+#define MEASUREMENT_SCHEDULER_H
+
+// Adaptive measurement interval. Deliberately free of Arduino headers so
+// it can be compiled and exercised in a host build.
+
+#include <stdint.h>
+
+/**
+ * Picks the delay until the next scheduled burst from how the level moves.
+ *
+ * A reading that differs from the previous one by Sensor::ADAPTIVE_CHANGE_CM
+ * or more (a refill in progress, the lid opened) drops the interval to the
+ * minimum; every quiet reading after that doubles it, up to the maximum.
+ * A stable tank is therefore sampled at the maximum interval, and a moving
+ * one within a minute or so.
+ */
+class IntervalScheduler {
+public:
+    IntervalScheduler();
+
+    // Bounds in ms; the current interval is clamped into them
+    void setBounds(uint32_t minMs, uint32_t maxMs);
+
+    /**
+     * Fold in a burst result
+     *
+     * @param distanceCm Burst median, or -1 if it failed (interval unchanged)
+     * @return Delay until the next scheduled burst in ms
+     */
+    uint32_t update(float distanceCm);
+
+    uint32_t interval() const { return current; }
+
+private:
+    uint32_t minMs;
+    uint32_t maxMs;
+    uint32_t current;
+    float    lastCm;
+    bool     haveLast;
+};
+
+#endif // MEASUREMENT_SCHEDULER_H
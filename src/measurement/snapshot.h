@@ -0,0 +1,52 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * Single-writer, multi-reader double-buffered seqlock.
+ *
+ * The writer fills the inactive buffer and then flips the sequence counter,
+ * so it never blocks and a reader that preempts it always sees a complete
+ * value. A reader only retries if a publish completed during its copy.
+ *
+ * T must be trivially copyable. Every read copies all of it, so a large T
+ * (a TankModel is ~150 bytes) suits values read often but published
+ * rarely; the longer the copy, the likelier a retry under frequent
+ * publishes.
+ */
+template <typename T>
+class Snapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "Snapshot<T> copies T bytewise");
+
+public:
+    // Writer side - only ever call from one task
+    void publish(const T& value) {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        buffers[(seq + 1) & 1] = value;
+        sequence.store(seq + 1, std::memory_order_release);
+    }
+
+    // Reader side - returns false until something has been published
+    bool read(T& out) const {
+        for (;;) {
+            uint32_t seq = sequence.load(std::memory_order_acquire);
+            if (seq == 0) {
+                return false;
+            }
+            out = buffers[seq & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == seq) {
+                return true;
+            }
+        }
+    }
+
+private:
+    std::atomic<uint32_t> sequence{0};
+    T buffers[2];
+};
+
+#endif // SNAPSHOT_H
@@ -4,6 +4,8 @@
 #include "../secrets.h"
 #include "../constants.h"
 #include "../logger.h"
+#include "../json/json_writer.h"
+#include "../sensor/temperature.h"
 #include "mqtt.h"
 
 #if MQTT_ENABLED
@@ -14,11 +16,29 @@ static unsigned long lastReconnectAttempt = 0;
 
 static void mqttCallback(char* topic, byte* payload, unsigned int length) {
     Logger::debugf("MQTT message received on topic: %s", topic);
-    
-    // Handle incoming messages if needed
-    // For now, this is just a placeholder
-    (void)payload;
-    (void)length;
+
+    // The only command topic: <prefix>/temperature/set, a plain number in C
+    char expected[Limits::TOPIC_BUFFER_LENGTH];
+    snprintf(expected, sizeof(expected), "%s/temperature/set", MQTT_PREFIX);
+    if (strcmp(topic, expected) != 0) {
+        return;
+    }
+
+    char value[16];
+    if (length == 0 || length >= sizeof(value)) {
+        Logger::warn("MQTT temperature payload rejected");
+        return;
+    }
+    memcpy(value, payload, length);
+    value[length] = '\0';
+
+    char* end;
+    float celsius = strtof(value, &end);
+    if (end == value) {
+        Logger::warnf("MQTT temperature payload not a number: %s", value);
+        return;
+    }
+    temperaturePush(celsius);
 }
 
 static bool connectMqtt() {
@@ -45,10 +65,10 @@ static bool connectMqtt() {
     if (connected) {
         Logger::info("MQTT connected successfully");
         
-        // Subscribe to command topics if needed
-        // char topic[Limits::TOPIC_BUFFER_LENGTH];
-        // snprintf(topic, sizeof(topic), "%s/command", MQTT_PREFIX);
-        // mqttClient.subscribe(topic);
+        // Air temperature for the speed of sound (e.g. from Home Assistant)
+        char topic[Limits::TOPIC_BUFFER_LENGTH];
+        snprintf(topic, sizeof(topic), "%s/temperature/set", MQTT_PREFIX);
+        mqttClient.subscribe(topic);
         
         return true;
     } else {
@@ -77,7 +97,7 @@ void mqttLoop() {
     }
 }
 
-bool mqttPublishDistance(float distanceCm) {
+bool mqttPublishTankDistance(uint8_t tank, float distanceCm) {
     // Ensure connection
     if (!mqttClient.connected()) {
         Logger::debug("MQTT not connected, attempting reconnect...");
@@ -88,7 +108,11 @@ bool mqttPublishDistance(float distanceCm) {
     }
 
     char topic[Limits::TOPIC_BUFFER_LENGTH];
-    snprintf(topic, sizeof(topic), "%s/distance_cm", MQTT_PREFIX);
+    if (tank == 0) {
+        snprintf(topic, sizeof(topic), "%s/distance_cm", MQTT_PREFIX);
+    } else {
+        snprintf(topic, sizeof(topic), "%s/tank%u/distance_cm", MQTT_PREFIX, tank + 1);
+    }
 
     char payload[32];
     dtostrf(distanceCm, 0, 2, payload);
@@ -105,6 +129,70 @@ bool mqttPublishDistance(float distanceCm) {
     return success;
 }
 
+bool mqttPublishForecast(float rateCmPerDay, float daysUntilEmpty) {
+    if (!mqttClient.connected()) {
+        if (!connectMqtt()) {
+            return false;
+        }
+    }
+
+    char topic[Limits::TOPIC_BUFFER_LENGTH];
+    char payload[32];
+
+    snprintf(topic, sizeof(topic), "%s/consumption_cm_per_day", MQTT_PREFIX);
+    dtostrf(rateCmPerDay, 0, 3, payload);
+    bool success = mqttClient.publish(topic, payload, false);
+
+    // Empty payload when the level is not dropping (unknown in Home Assistant)
+    snprintf(topic, sizeof(topic), "%s/days_until_empty", MQTT_PREFIX);
+    if (daysUntilEmpty >= 0.0f) {
+        dtostrf(daysUntilEmpty, 0, 1, payload);
+    } else {
+        payload[0] = '\0';
+    }
+    success = mqttClient.publish(topic, payload, false) && success;
+
+    if (success) {
+        Logger::infof("MQTT forecast published: %.3f cm/day, %.1f days left",
+                      rateCmPerDay, daysUntilEmpty);
+    } else {
+        Logger::error("MQTT forecast publish failed");
+    }
+
+    return success;
+}
+
+bool mqttPublishEvent(const char* type, uint32_t timestamp, float deltaCm, float levelCm) {
+    if (!mqttClient.connected()) {
+        if (!connectMqtt()) {
+            return false;
+        }
+    }
+
+    char topic[Limits::TOPIC_BUFFER_LENGTH];
+    snprintf(topic, sizeof(topic), "%s/event", MQTT_PREFIX);
+
+    char payload[128];
+    JsonWriter w(payload, sizeof(payload));
+    w.beginObject()
+       .field("type", type)
+       .field("timestamp", static_cast<unsigned long>(timestamp))
+       .field("delta_cm", deltaCm, 1)
+       .field("level_cm", levelCm, 1)
+     .endObject();
+
+    // Not retained: every event is a new occurrence, not a state
+    bool success = w.ok() && mqttClient.publish(topic, payload, false);
+
+    if (success) {
+        Logger::infof("MQTT event published: %s", payload);
+    } else {
+        Logger::errorf("MQTT event publish failed: %s", type);
+    }
+
+    return success;
+}
+
 bool mqttPublishStatus(const char* status) {
     if (!mqttClient.connected()) {
         if (!connectMqtt()) {
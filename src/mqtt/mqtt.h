@@ -1,6 +1,7 @@
 #ifndef MQTT_HELPER_H
 #define MQTT_HELPER_H
 
+#include <stdint.h>
 #include "../secrets.h"
 
 #if MQTT_ENABLED
@@ -11,8 +12,15 @@ void mqttSetup();
 // Handle MQTT loop (reconnect if needed)
 void mqttLoop();
 
-// Publish distance measurement to MQTT
-bool mqttPublishDistance(float distanceCm);
+// Publish a tank's distance measurement to MQTT: <prefix>/distance_cm for the
+// first tank, <prefix>/tank<N>/distance_cm (N from 2) for the others
+bool mqttPublishTankDistance(uint8_t tank, float distanceCm);
+
+// Publish the consumption forecast (daysUntilEmpty < 0: not dropping)
+bool mqttPublishForecast(float rateCmPerDay, float daysUntilEmpty);
+
+// Publish a level event (refill, regeneration, glitch) as JSON
+bool mqttPublishEvent(const char* type, uint32_t timestamp, float deltaCm, float levelCm);
 
 // Publish status message to MQTT
 bool mqttPublishStatus(const char* status);
@@ -25,7 +33,9 @@ bool isMqttConnected();
 // Stub implementations when MQTT is disabled
 inline void mqttSetup() {}
 inline void mqttLoop() {}
-inline bool mqttPublishDistance(float) { return false; }
+inline bool mqttPublishTankDistance(uint8_t, float) { return false; }
+inline bool mqttPublishForecast(float, float) { return false; }
+inline bool mqttPublishEvent(const char*, uint32_t, float, float) { return false; }
 inline bool mqttPublishStatus(const char*) { return false; }
 inline bool isMqttConnected() { return false; }
 
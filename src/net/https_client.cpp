@@ -0,0 +1,348 @@
+#include "https_client.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../logger.h"
+
+static HttpsClient* clients[Network::HTTPS_MAX_CLIENTS];
+static size_t       clientCount = 0;
+
+// Body length when the server marks the end by closing the connection
+static const size_t UNTIL_CLOSE = static_cast<size_t>(-1);
+
+HttpsClient::HttpsClient(const char* name, const char* baseUrl, const char* caCert)
+    : clientName(name), port(443), valid(false), lastUsedMs(0) {
+    memset(&counters, 0, sizeof(counters));
+    hostName[0] = '\0';
+    basePath[0] = '\0';
+
+    // "https://host[:port][/path]", split once here rather than per request
+    static const char SCHEME[] = "https://";
+    if (baseUrl && strncmp(baseUrl, SCHEME, sizeof(SCHEME) - 1) == 0) {
+        const char* host = baseUrl + sizeof(SCHEME) - 1;
+        size_t hostLength = strcspn(host, ":/");
+        const char* rest = host + hostLength;
+        if (*rest == ':') {
+            port = static_cast<uint16_t>(atoi(rest + 1));
+            rest += strcspn(rest, "/");
+        }
+        size_t pathLength = strlen(rest);
+        if (pathLength > 0 && rest[pathLength - 1] == '/') {
+            pathLength--;
+        }
+        valid = hostLength > 0 && hostLength < sizeof(hostName) &&
+                pathLength < sizeof(basePath) && port != 0;
+        if (valid) {
+            memcpy(hostName, host, hostLength);
+            hostName[hostLength] = '\0';
+            memcpy(basePath, rest, pathLength);
+            basePath[pathLength] = '\0';
+        }
+    }
+
+    if (caCert) {
+        client.setCACert(caCert);
+    } else {
+        client.setInsecure();
+    }
+    client.setHandshakeTimeout(Network::HTTPS_TIMEOUT_MS / 1000);
+    counters.verified = caCert != nullptr;
+    published.publish(counters);
+
+    if (clientCount < Network::HTTPS_MAX_CLIENTS) {
+        clients[clientCount++] = this;
+    }
+}
+
+void HttpsClient::sampleHeap() {
+    uint32_t freeHeap = ESP.getFreeHeap();
+    if (freeHeap < counters.lowestFreeHeap) {
+        counters.lowestFreeHeap = freeHeap;
+    }
+}
+
+bool HttpsClient::connect() {
+    uint32_t heapBefore = ESP.getFreeHeap();
+    unsigned long startMs = millis();
+    bool ok = client.connect(hostName, port) == 1;
+    uint32_t elapsed = millis() - startMs;
+
+    if (!ok) {
+        Logger::errorf("%s: TLS connection to %s failed after %lu ms",
+                      clientName, hostName, static_cast<unsigned long>(elapsed));
+        client.stop();
+        return false;
+    }
+
+    uint32_t heapAfter = ESP.getFreeHeap();
+    counters.handshakes++;
+    counters.lastHandshakeMs  = elapsed;
+    counters.maxHandshakeMs   = elapsed > counters.maxHandshakeMs ? elapsed : counters.maxHandshakeMs;
+    counters.sessionHeapBytes = heapBefore > heapAfter ? heapBefore - heapAfter : 0;
+    sampleHeap();
+
+    Logger::infof("%s: TLS handshake with %s took %lu ms, %lu bytes of heap",
+                 clientName, hostName, static_cast<unsigned long>(elapsed),
+                 static_cast<unsigned long>(counters.sessionHeapBytes));
+    return true;
+}
+
+// One line of the response head, without the CRLF (truncated to fit)
+bool HttpsClient::readLine(char* line, size_t length, uint32_t startMs) {
+    size_t n = 0;
+    for (;;) {
+        int c = client.read();
+        if (c < 0) {
+            if (!client.connected() || millis() - startMs >= Network::HTTPS_TIMEOUT_MS) {
+                return false;
+            }
+            delay(1);
+            continue;
+        }
+        if (c == '\n') {
+            line[n] = '\0';
+            return true;
+        }
+        if (c != '\r' && n + 1 < length) {
+            line[n++] = static_cast<char>(c);
+        }
+    }
+}
+
+bool HttpsClient::readBody(size_t length, String* response, uint32_t startMs) {
+    uint8_t buffer[64];
+    size_t remaining = length;
+
+    while (remaining > 0) {
+        int available = client.available();
+        if (available <= 0) {
+            if (!client.connected()) {
+                return length == UNTIL_CLOSE;
+            }
+            if (millis() - startMs >= Network::HTTPS_TIMEOUT_MS) {
+                return false;
+            }
+            delay(1);
+            continue;
+        }
+
+        size_t want = sizeof(buffer);
+        if (want > static_cast<size_t>(available)) want = available;
+        if (want > remaining) want = remaining;
+        int n = client.read(buffer, want);
+        if (n <= 0) {
+            continue;
+        }
+        for (int i = 0; i < n && response && response->length() < Network::HTTPS_RESPONSE_LENGTH; i++) {
+            *response += static_cast<char>(buffer[i]);
+        }
+        if (length != UNTIL_CLOSE) {
+            remaining -= n;
+        }
+    }
+    return true;
+}
+
+bool HttpsClient::readChunked(String* response, uint32_t startMs) {
+    char line[32];
+    for (;;) {
+        if (!readLine(line, sizeof(line), startMs)) {
+            return false;
+        }
+        size_t size = strtoul(line, nullptr, 16);
+        if (size == 0) {
+            break;
+        }
+        if (!readBody(size, response, startMs) || !readLine(line, sizeof(line), startMs)) {
+            return false;
+        }
+    }
+
+    // Trailers up to the empty line
+    do {
+        if (!readLine(line, sizeof(line), startMs)) {
+            return false;
+        }
+    } while (line[0] != '\0');
+    return true;
+}
+
+// Write the request and read the response. A response cut short after the
+// status line still returns its status, and closes the connection.
+HttpsClient::Exchange HttpsClient::exchange(const char* method, const String& path, const String& headers,
+                           const String& body, int& status, String* response) {
+    String head;
+    head.reserve(160 + path.length() + headers.length());
+    head += method;
+    head += " ";
+    head += basePath;
+    head += path;
+    head += " HTTP/1.1\r\nHost: ";
+    head += hostName;
+    head += "\r\nUser-Agent: SaltLevelMonitor\r\nConnection: keep-alive\r\n";
+    head += headers;
+    if (body.length() > 0 || strcmp(method, "POST") == 0) {
+        head += "Content-Length: ";
+        head += String(static_cast<unsigned>(body.length()));
+        head += "\r\n";
+    }
+    head += "\r\n";
+
+    if (client.write(reinterpret_cast<const uint8_t*>(head.c_str()), head.length()) != head.length() ||
+        (body.length() > 0 &&
+         client.write(reinterpret_cast<const uint8_t*>(body.c_str()), body.length()) != body.length())) {
+        return Exchange::DROPPED;
+    }
+    sampleHeap();
+
+    // A kept-alive connection the server had already closed ends before the
+    // first byte of a response; a slow server just keeps it open
+    uint32_t startMs = millis();
+    while (client.available() <= 0) {
+        if (!client.connected()) {
+            return Exchange::DROPPED;
+        }
+        if (millis() - startMs >= Network::HTTPS_TIMEOUT_MS) {
+            return Exchange::FAILED;
+        }
+        delay(1);
+    }
+
+    // Status line: "HTTP/1.1 200 OK"
+    char line[128];
+    if (!readLine(line, sizeof(line), startMs) || strncmp(line, "HTTP/1.", 7) != 0) {
+        return Exchange::FAILED;
+    }
+    bool keepAlive = line[7] == '1';
+    const char* code = strchr(line, ' ');
+    status = code ? atoi(code + 1) : -1;
+
+    long contentLength = -1;
+    bool chunked = false;
+    bool complete = true;
+    for (;;) {
+        if (!readLine(line, sizeof(line), startMs)) {
+            complete = false;
+            break;
+        }
+        if (line[0] == '\0') {
+            break;
+        }
+        for (char* p = line; *p; p++) {
+            *p = static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+        }
+        if (strncmp(line, "content-length:", 15) == 0) {
+            contentLength = atol(line + 15);
+        } else if (strncmp(line, "transfer-encoding:", 18) == 0) {
+            chunked = strstr(line + 18, "chunked") != nullptr;
+        } else if (strncmp(line, "connection:", 11) == 0) {
+            keepAlive = strstr(line + 11, "close") == nullptr;
+        }
+    }
+
+    if (complete && status != 204 && status != 304) {
+        if (chunked) {
+            complete = readChunked(response, startMs);
+        } else if (contentLength >= 0) {
+            complete = readBody(static_cast<size_t>(contentLength), response, startMs);
+        } else {
+            complete = readBody(UNTIL_CLOSE, response, startMs);
+            keepAlive = false;
+        }
+    }
+    sampleHeap();
+
+    if (!complete || !keepAlive) {
+        client.stop();
+    }
+    return Exchange::DONE;
+}
+
+int HttpsClient::request(const char* method, const String& path, const String& headers,
+                         const String& body, String* response) {
+    if (response) {
+        *response = "";
+    }
+    if (!valid) {
+        Logger::errorf("%s: server URL must look like https://host[:port][/path]", clientName);
+        return -1;
+    }
+
+    unsigned long startMs = millis();
+    counters.requests++;
+    counters.lowestFreeHeap = ESP.getFreeHeap();
+
+    int status = -1;
+    bool reused = client.connected();
+    Exchange result = Exchange::FAILED;
+    if (reused || connect()) {
+        result = exchange(method, path, headers, body, status, response);
+    }
+    if (result == Exchange::DROPPED && reused) {
+        // The server closed the kept-alive connection in the meantime
+        Logger::debugf("%s: kept-alive connection dropped, reconnecting", clientName);
+        client.stop();
+        reused = false;
+        result = Exchange::FAILED;
+        if (connect()) {
+            result = exchange(method, path, headers, body, status, response);
+        }
+    }
+    bool ok = result == Exchange::DONE;
+
+    if (reused) {
+        counters.reused++;
+    }
+    if (!ok) {
+        counters.failures++;
+        client.stop();
+        status = -1;
+    }
+    counters.lastRequestMs = millis() - startMs;
+    counters.connected     = client.connected();
+    lastUsedMs = millis();
+    published.publish(counters);
+
+    Logger::debugf("%s: %s %s -> %d in %lu ms (%s connection, lowest free heap %lu)",
+                  clientName, method, hostName, status,
+                  static_cast<unsigned long>(counters.lastRequestMs),
+                  reused ? "reused" : "new", static_cast<unsigned long>(counters.lowestFreeHeap));
+    return status;
+}
+
+uint32_t HttpsClient::closeIdle() {
+    if (!counters.connected) {
+        return portMAX_DELAY;
+    }
+
+    uint32_t idleMs = millis() - lastUsedMs;
+    if (client.connected() && idleMs < Network::HTTPS_IDLE_MS) {
+        return Network::HTTPS_IDLE_MS - idleMs;
+    }
+
+    // Frees the TLS buffers until the next request
+    client.stop();
+    counters.connected = false;
+    published.publish(counters);
+    Logger::debugf("%s: idle connection closed", clientName);
+    return portMAX_DELAY;
+}
+
+size_t httpsClientCount() {
+    return clientCount;
+}
+
+HttpsClient* httpsClientAt(size_t index) {
+    return index < clientCount ? clients[index] : nullptr;
+}
+
+uint32_t httpsCloseIdle() {
+    uint32_t waitMs = portMAX_DELAY;
+    for (size_t i = 0; i < clientCount; i++) {
+        uint32_t next = clients[i]->closeIdle();
+        if (next < waitMs) {
+            waitMs = next;
+        }
+    }
+    return waitMs;
+}
@@ -0,0 +1,106 @@
+#ifndef HTTPS_CLIENT_H
+#define HTTPS_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include "../constants.h"
+#include "../measurement/snapshot.h"
+
+// Counters of one host, for the API
+struct HttpsStats {
+    uint32_t requests;
+    uint32_t failures;          // No response (connect, write or read failed)
+    uint32_t handshakes;        // New TLS connections
+    uint32_t reused;            // Requests sent on an open connection
+    uint32_t lastHandshakeMs;
+    uint32_t maxHandshakeMs;
+    uint32_t lastRequestMs;     // Whole request, handshake included
+    uint32_t sessionHeapBytes;  // Heap taken by the last handshake (TLS buffers)
+    uint32_t lowestFreeHeap;    // Lowest free heap sampled during the last request
+    bool     connected;
+    bool     verified;          // Server certificate checked against a pinned CA
+};
+
+/**
+ * HTTPS client for one host that keeps its TLS connection open.
+ *
+ * A new connection costs a full mbedTLS handshake: seconds of CPU and
+ * about 40 KB of heap. Requests to the same host therefore go out on the
+ * open connection (HTTP/1.1 keep-alive), and it is only closed after
+ * Network::HTTPS_IDLE_MS without traffic (closeIdle()) or when the server
+ * closes it. A request on a connection the server has dropped meanwhile
+ * (the write fails, or it closes before any byte of a response) is sent
+ * again once on a fresh one. One that timed out waiting for the response
+ * is not: the server may already have acted on it.
+ *
+ * With a CA certificate (PEM) the server is verified; without one, TLS
+ * still encrypts but anyone on the path could pose as the server.
+ *
+ * request() and closeIdle() belong to one task (the notifier); stats()
+ * may be read from any task.
+ */
+class HttpsClient {
+public:
+    /**
+     * @param name    Short name for logs and the API ("bark")
+     * @param baseUrl "https://host[:port][/path]"; request paths are appended
+     * @param caCert  PEM root certificate to pin, or nullptr for none
+     */
+    HttpsClient(const char* name, const char* baseUrl, const char* caCert);
+
+    /**
+     * Send a request and read the response
+     *
+     * @param method   "GET" or "POST"
+     * @param path     Appended to the base URL, starting with '/'
+     * @param headers  Extra header lines, each ending in "\r\n" (may be empty)
+     * @param body     Request body (may be empty)
+     * @param response Receives up to Network::HTTPS_RESPONSE_LENGTH of the body, or nullptr
+     * @return HTTP status code, or -1 if there was no response
+     */
+    int request(const char* method, const String& path, const String& headers,
+                const String& body, String* response = nullptr);
+
+    // Close the connection once it has been idle long enough; returns the
+    // time until that is due, or portMAX_DELAY if nothing is open
+    uint32_t closeIdle();
+
+    bool stats(HttpsStats& out) const { return published.read(out); }
+    const char* name() const { return clientName; }
+    const char* host() const { return hostName; }
+
+private:
+    // How exchange() ended
+    enum class Exchange : uint8_t {
+        DONE,       // A status line came back
+        DROPPED,    // The connection was gone before the server answered
+        FAILED      // Timed out or garbled; the request may have been acted on
+    };
+
+    bool connect();
+    Exchange exchange(const char* method, const String& path, const String& headers,
+                  const String& body, int& status, String* response);
+    bool readLine(char* line, size_t length, uint32_t startMs);
+    bool readBody(size_t length, String* response, uint32_t startMs);
+    bool readChunked(String* response, uint32_t startMs);
+    void sampleHeap();
+
+    WiFiClientSecure client;
+    const char*      clientName;
+    char             hostName[Network::HTTPS_HOST_LENGTH];
+    char             basePath[Network::HTTPS_HOST_LENGTH];
+    uint16_t         port;
+    bool             valid;
+    uint32_t         lastUsedMs;
+    HttpsStats       counters;
+    Snapshot<HttpsStats> published;
+};
+
+// Every HttpsClient, in construction order (for the API and closeIdle)
+size_t httpsClientCount();
+HttpsClient* httpsClientAt(size_t index);
+
+// closeIdle() on every client; returns the time until the next one is due
+uint32_t httpsCloseIdle();
+
+#endif // HTTPS_CLIENT_H
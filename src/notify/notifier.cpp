@@ -0,0 +1,491 @@
+#include "notifier.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include <time.h>
+#include "../logger.h"
+#include "../bark/bark.h"
+#include "../ntfy/ntfy.h"
+#include "../net/https_client.h"
+
+static const char* NVS_NAMESPACE = "outbox";
+static const char* NVS_KEY       = "alerts";
+
+// ---------------------------------------------------------------------------
+// Globals
+// ---------------------------------------------------------------------------
+// The part of a queued alert kept in NVS
+struct StoredAlert {
+    uint32_t sequence;      // Queue order, also across reboots
+    uint32_t queuedAt;      // Unix time, 0 if the clock was not set
+    float    distanceCm;
+    float    percent;
+    uint8_t  tank;
+    uint8_t  pending;       // Bit per NotifyChannel still to deliver
+    uint8_t  delivered;
+    uint8_t  done;          // Every channel settled, waiting for notifierPoll()
+    uint8_t  attempts[NOTIFY_CHANNEL_COUNT];
+    uint8_t  reserved[2];
+    char     label[Tank::NAME_LENGTH + 8];
+    char     barkKey[Limits::BARK_KEY_LENGTH];
+    char     ntfyTopic[Limits::NTFY_TOPIC_LENGTH];
+};
+
+struct Job {
+    bool        used;
+    StoredAlert alert;
+    uint32_t    nextAttemptMs[NOTIFY_CHANNEL_COUNT];
+};
+
+static const uint8_t MAX_ATTEMPTS[NOTIFY_CHANNEL_COUNT] = {
+    Notification::BARK_MAX_ATTEMPTS,
+    Notification::NTFY_MAX_ATTEMPTS
+};
+
+// Shared by the loop task (enqueue, poll), the web server (status) and the
+// delivery task; every access holds the mutex, none across a request
+static Job                 jobs[Notification::QUEUE_LENGTH];
+static NotifyChannelStatus channelStats[NOTIFY_CHANNEL_COUNT];
+static uint32_t            nextSequence = 1;
+static bool                wifiWait = false;
+static SemaphoreHandle_t   mutex = nullptr;
+static TaskHandle_t        taskHandle = nullptr;
+
+// Outbox writes: alerts added or settled are saved at once, retry counters
+// only every Notification::OUTBOX_FLUSH_MS
+static bool                outboxDirty = false;
+static bool                outboxUrgent = false;
+static uint32_t            dirtySinceMs = 0;
+
+// Nothing to wake if the task could not be started
+static void wakeTask() {
+    if (taskHandle) {
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
+static bool isDue(uint32_t now, uint32_t atMs) {
+    return static_cast<int32_t>(now - atMs) >= 0;
+}
+
+// Delay after the n-th failed attempt: RETRY_BASE_MS, doubling up to RETRY_MAX_MS
+static uint32_t backoffMs(uint8_t attempts) {
+    uint32_t delayMs = Notification::RETRY_BASE_MS;
+    for (uint8_t i = 1; i < attempts && delayMs < Notification::RETRY_MAX_MS; i++) {
+        delayMs *= 2;
+    }
+    return delayMs < Notification::RETRY_MAX_MS ? delayMs : Notification::RETRY_MAX_MS;
+}
+
+// ---------------------------------------------------------------------------
+// Outbox (NVS)
+// ---------------------------------------------------------------------------
+// Caller holds the mutex
+static void markDirty(bool urgent) {
+    if (!outboxDirty) {
+        dirtySinceMs = millis();
+    }
+    outboxDirty = true;
+    outboxUrgent = outboxUrgent || urgent;
+}
+
+// Write every queued alert, oldest first. Caller holds the mutex.
+static void saveOutbox() {
+    StoredAlert ordered[Notification::QUEUE_LENGTH];
+    size_t n = 0;
+    for (size_t i = 0; i < Notification::QUEUE_LENGTH; i++) {
+        if (!jobs[i].used) {
+            continue;
+        }
+        // Insertion sort by sequence; the queue is a handful of entries
+        size_t pos = n++;
+        while (pos > 0 && ordered[pos - 1].sequence > jobs[i].alert.sequence) {
+            ordered[pos] = ordered[pos - 1];
+            pos--;
+        }
+        ordered[pos] = jobs[i].alert;
+    }
+
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, false);
+    if (n == 0) {
+        prefs.remove(NVS_KEY);
+    } else if (prefs.putBytes(NVS_KEY, ordered, n * sizeof(StoredAlert)) == 0) {
+        Logger::error("Notification outbox: NVS write failed");
+    }
+    prefs.end();
+
+    outboxDirty = false;
+    outboxUrgent = false;
+}
+
+static void loadOutbox() {
+    StoredAlert stored[Notification::QUEUE_LENGTH];
+    size_t n = 0;
+
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, true);  // Read-only
+    size_t length = prefs.getBytesLength(NVS_KEY);
+    if (length > 0 && length <= sizeof(stored) && length % sizeof(StoredAlert) == 0) {
+        prefs.getBytes(NVS_KEY, stored, length);
+        n = length / sizeof(StoredAlert);
+    }
+    prefs.end();
+
+    // Attempts carry over; the first retry goes out as soon as WiFi is up
+    uint32_t now = millis();
+    for (size_t i = 0; i < n; i++) {
+        Job& job = jobs[i];
+        job.used  = true;
+        job.alert = stored[i];
+        job.alert.label[sizeof(job.alert.label) - 1] = '\0';
+        job.alert.barkKey[sizeof(job.alert.barkKey) - 1] = '\0';
+        job.alert.ntfyTopic[sizeof(job.alert.ntfyTopic) - 1] = '\0';
+        for (uint8_t c = 0; c < NOTIFY_CHANNEL_COUNT; c++) {
+            job.nextAttemptMs[c] = now;
+        }
+        if (job.alert.sequence >= nextSequence) {
+            nextSequence = job.alert.sequence + 1;
+        }
+    }
+
+    Logger::infof("Notification outbox: %u alerts restored", static_cast<unsigned>(n));
+}
+
+// ---------------------------------------------------------------------------
+// Task (owns the HTTPS requests and the outbox writes)
+// ---------------------------------------------------------------------------
+static bool send(const StoredAlert& alert, NotifyChannel channel) {
+    char title[Tank::NAME_LENGTH + 32];
+    char message[64];
+    if (alert.label[0] != '\0') {
+        snprintf(title, sizeof(title), "Salt Level Low - %s", alert.label);
+        snprintf(message, sizeof(message), "Distance %.1fcm (%.0f%% full)",
+                 alert.distanceCm, alert.percent);
+    }
+
+    if (channel == NotifyChannel::BARK) {
+        return alert.label[0] != '\0'
+            ? barkSendCustomNotification(alert.barkKey, title, message)
+            : barkSendLowSaltNotification(alert.barkKey, alert.distanceCm, alert.percent);
+    }
+    return alert.label[0] != '\0'
+        ? ntfySendCustomNotification(alert.ntfyTopic, title, message)
+        : ntfySendLowSaltNotification(alert.ntfyTopic, alert.distanceCm, alert.percent);
+}
+
+// Oldest queued attempt that is due; otherwise the time until the next one
+static bool nextAttempt(uint32_t now, int& jobIndex, uint8_t& channel, uint32_t& waitMs) {
+    bool found = false;
+    uint32_t oldest = 0;
+    waitMs = portMAX_DELAY;
+
+    for (size_t i = 0; i < Notification::QUEUE_LENGTH; i++) {
+        const Job& job = jobs[i];
+        if (!job.used || job.alert.done) {
+            continue;
+        }
+        for (uint8_t c = 0; c < NOTIFY_CHANNEL_COUNT; c++) {
+            if (!(job.alert.pending & (1u << c))) {
+                continue;
+            }
+            if (isDue(now, job.nextAttemptMs[c])) {
+                if (!found || job.alert.sequence < oldest) {
+                    found    = true;
+                    oldest   = job.alert.sequence;
+                    jobIndex = static_cast<int>(i);
+                    channel  = c;
+                }
+            } else if (job.nextAttemptMs[c] - now < waitMs) {
+                waitMs = job.nextAttemptMs[c] - now;
+            }
+        }
+    }
+    return found;
+}
+
+// Save the outbox if it is due; returns the time until the next save is due
+static uint32_t flushIfDue(uint32_t now) {
+    uint32_t waitMs = portMAX_DELAY;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (outboxDirty) {
+        uint32_t age = now - dirtySinceMs;
+        if (outboxUrgent || age >= Notification::OUTBOX_FLUSH_MS) {
+            saveOutbox();
+        } else {
+            waitMs = Notification::OUTBOX_FLUSH_MS - age;
+        }
+    }
+    xSemaphoreGive(mutex);
+
+    return waitMs;
+}
+
+static void notifierTask(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        uint32_t flushWaitMs = flushIfDue(millis());
+
+        // Attempts made without a connection would only burn the retries;
+        // the alerts stay in the outbox until it is back
+        if (WiFi.status() != WL_CONNECTED) {
+            wifiWait = true;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(Notification::WIFI_WAIT_MS));
+            continue;
+        }
+        wifiWait = false;
+
+        int index = -1;
+        uint8_t channel = 0;
+        uint32_t waitMs;
+        StoredAlert alert;
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        bool due = nextAttempt(millis(), index, channel, waitMs);
+        if (due) {
+            alert = jobs[index].alert;
+        }
+        xSemaphoreGive(mutex);
+
+        if (!due) {
+            // Nothing to send: release connections kept open for a burst
+            uint32_t idleWaitMs = httpsCloseIdle();
+            if (flushWaitMs < waitMs) {
+                waitMs = flushWaitMs;
+            }
+            if (idleWaitMs < waitMs) {
+                waitMs = idleWaitMs;
+            }
+            ulTaskNotifyTake(pdTRUE, waitMs == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(waitMs));
+            continue;
+        }
+
+        NotifyChannel ch = static_cast<NotifyChannel>(channel);
+        unsigned long startMs = millis();
+        bool ok = send(alert, ch);
+        uint32_t now = millis();
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        Job& job = jobs[index];
+        if (!job.used || job.alert.sequence != alert.sequence) {
+            // Cancelled while the request was in flight
+            xSemaphoreGive(mutex);
+            continue;
+        }
+        StoredAlert& stored = job.alert;
+        NotifyChannelStatus& stats = channelStats[channel];
+        uint8_t bit = 1u << channel;
+        stored.attempts[channel]++;
+        stats.attempts++;
+        stats.lastAttemptMs = now;
+        stats.lastOk = ok;
+        if (ok) {
+            stored.pending   &= ~bit;
+            stored.delivered |= bit;
+            stats.sent++;
+            Logger::infof("%s notification for tank %u delivered (%lu ms)",
+                         notifyChannelName(ch), stored.tank + 1,
+                         static_cast<unsigned long>(now - startMs));
+        } else if (stored.attempts[channel] >= MAX_ATTEMPTS[channel]) {
+            stored.pending &= ~bit;
+            stats.failed++;
+            Logger::errorf("%s notification for tank %u failed %u times, giving up",
+                          notifyChannelName(ch), stored.tank + 1, stored.attempts[channel]);
+        } else {
+            uint32_t delayMs = backoffMs(stored.attempts[channel]);
+            job.nextAttemptMs[channel] = now + delayMs;
+            Logger::warnf("%s notification for tank %u failed, retrying in %lu s",
+                         notifyChannelName(ch), stored.tank + 1,
+                         static_cast<unsigned long>(delayMs / 1000));
+        }
+        stored.done = stored.pending == 0;
+        markDirty(stored.done);
+        xSemaphoreGive(mutex);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+void notifierSetup() {
+    mutex = xSemaphoreCreateMutex();
+    loadOutbox();
+
+    BaseType_t ok = xTaskCreatePinnedToCore(notifierTask, "notify",
+                                            Tasks::NOTIFY_STACK_SIZE, nullptr,
+                                            Tasks::NOTIFY_PRIORITY, &taskHandle,
+                                            Tasks::NOTIFY_CORE);
+    if (ok != pdPASS) {
+        taskHandle = nullptr;
+        Logger::error("Failed to start notification task");
+        return;
+    }
+
+    Logger::infof("Notification task started on core %d", Tasks::NOTIFY_CORE);
+}
+
+bool notifierEnqueue(const LowSaltAlert& alert) {
+    bool bark = alert.barkKey && alert.barkKey[0] != '\0';
+    bool ntfy = alert.ntfyTopic && alert.ntfyTopic[0] != '\0';
+    if (!mutex || !taskHandle || (!bark && !ntfy)) {
+        return false;
+    }
+
+    time_t wallClock = time(nullptr);
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    Job* job = nullptr;
+    for (size_t i = 0; i < Notification::QUEUE_LENGTH; i++) {
+        if (!jobs[i].used) {
+            job = &jobs[i];
+            break;
+        }
+    }
+    if (job) {
+        uint32_t now = millis();
+        memset(job, 0, sizeof(*job));
+        job->used = true;
+
+        StoredAlert& stored = job->alert;
+        stored.sequence   = nextSequence++;
+        stored.queuedAt   = wallClock >= static_cast<time_t>(Timing::MIN_VALID_EPOCH)
+                          ? static_cast<uint32_t>(wallClock) : 0;
+        stored.tank       = alert.tank;
+        stored.distanceCm = alert.distanceCm;
+        stored.percent    = alert.percent;
+        snprintf(stored.label, sizeof(stored.label), "%s", alert.label ? alert.label : "");
+        if (bark) {
+            snprintf(stored.barkKey, sizeof(stored.barkKey), "%s", alert.barkKey);
+            stored.pending |= 1u << static_cast<uint8_t>(NotifyChannel::BARK);
+        }
+        if (ntfy) {
+            snprintf(stored.ntfyTopic, sizeof(stored.ntfyTopic), "%s", alert.ntfyTopic);
+            stored.pending |= 1u << static_cast<uint8_t>(NotifyChannel::NTFY);
+        }
+        for (uint8_t c = 0; c < NOTIFY_CHANNEL_COUNT; c++) {
+            job->nextAttemptMs[c] = now;
+        }
+        markDirty(true);
+    }
+    xSemaphoreGive(mutex);
+
+    if (!job) {
+        Logger::warn("Notification queue full, alert dropped");
+        return false;
+    }
+    wakeTask();
+    return true;
+}
+
+bool notifierPoll(NotificationResult& out) {
+    if (!mutex) {
+        return false;
+    }
+
+    bool found = false;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (size_t i = 0; i < Notification::QUEUE_LENGTH; i++) {
+        Job& job = jobs[i];
+        if (job.used && job.alert.done) {
+            out.tank      = job.alert.tank;
+            out.delivered = job.alert.delivered != 0;
+            job.used      = false;
+            found         = true;
+            markDirty(true);
+            break;
+        }
+    }
+    xSemaphoreGive(mutex);
+
+    if (found) {
+        wakeTask();
+    }
+    return found;
+}
+
+bool notifierHasAlert(uint8_t tank) {
+    if (!mutex) {
+        return false;
+    }
+
+    bool found = false;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (size_t i = 0; i < Notification::QUEUE_LENGTH; i++) {
+        if (jobs[i].used && jobs[i].alert.tank == tank) {
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(mutex);
+    return found;
+}
+
+void notifierCancel(uint8_t tank) {
+    if (!mutex) {
+        return;
+    }
+
+    size_t dropped = 0;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (size_t i = 0; i < Notification::QUEUE_LENGTH; i++) {
+        Job& job = jobs[i];
+        if (job.used && job.alert.tank == tank && !job.alert.done) {
+            job.used = false;
+            dropped++;
+        }
+    }
+    if (dropped > 0) {
+        markDirty(true);
+    }
+    xSemaphoreGive(mutex);
+
+    if (dropped > 0) {
+        Logger::infof("Tank %u alert dropped from the outbox, level is back up", tank + 1);
+        wakeTask();
+    }
+}
+
+void notifierFlush() {
+    if (!mutex) {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (outboxDirty) {
+        saveOutbox();
+    }
+    xSemaphoreGive(mutex);
+}
+
+void notifierStatus(NotifierStatus& out) {
+    memset(&out, 0, sizeof(out));
+    if (!mutex) {
+        return;
+    }
+
+    uint32_t now = millis();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    out.wifiWait = wifiWait;
+    for (size_t i = 0; i < Notification::QUEUE_LENGTH; i++) {
+        const Job& job = jobs[i];
+        if (!job.used || job.alert.done) {
+            continue;
+        }
+        NotifyJobStatus& status = out.jobs[out.queued++];
+        status.tank      = job.alert.tank;
+        status.queuedAt  = job.alert.queuedAt;
+        status.pending   = job.alert.pending;
+        status.delivered = job.alert.delivered;
+        for (uint8_t c = 0; c < NOTIFY_CHANNEL_COUNT; c++) {
+            status.attempts[c]  = job.alert.attempts[c];
+            status.retryInMs[c] = isDue(now, job.nextAttemptMs[c]) ? 0 : job.nextAttemptMs[c] - now;
+        }
+    }
+    memcpy(out.channels, channelStats, sizeof(out.channels));
+    xSemaphoreGive(mutex);
+}
+
+const char* notifyChannelName(NotifyChannel channel) {
+    return channel == NotifyChannel::BARK ? "Bark" : "ntfy";
+}
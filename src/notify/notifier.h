@@ -0,0 +1,90 @@
+#ifndef NOTIFIER_H
+#define NOTIFIER_H
+
+#include <Arduino.h>
+#include "../constants.h"
+
+enum class NotifyChannel : uint8_t {
+    BARK = 0,
+    NTFY = 1
+};
+constexpr uint8_t NOTIFY_CHANNEL_COUNT = 2;
+
+// A low-salt alert to deliver; an empty key or topic leaves that channel out
+struct LowSaltAlert {
+    uint8_t     tank;
+    float       distanceCm;
+    float       percent;
+    const char* label;      // Tank named in the message, empty with a single tank
+    const char* barkKey;
+    const char* ntfyTopic;
+};
+
+// An alert that left the queue
+struct NotificationResult {
+    uint8_t tank;
+    bool    delivered;      // At least one channel confirmed it (HTTP 200)
+};
+
+struct NotifyChannelStatus {
+    uint32_t attempts;
+    uint32_t sent;
+    uint32_t failed;        // Alerts given up after the channel's retry limit
+    uint32_t lastAttemptMs; // millis(), 0 if never tried
+    bool     lastOk;
+};
+
+struct NotifyJobStatus {
+    uint8_t  tank;
+    uint32_t queuedAt;                            // Unix time, 0 if the clock was not set
+    uint8_t  pending;                             // Bit per NotifyChannel
+    uint8_t  delivered;
+    uint8_t  attempts[NOTIFY_CHANNEL_COUNT];
+    uint32_t retryInMs[NOTIFY_CHANNEL_COUNT];
+};
+
+struct NotifierStatus {
+    bool                wifiWait;                 // Paused until WiFi is back
+    uint8_t             queued;
+    NotifyJobStatus     jobs[Notification::QUEUE_LENGTH];
+    NotifyChannelStatus channels[NOTIFY_CHANNEL_COUNT];
+};
+
+/**
+ * Restore the outbox saved in NVS and start the delivery task.
+ *
+ * Bark and ntfy requests each do a TLS handshake with a 10 s timeout, so
+ * they run here instead of in loop(), which the task watchdog guards. A
+ * failed channel is retried after Notification::RETRY_BASE_MS, doubling up
+ * to RETRY_MAX_MS, until it succeeds or reaches its attempt limit. No
+ * attempt is spent while WiFi is down.
+ *
+ * Queued alerts live in an NVS outbox, so neither a WiFi outage nor a
+ * reboot loses them; they are replayed oldest first. An alert is saved
+ * when it is queued and when it settles, while retry counters are batched
+ * into one write per Notification::OUTBOX_FLUSH_MS.
+ */
+void notifierSetup();
+
+// Queue an alert (returns immediately); false if the queue is full or no
+// channel is set
+bool notifierEnqueue(const LowSaltAlert& alert);
+
+// Collect a finished alert; call from the main loop until it returns false
+bool notifierPoll(NotificationResult& out);
+
+// Whether an alert for the tank is in the outbox (settled ones included)
+bool notifierHasAlert(uint8_t tank);
+
+// Drop the tank's alerts that have not settled (the level recovered)
+void notifierCancel(uint8_t tank);
+
+// Write pending outbox changes now (before a restart)
+void notifierFlush();
+
+// Copy of the queue and per-channel counters, for the API
+void notifierStatus(NotifierStatus& out);
+
+const char* notifyChannelName(NotifyChannel channel);
+
+#endif // NOTIFIER_H
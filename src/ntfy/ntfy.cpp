@@ -1,14 +1,23 @@
 #include "ntfy.h"
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
+#include "../secrets.h"
 #include "../logger.h"
+#include "../net/https_client.h"
 
 #ifndef NTFY_SERVER
 // Default ntfy server
 #define NTFY_SERVER "https://ntfy.sh"
 #endif
 
+#ifndef NTFY_CA_CERT
+// PEM root certificate of NTFY_SERVER (secrets.h); without one the server
+// certificate is not checked
+#define NTFY_CA_CERT nullptr
+#endif
+
+// One connection to the ntfy server, kept open between notifications
+static HttpsClient ntfy("ntfy", NTFY_SERVER, NTFY_CA_CERT);
+
 /**
  * Generate a unique ntfy topic based on ESP32 MAC address
  * Format: "saltlevelmonitor-XXXXXX" where XXXXXX is last 6 hex digits of MAC
@@ -35,48 +44,33 @@ bool ntfySendLowSaltNotification(const char* topic, float distanceCm, float perc
     }
 
     // Build notification
-    String url = String(NTFY_SERVER) + "/" + topic;
-    String title = "Salt Level Low";
+    String path = String("/") + topic;
     String message = "Distance " + String(distanceCm, 1) + "cm (" + 
                      String(percentFull, 0) + "% full)";
 
-    Logger::infof("ntfy URL: %s", url.c_str());
-
-    WiFiClientSecure client;
-    client.setInsecure();  // Skip certificate verification
-
-    HTTPClient https;
-    if (!https.begin(client, url)) {
-        Logger::error("ntfy: HTTPS begin failed");
-        return false;
-    }
+    Logger::infof("ntfy URL: %s%s", NTFY_SERVER, path.c_str());
 
     // Set headers for better notifications
-    https.addHeader("Title", title);
-    https.addHeader("Priority", "high");
-    https.addHeader("Tags", "droplet,warning");
-    
-    https.setTimeout(10000); // 10 seconds
+    String headers = "Title: Salt Level Low\r\n"
+                     "Priority: high\r\n"
+                     "Tags: droplet,warning\r\n";
 
-    int httpCode = https.POST(message);
+    String payload;
+    int httpCode = ntfy.request("POST", path, headers, message, &payload);
     
     if (httpCode > 0) {
         Logger::infof("ntfy HTTP status: %d", httpCode);
         
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = https.getString();
+        if (httpCode == 200) {
             Logger::debugf("ntfy response: %s", payload.c_str());
-            https.end();
             return true;
         } else {
-            String payload = https.getString();
             Logger::warnf("ntfy unexpected response code: %d, body: %s", httpCode, payload.c_str());
         }
     } else {
-        Logger::errorf("ntfy request failed: %s", https.errorToString(httpCode).c_str());
+        Logger::error("ntfy request failed: no response");
     }
 
-    https.end();
     return false;
 }
 
@@ -91,25 +85,18 @@ bool ntfySendCustomNotification(const char* topic, const char* title, const char
         return false;
     }
 
-    String url = String(NTFY_SERVER) + "/" + topic;
-
-    Logger::debugf("ntfy custom notification URL: %s", url.c_str());
-
-    WiFiClientSecure client;
-    client.setInsecure();
+    String path = String("/") + topic;
 
-    HTTPClient https;
-    if (!https.begin(client, url)) {
-        Logger::error("ntfy: HTTPS begin failed");
-        return false;
-    }
+    Logger::debugf("ntfy custom notification URL: %s%s", NTFY_SERVER, path.c_str());
 
-    https.addHeader("Title", title);
-    https.setTimeout(10000);
-    
-    int httpCode = https.POST(message);
+    // A line break in the title would end the header early
+    String safeTitle = String(title);
+    safeTitle.replace("\r", " ");
+    safeTitle.replace("\n", " ");
+    String headers = String("Title: ") + safeTitle + "\r\n";
+    int httpCode = ntfy.request("POST", path, headers, String(message));
     
-    bool success = (httpCode == HTTP_CODE_OK);
+    bool success = (httpCode == 200);
     
     if (success) {
         Logger::info("ntfy custom notification sent successfully");
@@ -117,6 +104,5 @@ bool ntfySendCustomNotification(const char* topic, const char* title, const char
         Logger::errorf("ntfy custom notification failed: HTTP %d", httpCode);
     }
     
-    https.end();
     return success;
 }
\ No newline at end of file
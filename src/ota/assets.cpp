@@ -0,0 +1,65 @@
+#include "assets.h"
+
+#ifdef WEB_UI_STREAMED
+#include "assets_content.h"
+#else
+#include "web_ui.h"        // Generated at build time by scripts/build_web.py
+#endif
+
+namespace saltlevel {
+
+#ifdef WEB_UI_STREAMED
+  // Plain text straight from assets_content.h
+  static const StaticAsset ASSETS[] = {
+    { "/static/app.css", "text/css",
+      reinterpret_cast<const uint8_t*>(APP_CSS), sizeof(APP_CSS) - 1, false },
+    { "/static/app.js",  "application/javascript",
+      reinterpret_cast<const uint8_t*>(APP_JS),  sizeof(APP_JS) - 1,  false },
+  };
+#else
+  // Minified and gzipped by scripts/build_web.py
+  static const StaticAsset ASSETS[] = {
+    { "/static/app.css", "text/css",
+      WEB_APP_CSS_GZ, WEB_APP_CSS_GZ_LEN, true },
+    { "/static/app.js",  "application/javascript",
+      WEB_APP_JS_GZ,  WEB_APP_JS_GZ_LEN,  true },
+  };
+#endif
+
+  static const size_t ASSET_COUNT = sizeof(ASSETS) / sizeof(ASSETS[0]);
+
+  const StaticAsset* staticAssets(size_t& count) {
+    count = ASSET_COUNT;
+    return ASSETS;
+  }
+
+  const StaticAsset* findStaticAsset(const char* path) {
+    for (size_t i = 0; i < ASSET_COUNT; i++) {
+      if (strcmp(ASSETS[i].path, path) == 0) {
+        return &ASSETS[i];
+      }
+    }
+    return nullptr;
+  }
+
+  const char* staticAssetVersion() {
+#ifdef WEB_UI_STREAMED
+    // FNV-1a over the asset contents, computed once
+    static char version[9] = "";
+    if (version[0] == '\0') {
+      uint32_t hash = 2166136261UL;
+      for (size_t i = 0; i < ASSET_COUNT; i++) {
+        for (size_t j = 0; j < ASSETS[i].length; j++) {
+          hash ^= pgm_read_byte(ASSETS[i].data + j);
+          hash *= 16777619UL;
+        }
+      }
+      snprintf(version, sizeof(version), "%08x", static_cast<unsigned>(hash));
+    }
+    return version;
+#else
+    return WEB_ASSETS_VERSION;
+#endif
+  }
+
+}
@@ -0,0 +1,28 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <Arduino.h>
+
+namespace saltlevel {
+
+  // A file served from flash under /static/
+  struct StaticAsset {
+    const char*    path;
+    const char*    contentType;
+    const uint8_t* data;
+    size_t         length;
+    bool           gzipped;    // Send with Content-Encoding: gzip
+  };
+
+  // All bundled assets
+  const StaticAsset* staticAssets(size_t& count);
+
+  // Asset served at this path, or nullptr
+  const StaticAsset* findStaticAsset(const char* path);
+
+  // Content hash used as ?v= in asset URLs and as their ETag
+  const char* staticAssetVersion();
+
+}
+
+#endif // ASSETS_H
@@ -0,0 +1,700 @@
+#ifndef ASSETS_CONTENT_H
+#define ASSETS_CONTENT_H
+
+#include <Arduino.h>
+
+// Stylesheet and script for the web interface, served from /static/.
+// scripts/build_web.py minifies and gzips these alongside the page; plain
+// JavaScript only so the UI works without internet access.
+static const char APP_CSS[] PROGMEM = R"rawliteral(
+:root {
+  font-family: system-ui, -apple-system, BlinkMacSystemFont, "Segoe UI",
+               Roboto, Helvetica, Arial, sans-serif;
+
+  /* Light theme (default) */
+  --bg-primary: #f5f5f5;
+  --bg-section: #ffffff;
+  --bg-input: #ffffff;
+  --bg-input-readonly: #eeeeee;
+  --bg-tank: #f0f0f0;
+  --bg-chip: #e0e0e0;
+  --bg-chip-online: #e3f2fd;
+  --bg-chip-muted: #eeeeee;
+  --bg-tooltip: #333;
+
+  --text-primary: #333;
+  --text-secondary: #666;
+  --text-muted: #999;
+  --text-input: #333;
+  --text-input-readonly: #666666;
+  --text-chip: #333;
+  --text-chip-online: #0d47a1;
+  --text-chip-muted: #555;
+  --text-tooltip: #fff;
+
+  --border-color: #ccc;
+  --border-tank: #444;
+  --shadow: 0 1px 3px rgba(0,0,0,0.08);
+
+  --accent-color: #1976d2;
+  --accent-light: #e3f2fd;
+  --success-color: #4caf50;
+}
+
+/* Dark theme */
+[data-theme="dark"] {
+  --bg-primary: #121212;
+  --bg-section: #1e1e1e;
+  --bg-input: #111;
+  --bg-input-readonly: #222;
+  --bg-tank: #222;
+  --bg-chip: #333;
+  --bg-chip-online: #1b3b5a;
+  --bg-chip-muted: #2a2a2a;
+  --bg-tooltip: #2a2a2a;
+
+  --text-primary: #e0e0e0;
+  --text-secondary: #aaa;
+  --text-muted: #888;
+  --text-input: #eee;
+  --text-input-readonly: #aaa;
+  --text-chip: #eee;
+  --text-chip-online: #e3f2fd;
+  --text-chip-muted: #ccc;
+  --text-tooltip: #fff;
+
+  --border-color: #555;
+  --border-tank: #888;
+  --shadow: none;
+
+  --accent-color: #64b5f6;
+  --accent-light: #1b3b5a;
+}
+
+body {
+  margin: 0;
+  padding: 0;
+  background: var(--bg-primary);
+  color: var(--text-primary);
+  transition: background 0.3s, color 0.3s;
+}
+.container {
+  max-width: 480px;
+  margin: 0 auto;
+  padding: 16px;
+  box-sizing: border-box;
+}
+h1 {
+  margin: 0 0 8px 0;
+  font-size: 1.4rem;
+  text-align: center;
+}
+h2 {
+  margin: 16px 0 8px 0;
+  font-size: 1.1rem;
+}
+h3 {
+  margin: 20px 0 4px 0;
+  font-size: 1rem;
+}
+label {
+  display: block;
+  margin-top: 10px;
+  font-size: 0.9rem;
+}
+input[type="number"],
+input[type="text"],
+input[type="password"],
+select {
+  width: 100%;
+  box-sizing: border-box;
+  padding: 8px 10px;
+  margin-top: 4px;
+  border-radius: 6px;
+  border: 1px solid var(--border-color);
+  background: var(--bg-input);
+  color: var(--text-input);
+  font-size: 0.95rem;
+  transition: background 0.3s, color 0.3s, border-color 0.3s;
+}
+input[type="number"][readonly],
+input[type="text"][readonly] {
+  background: var(--bg-input-readonly);
+  color: var(--text-input-readonly);
+  cursor: not-allowed;
+}
+input[type="submit"],
+button {
+  width: 100%;
+  box-sizing: border-box;
+  padding: 10px 12px;
+  margin-top: 12px;
+  border-radius: 6px;
+  border: none;
+  font-size: 1rem;
+  font-weight: 600;
+  background: var(--accent-color);
+  color: #fff;
+  cursor: pointer;
+  transition: background 0.3s;
+}
+input[type="submit"]:active,
+button:active {
+  transform: scale(0.98);
+}
+
+.status-row {
+  display: flex;
+  flex-wrap: wrap;
+  gap: 8px;
+  justify-content: center;
+  margin-bottom: 8px;
+}
+.chip {
+  display: inline-flex;
+  align-items: center;
+  gap: 6px;
+  padding: 4px 10px;
+  border-radius: 999px;
+  font-size: 0.75rem;
+  background: var(--bg-chip);
+  color: var(--text-chip);
+  white-space: nowrap;
+  transition: background 0.3s, color 0.3s;
+}
+.chip-online {
+  background: var(--bg-chip-online);
+  color: var(--text-chip-online);
+}
+.chip-muted {
+  background: var(--bg-chip-muted);
+  color: var(--text-chip-muted);
+}
+.chip .dot {
+  width: 8px;
+  height: 8px;
+  border-radius: 50%;
+  background: var(--success-color);
+}
+
+#tank-wrapper {
+  display: flex;
+  justify-content: center;
+  margin-top: 12px;
+}
+#tank {
+  width: 80px;
+  max-width: 30vw;
+  height: 200px;
+  max-height: 60vw;
+  border: 2px solid var(--border-tank);
+  border-radius: 10px;
+  position: relative;
+  overflow: hidden;
+  background: var(--bg-tank);
+  transition: background 0.3s, border-color 0.3s;
+}
+#tank_fill {
+  position: absolute;
+  bottom: 0;
+  left: 0;
+  width: 100%;
+  height: 0;
+  background: var(--success-color);
+  transition: height 0.4s;
+}
+#prg {
+  margin-top: 8px;
+  font-size: 0.85rem;
+}
+.section {
+  background: var(--bg-section);
+  border-radius: 10px;
+  padding: 12px;
+  margin-top: 12px;
+  box-shadow: var(--shadow);
+  transition: background 0.3s, box-shadow 0.3s;
+}
+#history_chart {
+  width: 100%;
+  height: 180px;
+  display: block;
+}
+.row {
+  display: flex;
+  justify-content: space-between;
+  gap: 8px;
+  margin-top: 6px;
+  font-size: 0.95rem;
+}
+.row span.value {
+  font-weight: 600;
+}
+.toggle-line {
+  display: flex;
+  align-items: center;
+  gap: 8px;
+  margin-top: 10px;
+  font-size: 0.9rem;
+}
+.toggle-line input[type="checkbox"] {
+  width: auto;
+  margin-top: 0;
+}
+.help-text {
+  font-size: 0.8rem;
+  color: var(--text-secondary);
+  margin-top: 4px;
+}
+
+/* Theme toggle button */
+.theme-toggle {
+  position: fixed;
+  top: 12px;
+  right: 12px;
+  width: 40px;
+  height: 40px;
+  border-radius: 50%;
+  border: none;
+  background: var(--bg-section);
+  color: var(--text-primary);
+  cursor: pointer;
+  display: flex;
+  align-items: center;
+  justify-content: center;
+  font-size: 1.2rem;
+  box-shadow: 0 2px 8px rgba(0,0,0,0.15);
+  z-index: 1000;
+  transition: background 0.3s, transform 0.2s;
+  padding: 0;
+  margin: 0;
+  width: 40px !important;
+}
+.theme-toggle:hover {
+  transform: scale(1.1);
+}
+.theme-toggle:active {
+  transform: scale(0.95);
+}
+.theme-toggle .icon-sun,
+.theme-toggle .icon-moon {
+  display: none;
+}
+[data-theme="light"] .theme-toggle .icon-moon {
+  display: block;
+}
+[data-theme="dark"] .theme-toggle .icon-sun {
+  display: block;
+}
+
+/* Label with info icon */
+.label-with-info {
+  display: flex;
+  align-items: center;
+  gap: 6px;
+  margin-top: 10px;
+  font-size: 0.9rem;
+}
+
+/* Info icon styling */
+.info-icon {
+  display: inline-flex;
+  align-items: center;
+  justify-content: center;
+  width: 18px;
+  height: 18px;
+  border-radius: 50%;
+  background: var(--accent-color);
+  color: white;
+  font-size: 0.75rem;
+  font-weight: bold;
+  cursor: help;
+  position: relative;
+  flex-shrink: 0;
+}
+
+/* Tooltip */
+.tooltip {
+  position: relative;
+  display: inline-block;
+}
+
+.tooltip .tooltiptext {
+  visibility: hidden;
+  width: 280px;
+  background-color: var(--bg-tooltip);
+  color: var(--text-tooltip);
+  text-align: left;
+  border-radius: 8px;
+  padding: 12px;
+  position: absolute;
+  z-index: 1000;
+  bottom: 125%;
+  left: 50%;
+  margin-left: -140px;
+  opacity: 0;
+  transition: opacity 0.3s;
+  font-size: 0.85rem;
+  line-height: 1.4;
+  box-shadow: 0 4px 12px rgba(0,0,0,0.3);
+  pointer-events: none;
+}
+
+[data-theme="dark"] .tooltip .tooltiptext {
+  border: 1px solid #444;
+}
+
+.tooltip .tooltiptext::after {
+  content: "";
+  position: absolute;
+  top: 100%;
+  left: 50%;
+  margin-left: -5px;
+  border-width: 5px;
+  border-style: solid;
+  border-color: var(--bg-tooltip) transparent transparent transparent;
+}
+
+/* Show on hover for desktop */
+.tooltip:hover .tooltiptext {
+  visibility: visible;
+  opacity: 1;
+}
+
+/* Show when active class is added (for mobile tap) */
+.tooltip.active .tooltiptext {
+  visibility: visible;
+  opacity: 1;
+}
+
+@media (hover: none) {
+  .tooltip .tooltiptext {
+    width: 250px;
+    margin-left: -125px;
+  }
+}
+
+.tooltip-step {
+  margin: 6px 0;
+}
+
+.tooltip-step strong {
+  color: var(--success-color);
+}
+)rawliteral";
+
+static const char APP_JS[] PROGMEM = R"rawliteral(
+// Theme management
+(function() {
+  const THEME_KEY = 'salt-monitor-theme';
+
+  function getSystemTheme() {
+    return window.matchMedia('(prefers-color-scheme: dark)').matches ? 'dark' : 'light';
+  }
+
+  function getStoredTheme() {
+    return localStorage.getItem(THEME_KEY);
+  }
+
+  function setTheme(theme) {
+    document.documentElement.setAttribute('data-theme', theme);
+    localStorage.setItem(THEME_KEY, theme);
+  }
+
+  function initTheme() {
+    const stored = getStoredTheme();
+    const theme = stored || getSystemTheme();
+    setTheme(theme);
+  }
+
+  function toggleTheme() {
+    const current = document.documentElement.getAttribute('data-theme');
+    const next = current === 'dark' ? 'light' : 'dark';
+    setTheme(next);
+  }
+
+  // Initialize theme immediately to prevent flash
+  initTheme();
+
+  // Set up toggle button after DOM loads
+  document.addEventListener('DOMContentLoaded', function() {
+    const toggleBtn = document.getElementById('theme-toggle');
+    if (toggleBtn) {
+      toggleBtn.addEventListener('click', toggleTheme);
+    }
+
+    // Listen for system theme changes
+    window.matchMedia('(prefers-color-scheme: dark)').addEventListener('change', function(e) {
+      if (!getStoredTheme()) {
+        setTheme(e.matches ? 'dark' : 'light');
+      }
+    });
+  });
+})();
+
+// OTA upload with password
+document.getElementById('upload_form').addEventListener('submit', function(e){
+  e.preventDefault();
+  var form = document.getElementById('upload_form');
+  var data = new FormData(form);
+  var prg = document.getElementById('prg');
+
+  var password = document.getElementById('ota_password').value;
+
+  var xhr = new XMLHttpRequest();
+  xhr.open('POST', '/update');
+  xhr.setRequestHeader('Authorization', 'Basic ' + btoa('admin:' + password));
+  xhr.upload.addEventListener('progress', function(evt){
+    if (evt.lengthComputable) {
+      var per = evt.loaded / evt.total * 100;
+      prg.innerHTML = 'Progress: ' + per.toFixed(0) + '%';
+    }
+  }, false);
+  xhr.onload = function() {
+    if (xhr.status === 200) {
+      prg.innerHTML = 'Update successful! Device rebooting...<br><small>Page will reload in 10 seconds</small>';
+      setTimeout(function() {
+        window.location.reload();
+      }, 10000);
+    } else if (xhr.status === 401) {
+      prg.innerHTML = 'Error: Invalid password';
+    } else if (xhr.status === 500) {
+      prg.innerHTML = 'Error: Update failed - ' + xhr.statusText;
+    } else {
+      prg.innerHTML = 'Error: ' + xhr.statusText + ' (Status: ' + xhr.status + ')';
+    }
+  };
+  xhr.onerror = function() {
+    // Connection dropped: likely a successful update followed by reboot
+    prg.innerHTML = 'Upload complete! Device rebooting...<br><small>Page will reload in 15 seconds</small>';
+    setTimeout(function() {
+      window.location.reload();
+    }, 15000);
+  };
+  xhr.send(data);
+});
+
+function updateView(obj) {
+  if (obj.distance !== undefined) {
+    document.getElementById('distance_text').textContent =
+      obj.distance.toFixed(1) + ' cm';
+  }
+  if (obj.percent !== undefined && obj.percent >= 0) {
+    var p = Math.max(0, Math.min(100, obj.percent));
+    document.getElementById('percent_text').textContent =
+      p.toFixed(1) + ' %';
+    document.getElementById('tank_fill').style.height = p + '%';
+  }
+}
+
+function updateLastMeasurementTime(ageMs) {
+  var el = document.getElementById('last_meas_text');
+  if (!el) return;
+  var when = new Date(Date.now() - (ageMs || 0));
+  var hh = String(when.getHours()).padStart(2, '0');
+  var mm = String(when.getMinutes()).padStart(2, '0');
+  el.textContent = hh + ':' + mm;
+}
+
+// Level history: [timestamp, distance_cm] pairs from /api/history
+var historyPoints = [];
+
+function drawHistory() {
+  var canvas = document.getElementById('history_chart');
+  var ctx = canvas.getContext('2d');
+  var w = canvas.width, h = canvas.height;
+  var style = getComputedStyle(document.body);
+  ctx.clearRect(0, 0, w, h);
+
+  var pts = historyPoints.filter(p => p[1] !== null);
+  document.getElementById('history_text').textContent = pts.length + ' readings';
+  if (pts.length < 2 || !tankConfig) return;
+
+  // Plot fill level (%) so the graph reads like the tank above, through
+  // the firmware's tank table (a straight line if it has none)
+  var full = tankConfig.full_cm, empty = tankConfig.empty_cm;
+  var table = tankConfig.level_table;
+  function toPercent(d) {
+    var f = Math.max(0, Math.min(1, (empty - d) / (empty - full)));
+    if (!table) return f * 100;
+    var x = f * (table.length - 1), i = Math.min(Math.floor(x), table.length - 2);
+    return table[i] + (x - i) * (table[i + 1] - table[i]);
+  }
+  var t0 = pts[0][0], t1 = pts[pts.length - 1][0];
+  ctx.strokeStyle = style.getPropertyValue('--accent-color');
+  ctx.lineWidth = 2;
+  ctx.beginPath();
+  pts.forEach(function(p, i) {
+    var pct = toPercent(p[1]);
+    var x = (p[0] - t0) / Math.max(1, t1 - t0) * (w - 4) + 2;
+    var y = h - 2 - pct / 100 * (h - 4);
+    if (i === 0) ctx.moveTo(x, y); else ctx.lineTo(x, y);
+  });
+  ctx.stroke();
+}
+
+function loadHistory() {
+  var canvas = document.getElementById('history_chart');
+  fetch('/api/history?points=' + canvas.width)
+    .then(r => r.json())
+    .then(obj => {
+      historyPoints = obj.points;
+      drawHistory();
+    })
+    .catch(err => console.log(err));
+}
+
+function doMeasure(fresh) {
+  document.getElementById('distance_text').textContent = '...';
+  fetch(fresh ? '/measure?fresh=1' : '/measure')
+    .then(r => r.json())
+    .then(obj => {
+      if (obj.error) throw new Error(obj.error);
+      updateView(obj);
+      updateLastMeasurementTime(obj.age_ms);
+    })
+    .catch(err => {
+      console.log(err);
+      document.getElementById('distance_text').textContent = 'Error';
+    });
+}
+
+function setField(name, value) {
+  var el = document.querySelector('[name="' + name + '"]');
+  if (!el || value === undefined) return;
+  if (el.type === 'checkbox') {
+    el.checked = !!value;
+  } else {
+    el.value = value;
+  }
+}
+
+// Current settings come from the API rather than being baked into the page
+var tankConfig = null;
+
+function loadConfig() {
+  fetch('/api/config')
+    .then(r => r.json())
+    .then(c => {
+      tankConfig = c;
+      drawHistory();
+      setField('full_cm', c.full_cm.toFixed(1));
+      setField('empty_cm', c.empty_cm.toFixed(1));
+      setField('warn_cm', c.warn_cm.toFixed(1));
+      setField('consec_hours', c.consec_hours);
+      setField('forecast_days', c.forecast_days);
+      setField('cache_age', c.cache_age);
+      setField('interval_min', c.interval_min);
+      setField('interval_max', c.interval_max);
+      setField('filter', c.filter);
+      setField('filter_q', c.filter_q);
+      setField('filter_r', c.filter_r);
+      setField('filter_gate', c.filter_gate);
+      setField('filter_window', c.filter_window);
+      setField('tank_shape', c.tank_shape);
+      setField('tank_d1', c.tank_d1);
+      setField('tank_d2', c.tank_d2);
+      setField('tank_profile', c.tank_profile);
+      setField('salt_density', c.salt_density);
+      setField('bark_key', c.bark_key);
+      setField('bark_en', c.bark_enabled);
+      setField('ntfy_topic', c.ntfy_topic);
+      setField('ntfy_en', c.ntfy_enabled);
+      c.tanks.forEach(function(t, i) {
+        var p = 't' + i + '_';
+        setField(p + 'name', t.name);
+        setField(p + 'trig', t.trig < 0 ? '' : t.trig);
+        setField(p + 'echo', t.echo < 0 ? '' : t.echo);
+        if (i > 0) {
+          setField(p + 'full', t.full_cm.toFixed(1));
+          setField(p + 'empty', t.empty_cm.toFixed(1));
+          setField(p + 'warn', t.warn_cm.toFixed(1));
+        }
+      });
+    })
+    .catch(err => console.log(err));
+}
+
+function loadVersion() {
+  fetch('/version')
+    .then(r => r.json())
+    .then(v => {
+      document.getElementById('fw_version').textContent = 'v' + v.version;
+      document.getElementById('fw_version_footer').textContent = 'v' + v.version;
+      document.getElementById('build_time').textContent = v.build;
+    })
+    .catch(err => console.log(err));
+}
+
+// Live updates pushed by the device (Server-Sent Events)
+function connectEvents() {
+  if (!window.EventSource) return;
+  var status = document.getElementById('status_text');
+  var source = new EventSource('/events');
+
+  source.onopen = function() { status.textContent = 'Live'; };
+  source.onerror = function() { status.textContent = 'Offline'; };
+
+  // Events come for every tank; the page shows the first
+  source.addEventListener('measurement', function(e) {
+    var obj = JSON.parse(e.data);
+    if (obj.tank) return;
+    updateView(obj);
+    updateLastMeasurementTime(obj.age_ms);
+    if (obj.distance >= 0) {
+      historyPoints.push([Math.round((Date.now() - obj.age_ms) / 1000), obj.distance]);
+      drawHistory();
+    }
+  });
+  source.addEventListener('notify', function(e) {
+    var n = JSON.parse(e.data);
+    if (n.tank) return;
+    document.getElementById('alert_chip').style.display = n.warning_sent ? '' : 'none';
+  });
+  source.addEventListener('health', function(e) {
+    var h = JSON.parse(e.data);
+    document.getElementById('health_text').textContent =
+      h.wifi_rssi + ' dBm · ' + Math.round(h.heap_free / 1024) + ' kB';
+  });
+}
+
+document.getElementById('measure_btn').addEventListener('click', function(){
+  doMeasure(true);
+});
+
+window.addEventListener('load', function(){
+  loadConfig();
+  loadVersion();
+  loadHistory();
+  doMeasure(false);
+  connectEvents();
+
+  // Handle tooltip clicks for mobile
+  const tooltips = document.querySelectorAll('.tooltip');
+
+  tooltips.forEach(function(tooltip) {
+    tooltip.addEventListener('click', function(e) {
+      e.stopPropagation();
+
+      // Close all other tooltips
+      tooltips.forEach(function(t) {
+        if (t !== tooltip) {
+          t.classList.remove('active');
+        }
+      });
+
+      // Toggle this tooltip
+      tooltip.classList.toggle('active');
+    });
+  });
+
+  // Close tooltips when clicking outside
+  document.addEventListener('click', function() {
+    tooltips.forEach(function(t) {
+      t.classList.remove('active');
+    });
+  });
+});
+)rawliteral";
+
+#endif // ASSETS_CONTENT_H
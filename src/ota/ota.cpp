@@ -1,35 +1,79 @@
 #include "ota.h"
-#include "html_content.h"  // HTML content in separate file
+#include "html_content.h"  // HTML template (served raw by /debug/html)
+#include "assets.h"
+#ifdef WEB_UI_STREAMED
+#include "renderer.h"
+#include "translations.h"
+#else
+#include "web_ui.h"        // Generated at build time by scripts/build_web.py
+#endif
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WiFiClient.h>
-#include <WebServer.h>
+#include <AsyncTCP.h>
+#include <ESPAsyncWebServer.h>
 #include <ESPmDNS.h>
 #include <Update.h>
 #include <Preferences.h>
 #include <math.h>
-#include "esp_task_wdt.h"
+#include <atomic>
 #include "../constants.h"
 #include "../logger.h"
 #include "../ntfy/ntfy.h"
+#include "../measurement/measurement.h"
+#include "../measurement/snapshot.h"
+#include "../json/json_writer.h"
+#include "../history/history.h"
+#include "../history/lttb.h"
+#include "../history/event_log.h"
+#include "../sensor/temperature.h"
+#include "../analysis/tank.h"
+#include "../notify/notifier.h"
+#include "../net/https_client.h"
 
 namespace saltlevel {
 
   // -------------------------------------------------------------------------
   // Globals
   // -------------------------------------------------------------------------
-  static WebServer       server(Network::HTTP_PORT);
-  static DistanceCallback distanceCb = nullptr;
+  static AsyncWebServer   server(Network::HTTP_PORT);
+  static AsyncEventSource events("/events");
   static PublishCallback  publishCb  = nullptr;
   static Config*          cfg        = nullptr;
+  static HistoryStore*    history    = nullptr;
+  static EventLog*        eventLog   = nullptr;
   static Preferences      prefs;
   static bool             otaAuthFailed = false;
+  static uint32_t         buildId       = 0;   // Hash of the build timestamp
+
+  // *cfg belongs to the main loop, the only task that writes it. POST
+  // /config is parsed into a copy on the AsyncTCP task and handed over
+  // through pendingConfig; configMutex guards the hand-over and handler
+  // reads of *cfg that span several fields or strings.
+  static SemaphoreHandle_t configMutex   = nullptr;
+  static Config            pendingConfig;
+  static bool              configPending = false;   // Under configMutex
+
+  // Handlers run on the AsyncTCP task; work that must happen on the main
+  // loop (MQTT publish, reboot) is handed over through these
+  static std::atomic<bool> publishPending(false);
+  static float             publishDistance = -1.0f;
+  static uint8_t           publishTank     = 0;
+  static std::atomic<unsigned long> restartAtMs(0);
+  static std::atomic<int>  activeRequests(0);
+
+  // Live event stream state (written from the main loop only)
+  static Snapshot<NotificationState> notificationState[Tank::MAX_TANKS];
+  static uint32_t                    lastEventSequence[Tank::MAX_TANKS] = {};
+  static unsigned long               lastHealthEventMs = 0;
+
+  // Consumption forecast (written from the main loop, read by handlers)
+  static Snapshot<ForecastState> forecastState;
   
   // -------------------------------------------------------------------------
   // Uptime Helper (overflow-safe)
   // -------------------------------------------------------------------------
-  static String getUptimeString() {
+  static void formatUptime(char* buffer, size_t len) {
     unsigned long ms = millis();
     unsigned long seconds = ms / 1000;
     unsigned long minutes = seconds / 60;
@@ -40,33 +84,173 @@ namespace saltlevel {
     minutes %= 60;
     seconds %= 60;
     
-    char buffer[64];
     if (days > 0) {
-      snprintf(buffer, sizeof(buffer), "%lud %02lu:%02lu:%02lu", 
+      snprintf(buffer, len, "%lud %02lu:%02lu:%02lu", 
                days, hours, minutes, seconds);
     } else {
-      snprintf(buffer, sizeof(buffer), "%02lu:%02lu:%02lu", 
+      snprintf(buffer, len, "%02lu:%02lu:%02lu", 
                hours, minutes, seconds);
     }
-    return String(buffer);
   }
   
   static unsigned long getUptimeSeconds() {
     return millis() / 1000;
   }
 
+  // -------------------------------------------------------------------------
+  // HTTP caching helpers
+  // -------------------------------------------------------------------------
+  static uint32_t fnv1a(const char* str) {
+    uint32_t hash = 2166136261UL;
+    while (*str) {
+      hash ^= static_cast<uint8_t>(*str++);
+      hash *= 16777619UL;
+    }
+    return hash;
+  }
+
+  static uint32_t fnv1a(const char* data, size_t len) {
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+      hash ^= static_cast<uint8_t>(data[i]);
+      hash *= 16777619UL;
+    }
+    return hash;
+  }
+
+  // Add ETag/Cache-Control to a response. maxAgeS = 0 means "revalidate".
+  static void addCacheHeaders(AsyncWebServerResponse* response, const char* etag,
+                              unsigned long maxAgeS) {
+    char cacheControl[48];
+    if (maxAgeS > 0) {
+      snprintf(cacheControl, sizeof(cacheControl), "public, max-age=%lu, immutable", maxAgeS);
+    } else {
+      snprintf(cacheControl, sizeof(cacheControl), "no-cache");
+    }
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+  }
+
+  // Answers 304 and returns true if the client's If-None-Match already
+  // names this version
+  static bool handleConditional(AsyncWebServerRequest* request, const char* etag,
+                                unsigned long maxAgeS) {
+    AsyncWebHeader* header = request->getHeader("If-None-Match");
+    if (!header || strstr(header->value().c_str(), etag) == nullptr) {
+      return false;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse(304);
+    addCacheHeaders(response, etag, maxAgeS);
+    request->send(response);
+    return true;
+  }
+
+  // -------------------------------------------------------------------------
+  // Connection guard
+  //
+  // Registered ahead of every route. It sets a receive timeout on each
+  // connection so a stalled client is dropped, caps the number of requests
+  // in flight and refuses bodies that would have to be buffered in RAM
+  // (firmware uploads are streamed to flash and exempt).
+  // -------------------------------------------------------------------------
+  class ConnectionGuard : public AsyncWebHandler {
+    public:
+      bool canHandle(AsyncWebServerRequest* request) override {
+        // Event streams outlive their request object (no disconnect callback)
+        // and are capped separately in onEventClient()
+        if (request->url() == "/events") {
+          return false;
+        }
+
+        request->client()->setRxTimeout(Network::HTTP_RX_TIMEOUT_S);
+
+        // The server drops every request header nobody asked for
+        request->addInterestingHeader("If-None-Match");
+
+        int active = ++activeRequests;
+        request->onDisconnect([]() { --activeRequests; });
+
+        return active > Network::HTTP_MAX_CONCURRENT_REQUESTS || tooLarge(request);
+      }
+
+      // The guard is shared by every connection, so the reason is worked
+      // out again from the request rather than kept from canHandle()
+      void handleRequest(AsyncWebServerRequest* request) override {
+        int status = tooLarge(request) ? 413 : 503;
+        Logger::warnf("HTTP %d for %s", status, request->url().c_str());
+        request->send(status, "text/plain", status == 503 ? "Busy" : "Request too large");
+      }
+
+    private:
+      static bool tooLarge(AsyncWebServerRequest* request) {
+        return request->contentLength() > Limits::HTTP_MAX_BODY_LENGTH &&
+               request->url() != "/update";
+      }
+  };
+
+  static ConnectionGuard connectionGuard;
+
   // -------------------------------------------------------------------------
   // Config persistence
   // -------------------------------------------------------------------------
+  // NVS keys of a tank's settings. Tank 0 keeps the keys from before there
+  // were several tanks, so an upgrade does not lose them.
+  struct TankKeys {
+    char full[12], empty[12], warn[12], trig[12], echo[12], name[12];
+
+    explicit TankKeys(uint8_t i) {
+      if (i == 0) {
+        strcpy(full, "full_cm");
+        strcpy(empty, "empty_cm");
+        strcpy(warn, "warn_cm");
+      } else {
+        snprintf(full, sizeof(full), "t%u_full", i);
+        snprintf(empty, sizeof(empty), "t%u_empty", i);
+        snprintf(warn, sizeof(warn), "t%u_warn", i);
+      }
+      snprintf(trig, sizeof(trig), "t%u_trig", i);
+      snprintf(echo, sizeof(echo), "t%u_echo", i);
+      snprintf(name, sizeof(name), "t%u_name", i);
+    }
+  };
+
   static void loadConfigFromNvs() {
     if (!cfg) return;
 
     prefs.begin("saltcfg", false);
 
-    cfg->fullDistanceCm  = prefs.getFloat("full_cm",  cfg->fullDistanceCm);
-    cfg->emptyDistanceCm = prefs.getFloat("empty_cm", cfg->emptyDistanceCm);
-    cfg->warnDistanceCm  = prefs.getFloat("warn_cm",  cfg->warnDistanceCm);
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      TankConfig& tank = cfg->tanks[i];
+      TankKeys keys(i);
+      tank.fullDistanceCm  = prefs.getFloat(keys.full,  tank.fullDistanceCm);
+      tank.emptyDistanceCm = prefs.getFloat(keys.empty, tank.emptyDistanceCm);
+      tank.warnDistanceCm  = prefs.getFloat(keys.warn,  tank.warnDistanceCm);
+      tank.trigPin = prefs.getChar(keys.trig, tank.trigPin);
+      tank.echoPin = prefs.getChar(keys.echo, tank.echoPin);
+
+      char nameTmp[Tank::NAME_LENGTH];
+      if (prefs.getString(keys.name, nameTmp, sizeof(nameTmp)) > 0) {
+        nameTmp[sizeof(nameTmp) - 1] = '\0';
+        strncpy(tank.name, nameTmp, sizeof(tank.name));
+        tank.name[sizeof(tank.name) - 1] = '\0';
+      }
+    }
     cfg->consecutiveHoursThreshold = prefs.getUChar("consec_hrs", cfg->consecutiveHoursThreshold);
+    cfg->forecastAlertDays = prefs.getUChar("fc_days", cfg->forecastAlertDays);
+    cfg->statusMaxAgeS = prefs.getUShort("cache_age", cfg->statusMaxAgeS);
+    cfg->measureMinIntervalS = prefs.getUShort("int_min", cfg->measureMinIntervalS);
+    cfg->measureMaxIntervalS = prefs.getUShort("int_max", cfg->measureMaxIntervalS);
+    cfg->levelFilter = prefs.getUChar("flt_type", cfg->levelFilter);
+    cfg->filterProcessNoiseCm = prefs.getFloat("flt_q", cfg->filterProcessNoiseCm);
+    cfg->filterMeasurementNoiseCm = prefs.getFloat("flt_r", cfg->filterMeasurementNoiseCm);
+    cfg->filterGateSigma = prefs.getFloat("flt_gate", cfg->filterGateSigma);
+    cfg->filterWindow = prefs.getUChar("flt_win", cfg->filterWindow);
+    cfg->tankShape = prefs.getUChar("tank_shape", cfg->tankShape);
+    if (cfg->tankShape > static_cast<uint8_t>(TankShape::PROFILE)) cfg->tankShape = Tank::DEFAULT_SHAPE;
+    cfg->tankDim1Cm = prefs.getFloat("tank_d1", cfg->tankDim1Cm);
+    cfg->tankDim2Cm = prefs.getFloat("tank_d2", cfg->tankDim2Cm);
+    cfg->saltDensityKgPerL = prefs.getFloat("salt_dens", cfg->saltDensityKgPerL);
 
     // Bark key
     char tmp[Limits::BARK_KEY_LENGTH];
@@ -83,6 +267,11 @@ namespace saltlevel {
       Logger::info("Removed old OTA password from NVS");
     }
 
+    // Config ETags are now derived from the content
+    if (prefs.isKey("cfg_ver")) {
+      prefs.remove("cfg_ver");
+    }
+
     cfg->barkEnabled = prefs.getBool("bark_en", cfg->barkEnabled);
 
     // Load ntfy settings
@@ -96,6 +285,14 @@ namespace saltlevel {
     
     cfg->ntfyEnabled = prefs.getBool("ntfy_en", cfg->ntfyEnabled);
 
+    char profileTmp[Limits::TANK_PROFILE_LENGTH];
+    size_t profileLen = prefs.getString("tank_prof", profileTmp, sizeof(profileTmp));
+    if (profileLen > 0) {
+      profileTmp[sizeof(profileTmp) - 1] = '\0';
+      strncpy(cfg->tankProfile, profileTmp, sizeof(cfg->tankProfile));
+      cfg->tankProfile[sizeof(cfg->tankProfile) - 1] = '\0';
+    }
+
     uint8_t lang = prefs.getUChar("lang", static_cast<uint8_t>(cfg->language));
     if (lang > 1) lang = 0;
     cfg->language = static_cast<Language>(lang);
@@ -109,10 +306,31 @@ namespace saltlevel {
     if (!cfg) return;
 
     prefs.begin("saltcfg", false);
-    prefs.putFloat("full_cm",  cfg->fullDistanceCm);
-    prefs.putFloat("empty_cm", cfg->emptyDistanceCm);
-    prefs.putFloat("warn_cm",  cfg->warnDistanceCm);
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      const TankConfig& tank = cfg->tanks[i];
+      TankKeys keys(i);
+      prefs.putFloat(keys.full,  tank.fullDistanceCm);
+      prefs.putFloat(keys.empty, tank.emptyDistanceCm);
+      prefs.putFloat(keys.warn,  tank.warnDistanceCm);
+      prefs.putChar(keys.trig, tank.trigPin);
+      prefs.putChar(keys.echo, tank.echoPin);
+      prefs.putString(keys.name, String(tank.name));
+    }
     prefs.putUChar("consec_hrs", cfg->consecutiveHoursThreshold);
+    prefs.putUChar("fc_days", cfg->forecastAlertDays);
+    prefs.putUShort("cache_age", cfg->statusMaxAgeS);
+    prefs.putUShort("int_min", cfg->measureMinIntervalS);
+    prefs.putUShort("int_max", cfg->measureMaxIntervalS);
+    prefs.putUChar("flt_type", cfg->levelFilter);
+    prefs.putFloat("flt_q", cfg->filterProcessNoiseCm);
+    prefs.putFloat("flt_r", cfg->filterMeasurementNoiseCm);
+    prefs.putFloat("flt_gate", cfg->filterGateSigma);
+    prefs.putUChar("flt_win", cfg->filterWindow);
+    prefs.putUChar("tank_shape", cfg->tankShape);
+    prefs.putFloat("tank_d1", cfg->tankDim1Cm);
+    prefs.putFloat("tank_d2", cfg->tankDim2Cm);
+    prefs.putFloat("salt_dens", cfg->saltDensityKgPerL);
+    prefs.putString("tank_prof", String(cfg->tankProfile));
     prefs.putString("bark_key", String(cfg->barkKey));
     prefs.putBool("bark_en", cfg->barkEnabled);
     prefs.putString("ntfy_topic", String(cfg->ntfyTopic));
@@ -123,138 +341,222 @@ namespace saltlevel {
     Logger::info("Configuration saved to NVS");
   }
 
-  // -------------------------------------------------------------------------
-  // Translations
-  // -------------------------------------------------------------------------
-  static void applyTranslations(String& page, Language lang) {
-    if (lang == Language::FRENCH) {
-      // French
-      page.replace("{{STR_TITLE}}",       "Surveillance du niveau de sel");
-      page.replace("{{STR_H1}}",          "Surveillance du niveau de sel");
-      page.replace("{{STR_OTA}}",         "Mise à jour OTA");
-      page.replace("{{STR_TANK_SETTINGS}}", "Réglages du réservoir");
-      page.replace("{{STR_NOTIFICATIONS}}", "Notifications");
-      page.replace("{{STR_LANG}}",        "Langue de l'interface :");
-      page.replace("{{STR_FULL}}",        "Distance minimale lorsque le réservoir est PLEIN (limite matérielle, cm) :");
-      page.replace("{{STR_EMPTY}}",       "Distance lorsque le réservoir est VIDE (profondeur max, cm) :");
-      page.replace("{{STR_WARN}}",        "Distance d'avertissement (cm) :");
-      page.replace("{{STR_CONSEC_HOURS}}", "Heures consécutives avant notification :");
-      page.replace("{{STR_CONSEC_HOURS_HELP}}", "Nombre d'heures consécutives de niveau bas avant d'envoyer une alerte (1-48)");
-      
-      // Bark strings
-      page.replace("{{STR_BARK_KEY}}",    "Clé Bark (iOS) :");
-      page.replace("{{STR_BARK_ENABLE}}", "Activer les notifications Bark");
-      page.replace("{{STR_BARK_PLACEHOLDER}}", "Optionnel - pour iOS uniquement");
-      page.replace("{{STR_BARK_TOOLTIP_TITLE}}", "Configuration Bark (iOS)");
-      page.replace("{{STR_BARK_STEP1}}",  "Installez l'app Bark depuis l'App Store");
-      page.replace("{{STR_BARK_STEP2}}",  "Ouvrez Bark et copiez votre clé d'appareil");
-      page.replace("{{STR_BARK_STEP3}}",  "Collez la clé ci-dessous et activez les notifications");
-      
-      // ntfy strings
-      page.replace("{{STR_NTFY_TOPIC}}",   "Sujet ntfy (Android/Multi-plateforme) :");
-      page.replace("{{STR_NTFY_ENABLE}}",  "Activer les notifications ntfy");
-      page.replace("{{STR_NTFY_HELP}}",    "Sujet unique généré automatiquement - utilisez-le pour vous abonner");
-      page.replace("{{STR_NTFY_TOOLTIP_TITLE}}", "Configuration ntfy (Android)");
-      page.replace("{{STR_NTFY_STEP1}}",   "Installez l'app 'ntfy' depuis Google Play");
-      page.replace("{{STR_NTFY_STEP2}}",   "Appuyez sur '+' pour vous abonner à un sujet");
-      page.replace("{{STR_NTFY_STEP3}}",   "Entrez le sujet affiché ci-dessous");
-      page.replace("{{STR_NTFY_STEP4}}",   "Ou visitez : https://ntfy.sh/[votre-sujet]");
-      
-      page.replace("{{STR_OTA_PASSWORD}}", "Mot de passe OTA :");
-      page.replace("{{STR_SAVE}}",        "Enregistrer les réglages");
-      page.replace("{{STR_CURRENT}}",     "Niveau actuel");
-      page.replace("{{STR_MEASURE}}",     "Mesurer maintenant");
-      page.replace("{{STR_DISTANCE}}",    "Distance :");
-      page.replace("{{STR_LEVEL}}",       "Remplissage :");
-      page.replace("{{STR_TOGGLE_THEME}}", "Changer le thème");
-    } else {
-      // English
-      page.replace("{{STR_TITLE}}",       "Salt Level Monitor");
-      page.replace("{{STR_H1}}",          "Salt Level Monitor");
-      page.replace("{{STR_OTA}}",         "OTA Update");
-      page.replace("{{STR_TANK_SETTINGS}}", "Tank Settings");
-      page.replace("{{STR_NOTIFICATIONS}}", "Notifications");
-      page.replace("{{STR_LANG}}",        "UI language:");
-      page.replace("{{STR_FULL}}",        "Minimum distance when tank is FULL (hardware limit, cm):");
-      page.replace("{{STR_EMPTY}}",       "Distance when tank is EMPTY (max depth, cm):");
-      page.replace("{{STR_WARN}}",        "Warning distance (cm):");
-      page.replace("{{STR_CONSEC_HOURS}}", "Consecutive hours before notification:");
-      page.replace("{{STR_CONSEC_HOURS_HELP}}", "Number of consecutive hours at low level before sending an alert (1-48)");
-      
-      // Bark strings
-      page.replace("{{STR_BARK_KEY}}",    "Bark key (iOS):");
-      page.replace("{{STR_BARK_ENABLE}}", "Enable Bark notifications");
-      page.replace("{{STR_BARK_PLACEHOLDER}}", "Optional - iOS only");
-      page.replace("{{STR_BARK_TOOLTIP_TITLE}}", "Bark Setup (iOS)");
-      page.replace("{{STR_BARK_STEP1}}",  "Install Bark app from the App Store");
-      page.replace("{{STR_BARK_STEP2}}",  "Open Bark and copy your device key");
-      page.replace("{{STR_BARK_STEP3}}",  "Paste the key below and enable notifications");
-      
-      // ntfy strings
-      page.replace("{{STR_NTFY_TOPIC}}",   "ntfy topic (Android/Multi-platform):");
-      page.replace("{{STR_NTFY_ENABLE}}",  "Enable ntfy notifications");
-      page.replace("{{STR_NTFY_HELP}}",    "Auto-generated unique topic - use this to subscribe");
-      page.replace("{{STR_NTFY_TOOLTIP_TITLE}}", "ntfy Setup (Android)");
-      page.replace("{{STR_NTFY_STEP1}}",   "Install 'ntfy' app from Google Play Store");
-      page.replace("{{STR_NTFY_STEP2}}",   "Tap '+' to subscribe to a topic");
-      page.replace("{{STR_NTFY_STEP3}}",   "Enter the topic shown below");
-      page.replace("{{STR_NTFY_STEP4}}",   "Or visit: https://ntfy.sh/[your-topic]");
-      
-      page.replace("{{STR_OTA_PASSWORD}}", "OTA password:");
-      page.replace("{{STR_SAVE}}",        "Save settings");
-      page.replace("{{STR_CURRENT}}",     "Current Level");
-      page.replace("{{STR_MEASURE}}",     "Measure now");
-      page.replace("{{STR_DISTANCE}}",    "Distance:");
-      page.replace("{{STR_LEVEL}}",       "Level:");
-      page.replace("{{STR_TOGGLE_THEME}}", "Toggle theme");
-    }
-
-    if (lang == Language::FRENCH) {
-      page.replace("{{LANG_EN_SELECTED}}", "");
-      page.replace("{{LANG_FR_SELECTED}}", "selected");
-    } else {
-      page.replace("{{LANG_EN_SELECTED}}", "selected");
-      page.replace("{{LANG_FR_SELECTED}}", "");
+  // Form/API names of the tank shapes, indexed by TankShape
+  static const char* const TANK_SHAPE_NAMES[] = { "rect", "vcyl", "hcyl", "cone", "profile" };
+
+  // Rebuild the shared distance-to-level models after the config changed.
+  // The shape settings describe the first tank; the others are linear.
+  // Main loop only (setup, applyPendingConfig): tankSetModel() publishes
+  // through a single-writer snapshot.
+  static void rebuildTankModels() {
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      const TankConfig& tank = cfg->tanks[i];
+      if (tank.trigPin < 0) {
+        // No sensor: replace whatever model the tank had (converts to -1)
+        tankSetModel(i, TankModel());
+        continue;
+      }
+
+      TankGeometry geometry = {};
+      geometry.shape             = i == 0 ? static_cast<TankShape>(cfg->tankShape)
+                                          : TankShape::RECTANGULAR;
+      geometry.fullCm            = tank.fullDistanceCm;
+      geometry.emptyCm           = tank.emptyDistanceCm;
+      geometry.saltDensityKgPerL = cfg->saltDensityKgPerL;
+      if (i == 0) {
+        geometry.dim1Cm = cfg->tankDim1Cm;
+        geometry.dim2Cm = cfg->tankDim2Cm;
+        int points = parseTankProfile(cfg->tankProfile, geometry.profile, Tank::MAX_PROFILE_POINTS);
+        geometry.profilePoints = points > 0 ? static_cast<uint8_t>(points) : 0;
+      }
+
+      TankModel model;
+      if (!model.build(geometry)) {
+        Logger::errorf("Tank %u model invalid (shape %s, %.1f-%.1f cm)", i,
+                       TANK_SHAPE_NAMES[static_cast<uint8_t>(geometry.shape)],
+                       tank.fullDistanceCm, tank.emptyDistanceCm);
+      }
+      tankSetModel(i, model);
+    }
+  }
+
+  // Apply a validated /config update; runs on the main loop
+  static void applyPendingConfig() {
+    xSemaphoreTake(configMutex, portMAX_DELAY);
+    if (!configPending) {
+      xSemaphoreGive(configMutex);
+      return;
+    }
+
+    // Sensors are created at boot, so new pins need a restart
+    bool pinsChanged = false;
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      pinsChanged |= cfg->tanks[i].trigPin != pendingConfig.tanks[i].trigPin ||
+                     cfg->tanks[i].echoPin != pendingConfig.tanks[i].echoPin;
+    }
+    *cfg = pendingConfig;
+    configPending = false;
+    xSemaphoreGive(configMutex);
+
+    saveConfigToNvs();
+    rebuildTankModels();
+
+    Logger::infof("Configuration updated: Tank %.1f-%.1f cm, Warn %.1f cm, Bark %s, ntfy %s",
+                 cfg->tanks[0].fullDistanceCm, cfg->tanks[0].emptyDistanceCm,
+                 cfg->tanks[0].warnDistanceCm,
+                 cfg->barkEnabled ? "ON" : "OFF",
+                 cfg->ntfyEnabled ? "ON" : "OFF");
+
+    if (pinsChanged) {
+      Logger::info("Sensor pins changed, rebooting in 2 seconds...");
+      restartAtMs = millis() + 2000;
     }
   }
 
   // -------------------------------------------------------------------------
   // Validation
   // -------------------------------------------------------------------------
+  // GPIOs a sensor may use: 0-39 less UART0 (1, 3, the serial console), the
+  // SPI flash (6-11) and the numbers the ESP32 does not have (20, 24, 28-31).
+  // Trig drives the sensor, so it also cannot be an input-only GPIO (34-39).
+  static const uint64_t SENSOR_PINS = ((1ULL << 40) - 1) &
+      ~((1ULL << 1) | (1ULL << 3) | (0x3FULL << 6) | (1ULL << 20) | (1ULL << 24) | (0xFULL << 28));
+  static const uint64_t TRIG_PINS = SENSOR_PINS & ((1ULL << 34) - 1);
+
+  static bool pinIn(uint64_t mask, int pin) {
+    return pin >= 0 && pin < 64 && ((mask >> pin) & 1);
+  }
+
   bool OTA::validateConfig(const Config* config) {
     if (!config) {
       Logger::error("Validation: config is null");
       return false;
     }
 
-    if (config->fullDistanceCm < 10.0f || config->fullDistanceCm > 100.0f) {
-      Logger::errorf("Validation failed: full distance %.1f out of range [10-100]",
-                    config->fullDistanceCm);
+    if (config->tanks[0].trigPin < 0 || config->tanks[0].echoPin < 0) {
+      Logger::error("Validation failed: the first tank must have a sensor");
       return false;
     }
 
-    if (config->emptyDistanceCm <= config->fullDistanceCm) {
-      Logger::errorf("Validation failed: empty distance %.1f must be > full distance %.1f",
-                    config->emptyDistanceCm, config->fullDistanceCm);
+    // The boot button (and the temperature probe) are taken
+    uint64_t pinsUsed = 1ULL << Pins::RESET_BTN;
+#if TEMP_PROBE_ENABLED
+    pinsUsed |= 1ULL << Pins::TEMP_PROBE;
+#endif
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      const TankConfig& tank = config->tanks[i];
+      if (tank.trigPin < 0 && tank.echoPin < 0) {
+        continue;
+      }
+
+      if (!pinIn(TRIG_PINS, tank.trigPin) || !pinIn(SENSOR_PINS, tank.echoPin) ||
+          tank.trigPin == tank.echoPin ||
+          (pinsUsed & ((1ULL << tank.trigPin) | (1ULL << tank.echoPin)))) {
+        Logger::errorf("Validation failed: tank %u pins %d/%d invalid or already used",
+                      i, tank.trigPin, tank.echoPin);
+        return false;
+      }
+      pinsUsed |= (1ULL << tank.trigPin) | (1ULL << tank.echoPin);
+
+      if (tank.fullDistanceCm < 10.0f || tank.fullDistanceCm > 100.0f) {
+        Logger::errorf("Validation failed: tank %u full distance %.1f out of range [10-100]",
+                      i, tank.fullDistanceCm);
+        return false;
+      }
+
+      if (tank.emptyDistanceCm <= tank.fullDistanceCm) {
+        Logger::errorf("Validation failed: tank %u empty distance %.1f must be > full distance %.1f",
+                      i, tank.emptyDistanceCm, tank.fullDistanceCm);
+        return false;
+      }
+
+      if (tank.emptyDistanceCm > 200.0f) {
+        Logger::errorf("Validation failed: tank %u empty distance %.1f too large",
+                      i, tank.emptyDistanceCm);
+        return false;
+      }
+
+      if (tank.warnDistanceCm < tank.fullDistanceCm ||
+          tank.warnDistanceCm > tank.emptyDistanceCm) {
+        Logger::errorf("Validation failed: tank %u warn distance %.1f not in range [%.1f-%.1f]",
+                      i, tank.warnDistanceCm, tank.fullDistanceCm, tank.emptyDistanceCm);
+        return false;
+      }
+    }
+
+    if (config->consecutiveHoursThreshold < 1 || config->consecutiveHoursThreshold > 48) {
+      Logger::errorf("Validation failed: consecutive hours %u not in range [1-48]",
+                    config->consecutiveHoursThreshold);
       return false;
     }
 
-    if (config->emptyDistanceCm > 200.0f) {
-      Logger::errorf("Validation failed: empty distance %.1f too large", 
-                    config->emptyDistanceCm);
+    if (config->forecastAlertDays > 60) {
+      Logger::errorf("Validation failed: forecast alert days %u not in range [0-60]",
+                    config->forecastAlertDays);
       return false;
     }
 
-    if (config->warnDistanceCm < config->fullDistanceCm || 
-        config->warnDistanceCm > config->emptyDistanceCm) {
-      Logger::errorf("Validation failed: warn distance %.1f not in range [%.1f-%.1f]",
-                    config->warnDistanceCm, config->fullDistanceCm, config->emptyDistanceCm);
+    if (config->statusMaxAgeS > 3600) {
+      Logger::errorf("Validation failed: cache max age %u not in range [0-3600]",
+                    config->statusMaxAgeS);
       return false;
     }
 
-    if (config->consecutiveHoursThreshold < 1 || config->consecutiveHoursThreshold > 48) {
-      Logger::errorf("Validation failed: consecutive hours %u not in range [1-48]",
-                    config->consecutiveHoursThreshold);
+    if (config->measureMinIntervalS < 10 ||
+        config->measureMaxIntervalS < config->measureMinIntervalS ||
+        config->measureMaxIntervalS > 3600) {
+      Logger::errorf("Validation failed: measurement interval %u-%u s not within [10-3600]",
+                    config->measureMinIntervalS, config->measureMaxIntervalS);
+      return false;
+    }
+
+    if (config->levelFilter > 2) {
+      Logger::errorf("Validation failed: level filter %u unknown", config->levelFilter);
+      return false;
+    }
+
+    if (config->filterProcessNoiseCm < 0.01f || config->filterProcessNoiseCm > 10.0f ||
+        config->filterMeasurementNoiseCm < 0.1f || config->filterMeasurementNoiseCm > 20.0f) {
+      Logger::errorf("Validation failed: filter noise %.2f/%.2f cm out of range",
+                    config->filterProcessNoiseCm, config->filterMeasurementNoiseCm);
+      return false;
+    }
+
+    if (config->filterGateSigma < 1.0f || config->filterGateSigma > 10.0f) {
+      Logger::errorf("Validation failed: filter gate %.1f not in range [1-10]",
+                    config->filterGateSigma);
+      return false;
+    }
+
+    if (config->filterWindow < 3 || config->filterWindow > Filter::MAX_WINDOW) {
+      Logger::errorf("Validation failed: filter window %u not in range [3-%u]",
+                    config->filterWindow, Filter::MAX_WINDOW);
+      return false;
+    }
+
+    if (config->tankShape > static_cast<uint8_t>(TankShape::PROFILE)) {
+      Logger::errorf("Validation failed: tank shape %u unknown", config->tankShape);
+      return false;
+    }
+
+    if (config->tankDim1Cm < 0.0f || config->tankDim1Cm > Tank::MAX_DIMENSION_CM ||
+        config->tankDim2Cm < 0.0f || config->tankDim2Cm > Tank::MAX_DIMENSION_CM) {
+      Logger::errorf("Validation failed: tank dimensions %.1f/%.1f cm out of range [0-%.0f]",
+                    config->tankDim1Cm, config->tankDim2Cm, Tank::MAX_DIMENSION_CM);
+      return false;
+    }
+
+    if (config->saltDensityKgPerL < 0.1f || config->saltDensityKgPerL > 3.0f) {
+      Logger::errorf("Validation failed: salt density %.2f kg/L not in range [0.1-3]",
+                    config->saltDensityKgPerL);
+      return false;
+    }
+
+    TankProfilePoint profile[Tank::MAX_PROFILE_POINTS];
+    if (config->tankShape == static_cast<uint8_t>(TankShape::PROFILE) &&
+        parseTankProfile(config->tankProfile, profile, Tank::MAX_PROFILE_POINTS) < 2) {
+      Logger::errorf("Validation failed: tank profile \"%s\" needs 2-%d height:area pairs",
+                    config->tankProfile, Tank::MAX_PROFILE_POINTS);
       return false;
     }
 
@@ -265,299 +567,1298 @@ namespace saltlevel {
   // -------------------------------------------------------------------------
   // Route Handlers
   // -------------------------------------------------------------------------
-  static void handleRoot() {
-    String page = String(HTML_CONTENT);
-
-    String buildTime = String(__DATE__) + " " + String(__TIME__);
-    page.replace("{{BUILD_TIME}}", buildTime);
-
-    if (cfg) {
-      page.replace("{{FULL_CM}}",  String(cfg->fullDistanceCm, 1));
-      page.replace("{{EMPTY_CM}}", String(cfg->emptyDistanceCm, 1));
-      page.replace("{{WARN_CM}}",  String(cfg->warnDistanceCm, 1));
-      page.replace("{{CONSEC_HOURS}}", String(cfg->consecutiveHoursThreshold));
-      page.replace("{{BARK_KEY}}", String(cfg->barkKey));
-      page.replace("{{BARK_EN_CHECKED}}", cfg->barkEnabled ? "checked" : "");
-      page.replace("{{NTFY_TOPIC}}", String(cfg->ntfyTopic));
-      page.replace("{{NTFY_EN_CHECKED}}", cfg->ntfyEnabled ? "checked" : "");
-      applyTranslations(page, cfg->language);
-    } else {
-      page.replace("{{FULL_CM}}",  String(Sensor::DEFAULT_FULL_DISTANCE_CM, 1));
-      page.replace("{{EMPTY_CM}}", String(Sensor::DEFAULT_EMPTY_DISTANCE_CM, 1));
-      page.replace("{{WARN_CM}}",  String(Sensor::DEFAULT_WARN_DISTANCE_CM, 1));
-      page.replace("{{CONSEC_HOURS}}", String(Notification::CONSECUTIVE_LOW_THRESHOLD));
-      page.replace("{{BARK_KEY}}", "");
-      page.replace("{{BARK_EN_CHECKED}}", "");
-      page.replace("{{NTFY_TOPIC}}", "");
-      page.replace("{{NTFY_EN_CHECKED}}", "");
-      applyTranslations(page, Language::ENGLISH);
-    }
-
-    server.sendHeader("Connection", "close");
-    server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-    server.sendHeader("Pragma", "no-cache");
-    server.sendHeader("Expires", "0");
-    server.sendHeader("ETag", String(millis()));
-    server.send(200, "text/html", page);
-  }
-
-  static void handleConfig() {
+#ifdef WEB_UI_STREAMED
+  // Placeholder lookup for the streaming renderer; ctx points to a Language
+  static const char* lookupTranslation(const char* key, size_t keyLen, void* ctx) {
+    if (strncmp("ASSET_VERSION", key, keyLen) == 0 && keyLen == 13) {
+      return staticAssetVersion();
+    }
+
+    Language lang = *static_cast<Language*>(ctx);
+    for (size_t i = 0; i < sizeof(TRANSLATIONS) / sizeof(TRANSLATIONS[0]); i++) {
+      const Translation& t = TRANSLATIONS[i];
+      if (strncmp(t.key, key, keyLen) == 0 && t.key[keyLen] == '\0') {
+        return lang == Language::FRENCH ? t.fr : t.en;
+      }
+    }
+    return nullptr;
+  }
+
+  static void handleRoot(AsyncWebServerRequest* request) {
+    // Render the template from flash straight into the TCP send buffer using
+    // chunked transfer encoding - no copy of the page is ever held in RAM
+    static Language languages[] = { Language::ENGLISH, Language::FRENCH };
+    Language* lang = &languages[cfg && cfg->language == Language::FRENCH ? 1 : 0];
+
+    // The page only depends on the firmware and the UI language
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%08x-%s\"", static_cast<unsigned>(buildId),
+             *lang == Language::FRENCH ? "fr" : "en");
+    if (handleConditional(request, etag, 0)) {
+      return;
+    }
+
+    TemplateRenderer renderer(HTML_CONTENT, strlen_P(HTML_CONTENT), lookupTranslation, lang);
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/html",
+      [renderer](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+        (void)index;
+        return renderer.read(reinterpret_cast<char*>(buffer), maxLen);
+      });
+    addCacheHeaders(response, etag, 0);
+    request->send(response);
+  }
+#else
+  static void handleRoot(AsyncWebServerRequest* request) {
+    // Pre-rendered, gzipped page per language (see scripts/build_web.py)
+    bool french = cfg && cfg->language == Language::FRENCH;
+    const uint8_t* page = french ? WEB_UI_FR_GZ : WEB_UI_EN_GZ;
+    size_t len          = french ? WEB_UI_FR_GZ_LEN : WEB_UI_EN_GZ_LEN;
+
+    // The page only depends on the firmware and the UI language
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%08x-%s\"", static_cast<unsigned>(buildId),
+             french ? "fr" : "en");
+    if (handleConditional(request, etag, 0)) {
+      return;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "text/html", page, len);
+    response->addHeader("Content-Encoding", "gzip");
+    addCacheHeaders(response, etag, 0);
+    request->send(response);
+  }
+#endif
+
+  // Bundled CSS/JS: URLs carry the content hash, so they can be cached forever.
+  // A page from an older firmware still asks for its own ?v=; that URL gets
+  // today's content, so it is only marked for revalidation (If-None-Match,
+  // see ConnectionGuard) rather than cached for a year.
+  static void handleStaticAsset(AsyncWebServerRequest* request) {
+    const StaticAsset* asset = findStaticAsset(request->url().c_str());
+    if (!asset) {
+      request->send(404, "text/plain", "Not found");
+      return;
+    }
+
+    bool current = request->hasArg("v") && request->arg("v") == staticAssetVersion();
+    unsigned long maxAgeS = current ? Timing::STATIC_ASSET_MAX_AGE_S : 0;
+
+    char etag[16];
+    snprintf(etag, sizeof(etag), "\"%s\"", staticAssetVersion());
+    if (handleConditional(request, etag, maxAgeS)) {
+      return;
+    }
+
+    AsyncWebServerResponse* response =
+      request->beginResponse_P(200, asset->contentType, asset->data, asset->length);
+    if (asset->gzipped) {
+      response->addHeader("Content-Encoding", "gzip");
+    }
+    addCacheHeaders(response, etag, maxAgeS);
+    request->send(response);
+  }
+
+  // A pin form field: -1 if empty, otherwise the GPIO number, or one that
+  // validateConfig() rejects if the text is not a number from 0 to 39
+  static int8_t parsePin(const String& value) {
+    if (!value.length()) {
+      return -1;
+    }
+    char* end;
+    long pin = strtol(value.c_str(), &end, 10);
+    return (*end == '\0' && pin >= 0 && pin <= 39) ? static_cast<int8_t>(pin) : INT8_MAX;
+  }
+
+  static void handleConfig(AsyncWebServerRequest* request) {
     if (!cfg) {
-      server.send(500, "text/plain", "No config bound");
+      request->send(500, "text/plain", "No config bound");
       Logger::error("Config POST failed: no config bound");
       return;
     }
 
     Logger::info("Processing configuration update...");
 
-    if (server.hasArg("full_cm")) {
-      cfg->fullDistanceCm = server.arg("full_cm").toFloat();
-    }
-    if (server.hasArg("empty_cm")) {
-      cfg->emptyDistanceCm = server.arg("empty_cm").toFloat();
-    }
-    if (server.hasArg("warn_cm")) {
-      cfg->warnDistanceCm = server.arg("warn_cm").toFloat();
+    // Work on a copy, on top of an update the main loop has not applied yet
+    Config updated;
+    xSemaphoreTake(configMutex, portMAX_DELAY);
+    updated = configPending ? pendingConfig : *cfg;
+    xSemaphoreGive(configMutex);
+
+    // Tank 0 keeps the field names from before there were several tanks
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      TankConfig& tank = updated.tanks[i];
+      char arg[16];
+
+      snprintf(arg, sizeof(arg), i == 0 ? "full_cm" : "t%u_full", i);
+      if (request->hasArg(arg)) {
+        tank.fullDistanceCm = request->arg(arg).toFloat();
+      }
+      snprintf(arg, sizeof(arg), i == 0 ? "empty_cm" : "t%u_empty", i);
+      if (request->hasArg(arg)) {
+        tank.emptyDistanceCm = request->arg(arg).toFloat();
+      }
+      snprintf(arg, sizeof(arg), i == 0 ? "warn_cm" : "t%u_warn", i);
+      if (request->hasArg(arg)) {
+        tank.warnDistanceCm = request->arg(arg).toFloat();
+      }
+
+      // An empty pin field removes the tank's sensor
+      snprintf(arg, sizeof(arg), "t%u_trig", i);
+      if (request->hasArg(arg)) {
+        tank.trigPin = parsePin(request->arg(arg));
+      }
+      snprintf(arg, sizeof(arg), "t%u_echo", i);
+      if (request->hasArg(arg)) {
+        tank.echoPin = parsePin(request->arg(arg));
+      }
+      snprintf(arg, sizeof(arg), "t%u_name", i);
+      if (request->hasArg(arg)) {
+        String name = request->arg(arg);
+        name.trim();
+        name.toCharArray(tank.name, sizeof(tank.name));
+        tank.name[sizeof(tank.name) - 1] = '\0';
+      }
     }
-    if (server.hasArg("consec_hours")) {
-      int hours = server.arg("consec_hours").toInt();
+    if (request->hasArg("consec_hours")) {
+      int hours = request->arg("consec_hours").toInt();
       // Clamp to valid range [1-48]
       if (hours < 1) hours = 1;
       if (hours > 48) hours = 48;
-      cfg->consecutiveHoursThreshold = static_cast<uint8_t>(hours);
+      updated.consecutiveHoursThreshold = static_cast<uint8_t>(hours);
     }
-    if (server.hasArg("bark_key")) {
-      String key = server.arg("bark_key");
+    if (request->hasArg("forecast_days")) {
+      int days = request->arg("forecast_days").toInt();
+      // Clamp to valid range [0-60]
+      if (days < 0) days = 0;
+      if (days > 60) days = 60;
+      updated.forecastAlertDays = static_cast<uint8_t>(days);
+    }
+    if (request->hasArg("cache_age")) {
+      int age = request->arg("cache_age").toInt();
+      // Clamp to valid range [0-3600]
+      if (age < 0) age = 0;
+      if (age > 3600) age = 3600;
+      updated.statusMaxAgeS = static_cast<uint16_t>(age);
+    }
+    if (request->hasArg("interval_min")) {
+      int seconds = request->arg("interval_min").toInt();
+      // Clamp to valid range [10-3600]
+      if (seconds < 10) seconds = 10;
+      if (seconds > 3600) seconds = 3600;
+      updated.measureMinIntervalS = static_cast<uint16_t>(seconds);
+    }
+    if (request->hasArg("interval_max")) {
+      int seconds = request->arg("interval_max").toInt();
+      // Clamp to valid range [10-3600]
+      if (seconds < 10) seconds = 10;
+      if (seconds > 3600) seconds = 3600;
+      updated.measureMaxIntervalS = static_cast<uint16_t>(seconds);
+    }
+    if (request->hasArg("filter")) {
+      String f = request->arg("filter");
+      updated.levelFilter = (f == "kalman") ? 1 : (f == "hampel") ? 2 : 0;
+    }
+    if (request->hasArg("filter_q")) {
+      updated.filterProcessNoiseCm = request->arg("filter_q").toFloat();
+    }
+    if (request->hasArg("filter_r")) {
+      updated.filterMeasurementNoiseCm = request->arg("filter_r").toFloat();
+    }
+    if (request->hasArg("filter_gate")) {
+      updated.filterGateSigma = request->arg("filter_gate").toFloat();
+    }
+    if (request->hasArg("filter_window")) {
+      int window = request->arg("filter_window").toInt();
+      // Clamp to valid range [3-MAX_WINDOW]
+      if (window < 3) window = 3;
+      if (window > Filter::MAX_WINDOW) window = Filter::MAX_WINDOW;
+      updated.filterWindow = static_cast<uint8_t>(window);
+    }
+    if (request->hasArg("tank_shape")) {
+      String shape = request->arg("tank_shape");
+      for (uint8_t i = 0; i < sizeof(TANK_SHAPE_NAMES) / sizeof(TANK_SHAPE_NAMES[0]); i++) {
+        if (shape == TANK_SHAPE_NAMES[i]) {
+          updated.tankShape = i;
+        }
+      }
+    }
+    if (request->hasArg("tank_d1")) {
+      updated.tankDim1Cm = request->arg("tank_d1").toFloat();
+    }
+    if (request->hasArg("tank_d2")) {
+      updated.tankDim2Cm = request->arg("tank_d2").toFloat();
+    }
+    if (request->hasArg("salt_density")) {
+      updated.saltDensityKgPerL = request->arg("salt_density").toFloat();
+    }
+    if (request->hasArg("tank_profile")) {
+      String profile = request->arg("tank_profile");
+      profile.trim();
+      profile.toCharArray(updated.tankProfile, sizeof(updated.tankProfile));
+      updated.tankProfile[sizeof(updated.tankProfile) - 1] = '\0';
+    }
+    if (request->hasArg("bark_key")) {
+      String key = request->arg("bark_key");
       key.trim();
-      key.toCharArray(cfg->barkKey, sizeof(cfg->barkKey));
-      cfg->barkKey[sizeof(cfg->barkKey) - 1] = '\0';
+      key.toCharArray(updated.barkKey, sizeof(updated.barkKey));
+      updated.barkKey[sizeof(updated.barkKey) - 1] = '\0';
     }
     
-    cfg->barkEnabled = server.hasArg("bark_en");
+    updated.barkEnabled = request->hasArg("bark_en");
     
-    if (server.hasArg("ntfy_topic")) {
-      String topic = server.arg("ntfy_topic");
+    if (request->hasArg("ntfy_topic")) {
+      String topic = request->arg("ntfy_topic");
       topic.trim();
-      topic.toCharArray(cfg->ntfyTopic, sizeof(cfg->ntfyTopic));
-      cfg->ntfyTopic[sizeof(cfg->ntfyTopic) - 1] = '\0';
+      topic.toCharArray(updated.ntfyTopic, sizeof(updated.ntfyTopic));
+      updated.ntfyTopic[sizeof(updated.ntfyTopic) - 1] = '\0';
     }
     
-    cfg->ntfyEnabled = server.hasArg("ntfy_en");
+    updated.ntfyEnabled = request->hasArg("ntfy_en");
 
-    if (server.hasArg("lang")) {
-      String l = server.arg("lang");
+    if (request->hasArg("lang")) {
+      String l = request->arg("lang");
       l.toLowerCase();
-      cfg->language = (l == "fr") ? Language::FRENCH : Language::ENGLISH;
+      updated.language = (l == "fr") ? Language::FRENCH : Language::ENGLISH;
     }
 
-    if (!OTA::validateConfig(cfg)) {
-      server.send(400, "text/plain", "Invalid configuration - check serial logs");
+    // Rejected values never reach the live config
+    if (!OTA::validateConfig(&updated)) {
+      request->send(400, "text/plain", "Invalid configuration - check serial logs");
       return;
     }
 
-    saveConfigToNvs();
+    xSemaphoreTake(configMutex, portMAX_DELAY);
+    pendingConfig = updated;
+    configPending = true;
+    xSemaphoreGive(configMutex);
 
-    Logger::infof("Configuration updated: Tank %.1f-%.1f cm, Warn %.1f cm, Bark %s, ntfy %s",
-                 cfg->fullDistanceCm, cfg->emptyDistanceCm, cfg->warnDistanceCm,
-                 cfg->barkEnabled ? "ON" : "OFF",
-                 cfg->ntfyEnabled ? "ON" : "OFF");
+    AsyncWebServerResponse* response = request->beginResponse(303);
+    response->addHeader("Location", "/");
+    request->send(response);
+  }
 
-    server.sendHeader("Location", "/");
-    server.send(303);
+  static void writeMeasureJson(JsonWriter& w, const MeasurementSample& sample) {
+    float d = sample.distanceCm;
+    TankLevel level;
+    tankLevel(sample.tank, d, level);
+    w.beginObject()
+       .field("tank", sample.tank)
+       .field("distance", d, 2)
+       .field("percent", level.percent, 1)
+       .field("age_ms", measurementAgeMs(sample))
+     .endObject();
   }
 
-  static void handleMeasure() {
-    if (!distanceCb) {
-      server.send(500, "application/json", "{\"error\":\"no_callback\"}");
-      Logger::error("Measure failed: no distance callback");
+  static void writeStatusJson(JsonWriter& w, const MeasurementSample& sample) {
+    char uptime[24];
+    formatUptime(uptime, sizeof(uptime));
+
+    float d = sample.distanceCm;
+    TankLevel level;
+    tankLevel(sample.tank, d, level);
+
+    xSemaphoreTake(configMutex, portMAX_DELAY);
+    const TankConfig& tank = cfg->tanks[sample.tank];
+    w.beginObject()
+       .field("tank", sample.tank)
+       .field("name", tank.name)
+       .field("distance", d, 2)
+       .field("percent", level.percent, 1)
+       .field("age_ms", measurementAgeMs(sample))
+       .field("full_cm", tank.fullDistanceCm, 2)
+       .field("empty_cm", tank.emptyDistanceCm, 2)
+       .field("warn_cm", tank.warnDistanceCm, 2)
+       .field("bark_enabled", cfg->barkEnabled)
+       .field("ntfy_enabled", cfg->ntfyEnabled)
+       .field("ntfy_topic", cfg->ntfyTopic)
+       .field("language", cfg->language == Language::FRENCH ? "fr" : "en")
+       .field("wifi_rssi", static_cast<int>(WiFi.RSSI()))
+       .field("uptime_seconds", getUptimeSeconds())
+       .field("uptime", uptime)
+       .field("interval_s", static_cast<unsigned long>(measurementIntervalMs(sample.tank) / 1000));
+    xSemaphoreGive(configMutex);
+
+    // Volume and salt mass, null until the tank dimensions are set
+    if (level.liters >= 0.0f) {
+      w.field("volume_l", level.liters, 1)
+       .field("salt_kg", level.saltKg, 1);
+    } else {
+      w.key("volume_l").nullValue()
+       .key("salt_kg").nullValue();
+    }
+
+    // Air temperature behind the speed of sound, null when none is current
+    TemperatureReading temperature;
+    if (temperatureCurrent(temperature)) {
+      w.field("temperature_c", temperature.celsius, 1)
+       .field("temperature_source", temperatureSourceName(temperature.source));
+    } else {
+      w.key("temperature_c").nullValue()
+       .field("temperature_source", temperatureSourceName(TemperatureSource::NONE));
+    }
+
+    // Consumption forecast (first tank only), null until enough history
+    // since the last refill
+    ForecastState f;
+    if (sample.tank == 0 && forecastState.read(f) && f.valid) {
+      w.field("consumption_cm_per_day", f.rateCmPerDay, 3);
+      if (f.daysUntilEmpty >= 0.0f) {
+        w.field("days_until_empty", f.daysUntilEmpty, 1)
+         .field("empty_at", static_cast<unsigned long>(f.emptyAt));
+      } else {
+        w.key("days_until_empty").nullValue()
+         .key("empty_at").nullValue();
+      }
+    } else {
+      w.key("consumption_cm_per_day").nullValue()
+       .key("days_until_empty").nullValue()
+       .key("empty_at").nullValue();
+    }
+    w.endObject();
+  }
+
+  // -------------------------------------------------------------------------
+  // Pooled response bodies
+  //
+  // The server sends a body after the handler has returned, so a document
+  // built on the handler's stack has to be kept until the response object
+  // is destroyed. It is copied into a fixed slot, released by the
+  // response's destructor, instead of a heap String per response. Slots
+  // are only touched on the AsyncTCP task.
+  // -------------------------------------------------------------------------
+  struct JsonSlot {
+    bool   inUse;
+    size_t length;
+    char   json[Limits::JSON_SLOT_LENGTH];
+  };
+
+  static JsonSlot jsonSlots[Network::HTTP_JSON_SLOTS];
+
+  class PooledJsonResponse : public AsyncProgmemResponse {
+    public:
+      explicit PooledJsonResponse(JsonSlot* slot)
+        : AsyncProgmemResponse(200, "application/json",
+                               reinterpret_cast<const uint8_t*>(slot->json), slot->length),
+          slot(slot) {}
+      ~PooledJsonResponse() override { slot->inUse = false; }
+
+    private:
+      JsonSlot* slot;
+  };
+
+  // Send a finished document, or a 500 instead of a truncated body. With an
+  // etag the response is marked revalidate-only (see handleConditional).
+  static void sendJson(AsyncWebServerRequest* request, const JsonWriter& w,
+                       const char* etag = nullptr) {
+    if (!w.ok()) {
+      Logger::errorf("JSON response for %s does not fit its buffer", request->url().c_str());
+      request->send(500, "application/json", "{\"error\":\"response_too_large\"}");
       return;
     }
 
-    float d = distanceCb();
-    Logger::debugf("Measure endpoint called: %.2f cm", d);
+    JsonSlot* slot = nullptr;
+    for (size_t i = 0; i < Network::HTTP_JSON_SLOTS && w.length() <= sizeof(slot->json); i++) {
+      if (!jsonSlots[i].inUse) {
+        slot = &jsonSlots[i];
+        break;
+      }
+    }
 
-    if (publishCb) {
-      publishCb(d);
+    AsyncWebServerResponse* response;
+    if (slot) {
+      memcpy(slot->json, w.c_str(), w.length());
+      slot->length = w.length();
+      slot->inUse  = true;
+      response = new PooledJsonResponse(slot);
+    } else {
+      // Every slot is out: fall back to a heap copy rather than refusing
+      Logger::debugf("JSON slots busy, copying %s response", request->url().c_str());
+      response = request->beginResponse(200, "application/json", w.c_str());
     }
+    if (etag) {
+      addCacheHeaders(response, etag, 0);
+    }
+    request->send(response);
+  }
+
+  // A /measure or /api/status response waiting for a burst. The chunked
+  // filler returns RESPONSE_TRY_AGAIN until the sample arrives, so the
+  // server keeps serving other clients in the meantime. Held in a fixed
+  // pool (the JSON is too big to capture in the filler).
+  struct PendingMeasurement {
+    bool          inUse;
+    uint32_t      after;       // Served by the first sample with a higher sequence
+    unsigned long startMs;
+    uint8_t       tank;
+    bool          status;      // /api/status layout rather than /measure
+    bool          ready;
+    size_t        length;
+    char          json[Limits::JSON_BUFFER_LENGTH];
+  };
 
-    float percent = -1.0f;
-    if (cfg && cfg->emptyDistanceCm != cfg->fullDistanceCm) {
-      float full  = cfg->fullDistanceCm;
-      float empty = cfg->emptyDistanceCm;
-      percent = (empty - d) / (empty - full) * 100.0f;
-      if (percent < 0)   percent = 0;
-      if (percent > 100) percent = 100;
+  static size_t fillPendingMeasurement(PendingMeasurement& pending, uint8_t* buffer,
+                                       size_t maxLen, size_t index) {
+    if (!pending.ready) {
+      MeasurementSample sample;
+      bool arrived = measurementLatest(sample, pending.tank) && sample.sequence > pending.after;
+      if (!arrived && millis() - pending.startMs < Timing::MEASURE_WAIT_TIMEOUT_MS) {
+        return RESPONSE_TRY_AGAIN;
+      }
+
+      if (arrived) {
+        Logger::debugf("Fresh measurement served: %.2f cm", sample.distanceCm);
+        if (!pending.status && !sample.scheduled) {
+          // Publish from the main loop - the MQTT client is not thread-safe
+          publishDistance = sample.distanceCm;
+          publishTank     = sample.tank;
+          publishPending  = true;
+        }
+      } else {
+        Logger::warn("Timed out waiting for measurement");
+        sample.distanceCm  = -1.0f;
+        sample.timestampMs = millis();
+        sample.tank        = pending.tank;
+      }
+
+      JsonWriter w(pending.json, sizeof(pending.json));
+      if (!arrived && !pending.status) {
+        w.beginObject().field("error", "measurement_timeout").endObject();
+      } else if (pending.status) {
+        writeStatusJson(w, sample);
+      } else {
+        writeMeasureJson(w, sample);
+      }
+      if (!w.ok()) {
+        w.reset();
+        w.beginObject().field("error", "response_too_large").endObject();
+      }
+      pending.length = w.length();
+      pending.ready = true;
+    }
+
+    if (index >= pending.length) {
+      return 0;
+    }
+    size_t n = pending.length - index;
+    if (n > maxLen) n = maxLen;
+    memcpy(buffer, pending.json + index, n);
+    return n;
+  }
+
+  static PendingMeasurement pendingMeasurements[Network::HTTP_PENDING_MEASUREMENTS];
+
+  class PendingMeasurementResponse : public AsyncChunkedResponse {
+    public:
+      explicit PendingMeasurementResponse(PendingMeasurement* pending)
+        : AsyncChunkedResponse("application/json",
+            [pending](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+              return fillPendingMeasurement(*pending, buffer, maxLen, index);
+            }),
+          pending(pending) {}
+      ~PendingMeasurementResponse() override { pending->inUse = false; }
+
+    private:
+      PendingMeasurement* pending;
+  };
+
+  // Serve the snapshot while it is younger than the configured max age,
+  // otherwise ask for a new burst and answer once it lands. Concurrent
+  // requests share a single burst in the measurement task; with ?fresh=1
+  // only a burst started after the request will do.
+  // ?tank=N selects the tank (default: the first).
+  static void respondWithSample(AsyncWebServerRequest* request, bool status) {
+    bool fresh = request->hasArg("fresh") && request->arg("fresh") == "1";
+    unsigned long maxAgeMs = static_cast<unsigned long>(cfg->statusMaxAgeS) * 1000UL;
+
+    long tank = request->hasArg("tank") ? request->arg("tank").toInt() : 0;
+    if (tank < 0 || tank >= Tank::MAX_TANKS || !measurementHasTank(static_cast<uint8_t>(tank))) {
+      request->send(404, "application/json", "{\"error\":\"unknown_tank\"}");
+      return;
+    }
+
+    MeasurementSample sample;
+    bool have = measurementLatest(sample, static_cast<uint8_t>(tank));
+    if (!fresh && have && measurementAgeMs(sample) <= maxAgeMs) {
+      char json[Limits::JSON_BUFFER_LENGTH];
+      JsonWriter w(json, sizeof(json));
+      if (status) {
+        writeStatusJson(w, sample);
+      } else {
+        writeMeasureJson(w, sample);
+      }
+      sendJson(request, w);
+      return;
+    }
+
+    PendingMeasurement* pending = nullptr;
+    for (size_t i = 0; i < Network::HTTP_PENDING_MEASUREMENTS; i++) {
+      if (!pendingMeasurements[i].inUse) {
+        pending = &pendingMeasurements[i];
+        break;
+      }
+    }
+    if (!pending) {
+      request->send(503, "application/json", "{\"error\":\"busy\"}");
+      return;
+    }
+
+    pending->inUse   = true;
+    pending->after   = fresh ? measurementLastStarted(static_cast<uint8_t>(tank))
+                             : (have ? sample.sequence : 0);
+    pending->startMs = millis();
+    pending->tank    = static_cast<uint8_t>(tank);
+    pending->status  = status;
+    pending->ready   = false;
+    pending->length  = 0;
+    measurementRequest(pending->tank, fresh);
+
+    request->send(new PendingMeasurementResponse(pending));
+  }
+
+  static void handleMeasure(AsyncWebServerRequest* request) {
+    if (!cfg) {
+      request->send(500, "application/json", "{\"error\":\"no_config\"}");
+      Logger::error("Measure failed: no config bound");
+      return;
+    }
+    respondWithSample(request, false);
+  }
+
+  static void handleApiStatus(AsyncWebServerRequest* request) {
+    if (!cfg) {
+      request->send(500, "application/json", "{\"error\":\"no_config\"}");
+      return;
+    }
+    respondWithSample(request, true);
+  }
+
+  // Air temperature pushed by another system (POST /api/temperature, value=C)
+  static void handleApiTemperature(AsyncWebServerRequest* request) {
+    if (!request->hasArg("value")) {
+      request->send(400, "application/json", "{\"error\":\"missing_value\"}");
+      return;
+    }
+    if (!temperaturePush(request->arg("value").toFloat())) {
+      request->send(400, "application/json", "{\"error\":\"out_of_range\"}");
+      return;
+    }
+    request->send(204);
+  }
+
+  // Delivery state of the low-salt alerts: per-channel counters, the alerts
+  // still queued in the notifier task, and the cost of the HTTPS connections
+  static void handleApiNotifications(AsyncWebServerRequest* request) {
+    NotifierStatus status;
+    notifierStatus(status);
+    uint32_t now = millis();
+
+    char json[Limits::NOTIFY_JSON_LENGTH];
+    JsonWriter w(json, sizeof(json));
+    w.beginObject()
+       .field("wifi_wait", status.wifiWait)
+       .key("channels").beginObject();
+    for (uint8_t c = 0; c < NOTIFY_CHANNEL_COUNT; c++) {
+      const NotifyChannelStatus& ch = status.channels[c];
+      w.key(c == static_cast<uint8_t>(NotifyChannel::BARK) ? "bark" : "ntfy").beginObject()
+         .field("attempts", ch.attempts)
+         .field("sent", ch.sent)
+         .field("failed", ch.failed);
+      if (ch.lastAttemptMs != 0) {
+        w.field("last_ok", ch.lastOk)
+         .field("last_attempt_age_s", static_cast<unsigned long>((now - ch.lastAttemptMs) / 1000));
+      } else {
+        w.key("last_ok").nullValue()
+         .key("last_attempt_age_s").nullValue();
+      }
+      w.endObject();
+    }
+    w.endObject();
+
+    w.key("queue").beginArray();
+    for (uint8_t i = 0; i < status.queued; i++) {
+      const NotifyJobStatus& job = status.jobs[i];
+      w.beginObject()
+         .field("tank", job.tank);
+      if (job.queuedAt != 0) {
+        w.field("queued_at", static_cast<unsigned long>(job.queuedAt));
+      } else {
+        w.key("queued_at").nullValue();
+      }
+      for (uint8_t c = 0; c < NOTIFY_CHANNEL_COUNT; c++) {
+        uint8_t bit = 1u << c;
+        const char* state = (job.delivered & bit) ? "delivered"
+                          : (job.pending & bit)   ? "pending"
+                          : job.attempts[c]       ? "failed" : "off";
+        w.key(c == static_cast<uint8_t>(NotifyChannel::BARK) ? "bark" : "ntfy").beginObject()
+           .field("state", state)
+           .field("attempts", job.attempts[c])
+           .field("retry_in_s", static_cast<unsigned long>(job.retryInMs[c] / 1000))
+         .endObject();
+      }
+      w.endObject();
+    }
+    w.endArray();
+
+    w.key("https").beginArray();
+    for (size_t i = 0; i < httpsClientCount(); i++) {
+      const HttpsClient* client = httpsClientAt(i);
+      HttpsStats stats;
+      if (!client->stats(stats)) {
+        continue;
+      }
+      w.beginObject()
+         .field("name", client->name())
+         .field("host", client->host())
+         .field("verified", stats.verified)
+         .field("connected", stats.connected)
+         .field("requests", stats.requests)
+         .field("reused", stats.reused)
+         .field("handshakes", stats.handshakes)
+         .field("failures", stats.failures)
+         .field("handshake_ms", stats.lastHandshakeMs)
+         .field("handshake_max_ms", stats.maxHandshakeMs)
+         .field("request_ms", stats.lastRequestMs)
+         .field("session_heap", stats.sessionHeapBytes)
+         .field("request_heap_low", stats.lowestFreeHeap)
+       .endObject();
+    }
+    w.endArray()
+     .field("min_free_heap", ESP.getMinFreeHeap())
+     .endObject();
+    sendJson(request, w);
+  }
+
+  // Latest reading of every fitted tank, from the snapshots only (no burst)
+  static void handleApiTanks(AsyncWebServerRequest* request) {
+    if (!cfg) {
+      request->send(500, "application/json", "{\"error\":\"no_config\"}");
+      return;
+    }
+
+    char json[Limits::JSON_BUFFER_LENGTH];
+    JsonWriter w(json, sizeof(json));
+    xSemaphoreTake(configMutex, portMAX_DELAY);
+    w.beginObject().key("tanks").beginArray();
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      if (!measurementHasTank(i)) {
+        continue;
+      }
+      w.beginObject()
+         .field("tank", i)
+         .field("name", cfg->tanks[i].name)
+         .field("warn_cm", cfg->tanks[i].warnDistanceCm, 2);
+
+      MeasurementSample sample;
+      if (measurementLatest(sample, i)) {
+        TankLevel level;
+        tankLevel(i, sample.distanceCm, level);
+        w.field("distance", sample.distanceCm, 2)
+         .field("percent", level.percent, 1)
+         .field("age_ms", measurementAgeMs(sample));
+      } else {
+        w.key("distance").nullValue()
+         .key("percent").nullValue()
+         .key("age_ms").nullValue();
+      }
+
+      NotificationState state;
+      w.field("warning_sent", notificationState[i].read(state) && state.warningSent);
+      w.endObject();
     }
+    w.endArray().endObject();
+    xSemaphoreGive(configMutex);
+    sendJson(request, w);
+  }
 
-    char json[128];
-    snprintf(json, sizeof(json),
-             "{\"distance\":%.2f,\"percent\":%.1f}", d, percent);
+  // -------------------------------------------------------------------------
+  // Live event stream (/events, Server-Sent Events)
+  //
+  // Browsers subscribe once and receive "measurement", "notify" and
+  // "health" events as they happen instead of polling /measure.
+  // -------------------------------------------------------------------------
+  static void writeNotifyJson(JsonWriter& w, const NotificationState& state, uint8_t tank) {
+    w.beginObject()
+       .field("tank", tank)
+       .field("warning_sent", state.warningSent)
+       .field("consec_low", state.consecutiveLow)
+       .field("consec_high", state.consecutiveHigh)
+       .field("threshold", cfg ? cfg->consecutiveHoursThreshold : 0)
+     .endObject();
+  }
 
-    server.send(200, "application/json", json);
+  static void writeHealthJson(JsonWriter& w) {
+    w.beginObject()
+       .field("heap_free", ESP.getFreeHeap())
+       .field("heap_min", ESP.getMinFreeHeap())
+       .field("wifi_rssi", static_cast<int>(WiFi.RSSI()))
+       .field("uptime_seconds", getUptimeSeconds())
+       .field("clients", events.count())
+     .endObject();
   }
 
-  static void handleApiStatus() {
-    if (!distanceCb || !cfg) {
-      server.send(500, "application/json", "{\"error\":\"no_config_or_callback\"}");
+  // Bring a newly connected page up to date straight away
+  static void onEventClient(AsyncEventSourceClient* client) {
+    if (events.count() > Network::EVENT_MAX_CLIENTS) {
+      Logger::warn("Too many event stream clients, closing newest");
+      client->close();
       return;
     }
 
-    float d = distanceCb();
-    float percent = -1.0f;
-    if (cfg->emptyDistanceCm != cfg->fullDistanceCm) {
-      float full  = cfg->fullDistanceCm;
-      float empty = cfg->emptyDistanceCm;
-      percent = (empty - d) / (empty - full) * 100.0f;
-      if (percent < 0)   percent = 0;
-      if (percent > 100) percent = 100;
+    char json[Limits::JSON_BUFFER_LENGTH];
+    JsonWriter w(json, sizeof(json));
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      MeasurementSample sample;
+      if (cfg && measurementLatest(sample, i)) {
+        w.reset();
+        writeMeasureJson(w, sample);
+        client->send(json, "measurement", sample.sequence, Timing::EVENT_RETRY_MS);
+      }
+
+      NotificationState state;
+      if (notificationState[i].read(state)) {
+        w.reset();
+        writeNotifyJson(w, state, i);
+        client->send(json, "notify");
+      }
     }
 
+    w.reset();
+    writeHealthJson(w);
+    client->send(json, "health");
+  }
+
+  static void pushEvents() {
     char json[Limits::JSON_BUFFER_LENGTH];
-    snprintf(json, sizeof(json),
-      "{"
-        "\"distance\":%.2f,"
-        "\"percent\":%.1f,"
-        "\"full_cm\":%.2f,"
-        "\"empty_cm\":%.2f,"
-        "\"warn_cm\":%.2f,"
-        "\"bark_enabled\":%s,"
-        "\"ntfy_enabled\":%s,"
-        "\"ntfy_topic\":\"%s\","
-        "\"language\":\"%s\","
-        "\"wifi_rssi\":%d,"
-        "\"uptime_seconds\":%lu,"
-        "\"uptime\":\"%s\""
-      "}",
-      d,
-      percent,
-      cfg->fullDistanceCm,
-      cfg->emptyDistanceCm,
-      cfg->warnDistanceCm,
-      cfg->barkEnabled ? "true" : "false",
-      cfg->ntfyEnabled ? "true" : "false",
-      cfg->ntfyTopic,
-      cfg->language == Language::FRENCH ? "fr" : "en",
-      WiFi.RSSI(),
-      getUptimeSeconds(),
-      getUptimeString().c_str()
-    );
-
-    server.send(200, "application/json", json);
-  }
-
-  static void handleApiConfig() {
+    JsonWriter w(json, sizeof(json));
+
+    for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+      MeasurementSample sample;
+      if (measurementLatest(sample, i) && sample.sequence != lastEventSequence[i]) {
+        lastEventSequence[i] = sample.sequence;
+        if (cfg && events.count() > 0) {
+          w.reset();
+          writeMeasureJson(w, sample);
+          events.send(json, "measurement", sample.sequence);
+        }
+      }
+    }
+
+    unsigned long now = millis();
+    if (now - lastHealthEventMs >= Timing::EVENT_HEALTH_INTERVAL_MS) {
+      lastHealthEventMs = now;
+      if (events.count() > 0) {
+        w.reset();
+        writeHealthJson(w);
+        events.send(json, "health");
+      }
+    }
+  }
+
+  // History and events are recorded for the first tank only. Answer any
+  // other ?tank with an error rather than the first tank's data.
+  static bool rejectOtherTanks(AsyncWebServerRequest* request) {
+    if (!request->hasArg("tank") || request->arg("tank") == "0") {
+      return false;
+    }
+    request->send(400, "application/json", "{\"error\":\"first_tank_only\"}");
+    return true;
+  }
+
+  // -------------------------------------------------------------------------
+  // Measurement history (/api/history?from=&to=&step=)
+  //
+  // Streamed as {"from":..,"to":..,"step":..,"tier":..,"points":[...]} with
+  // a chunked response: the filler pulls a few records at a time from the
+  // store, so the response size is independent of the range requested.
+  //
+  // When step is at least an hour the store's coarsest suitable rollup tier
+  // is used and each point is [start,mean_cm,min_cm,max_cm,count,sd_cm];
+  // raw points are [ts,cm]. Either way p[1] is the level to plot.
+  //
+  // With points=N the raw readings are instead reduced to about N [ts,cm]
+  // points by streaming LTTB (see lttb.h), which keeps refill spikes that
+  // averaging would flatten; step is ignored then.
+  // -------------------------------------------------------------------------
+  struct HistoryCursor {
+    enum Stage : uint8_t { HEADER, POINTS, FOOTER, DONE };
+
+    uint32_t      from;        // Next timestamp to fetch from the store
+    uint32_t      skip;        // Raw records at from already sent
+    uint32_t      to;
+    uint32_t      step;        // Minimum spacing between points, 0 = all
+    uint32_t      nextEmit;    // Earliest timestamp for the next point
+    HistoryTier   tier;
+    uint16_t      maxPoints;   // LTTB target, 0 = off
+    bool          lttbFinished;
+    Stage         stage;
+    bool          first;
+    bool          exhausted;   // The store has nothing after the batch
+    union {
+      HistoryRecord records[16];
+      RollupBucket  buckets[8];
+    } batch;
+    size_t        batchLen;
+    size_t        batchPos;
+    char          text[96];    // Formatted output not yet sent (header is the longest)
+    size_t        textLen;
+    size_t        textPos;
+    LttbDownsampler lttb;
+  };
+
+  static const char* tierName(HistoryTier tier) {
+    switch (tier) {
+      case HistoryTier::HOUR: return "hour";
+      case HistoryTier::DAY:  return "day";
+      case HistoryTier::WEEK: return "week";
+      default:                return "raw";
+    }
+  }
+
+  // Refill cursor.batch from the store (raw records or rollup buckets)
+  static void fetchHistoryBatch(HistoryCursor& c) {
+    c.batchPos = 0;
+    if (c.tier == HistoryTier::RAW) {
+      HistoryPosition pos(c.from);
+      pos.skip = c.skip;
+      c.batchLen = history->read(pos, c.to, c.batch.records, 16);
+      c.exhausted = c.batchLen < 16;
+      c.from = pos.from;
+      c.skip = pos.skip;
+    } else {
+      c.batchLen = history->readRollup(c.tier, c.from, c.to, c.batch.buckets, 8);
+      c.exhausted = c.batchLen < 8;
+      if (c.batchLen > 0) {
+        c.from = c.batch.buckets[c.batchLen - 1].start + HistoryStore::tierWidth(c.tier);
+      }
+    }
+  }
+
+  // Format the next piece of the document into cursor.text; false when done
+  static bool nextHistoryText(HistoryCursor& c) {
+    c.textLen = 0;
+    c.textPos = 0;
+
+    while (c.stage == HistoryCursor::POINTS) {
+      LttbPoint selected;
+      if (c.maxPoints > 0 && c.lttb.pop(selected)) {
+        size_t offset = 0;
+        if (!c.first) {
+          c.text[offset++] = ',';
+        }
+        c.first = false;
+
+        JsonWriter w(c.text + offset, sizeof(c.text) - offset);
+        w.beginArray()
+         .value(static_cast<unsigned long>(selected.timestamp))
+         .value(selected.value, 1)
+         .endArray();
+        c.textLen = offset + w.length();
+        return true;
+      }
+
+      if (c.batchPos == c.batchLen) {
+        if (c.exhausted) {
+          if (c.maxPoints > 0 && !c.lttbFinished) {
+            c.lttb.finish();
+            c.lttbFinished = true;
+            continue;
+          }
+          c.stage = HistoryCursor::FOOTER;
+          break;
+        }
+        fetchHistoryBatch(c);
+        continue;
+      }
+
+      size_t pos = c.batchPos++;
+      if (c.maxPoints > 0) {
+        const HistoryRecord& rec = c.batch.records[pos];
+        if (rec.distanceMm >= 0) {
+          c.lttb.add(rec.timestamp, rec.distanceMm / 10.0f);
+        }
+        continue;
+      }
+
+      uint32_t timestamp = c.tier == HistoryTier::RAW ? c.batch.records[pos].timestamp
+                                                      : c.batch.buckets[pos].start;
+      if (timestamp < c.nextEmit) {
+        continue;
+      }
+      // Saturate: past the end of time nothing else is due
+      c.nextEmit = c.step > 0xFFFFFFFFUL - timestamp ? 0xFFFFFFFFUL : timestamp + c.step;
+
+      size_t offset = 0;
+      if (!c.first) {
+        c.text[offset++] = ',';
+      }
+      c.first = false;
+
+      JsonWriter w(c.text + offset, sizeof(c.text) - offset);
+      w.beginArray().value(static_cast<unsigned long>(timestamp));
+      if (c.tier == HistoryTier::RAW) {
+        const HistoryRecord& rec = c.batch.records[pos];
+        if (rec.distanceMm < 0) {
+          w.nullValue();
+        } else {
+          w.value(rec.distanceMm / 10.0f, 1);
+        }
+      } else {
+        const RollupBucket& b = c.batch.buckets[pos];
+        w.value(b.meanMm / 10.0f, 1)
+         .value(b.minMm / 10.0f, 1)
+         .value(b.maxMm / 10.0f, 1)
+         .value(static_cast<unsigned>(b.count))
+         .value(b.stddevMm() / 10.0f, 1);
+      }
+      w.endArray();
+      c.textLen = offset + w.length();
+      return true;
+    }
+
+    if (c.stage == HistoryCursor::HEADER) {
+      // Left open on purpose: the points array follows
+      JsonWriter w(c.text, sizeof(c.text));
+      w.beginObject()
+         .field("from", static_cast<unsigned long>(c.from))
+         .field("to", static_cast<unsigned long>(c.to))
+         .field("step", static_cast<unsigned long>(c.step))
+         .field("tier", c.maxPoints > 0 ? "lttb" : tierName(c.tier))
+         .key("points").beginArray();
+      c.textLen = w.length();
+      c.stage = HistoryCursor::POINTS;
+      return true;
+    }
+
+    if (c.stage == HistoryCursor::FOOTER) {
+      memcpy(c.text, "]}", 2);
+      c.textLen = 2;
+      c.stage = HistoryCursor::DONE;
+      return true;
+    }
+
+    return false;
+  }
+
+  static size_t fillHistory(HistoryCursor& c, uint8_t* buffer, size_t maxLen) {
+    size_t out = 0;
+    while (out < maxLen) {
+      if (c.textPos == c.textLen && !nextHistoryText(c)) {
+        break;
+      }
+      size_t n = c.textLen - c.textPos;
+      if (n > maxLen - out) n = maxLen - out;
+      memcpy(buffer + out, c.text + c.textPos, n);
+      c.textPos += n;
+      out += n;
+    }
+    return out;
+  }
+
+  static void handleApiHistory(AsyncWebServerRequest* request) {
+    if (rejectOtherTanks(request)) {
+      return;
+    }
+    if (!history) {
+      request->send(503, "application/json", "{\"error\":\"no_history\"}");
+      return;
+    }
+
+    // Default: the last week up to now (or everything if the clock is unset)
+    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    uint32_t to = now >= Timing::MIN_VALID_EPOCH ? now : 0xFFFFFFFEUL;
+    if (request->hasArg("to")) {
+      to = strtoul(request->arg("to").c_str(), nullptr, 10);
+    }
+    uint32_t from = to > History::DEFAULT_RANGE_S ? to - History::DEFAULT_RANGE_S : 0;
+    if (request->hasArg("from")) {
+      from = strtoul(request->arg("from").c_str(), nullptr, 10);
+    }
+    uint32_t step = 0;
+    if (request->hasArg("step")) {
+      step = strtoul(request->arg("step").c_str(), nullptr, 10);
+    }
+
+    if (from > to) {
+      request->send(400, "application/json", "{\"error\":\"from_after_to\"}");
+      return;
+    }
+    // A step wider than the range still gives its first point
+    if (step > to - from) {
+      step = to - from;
+    }
+
+    HistoryCursor cursor;
+    cursor.from      = from;
+    cursor.skip      = 0;
+    cursor.to        = to;
+    cursor.step      = step;
+    cursor.nextEmit  = from;
+    cursor.tier      = history->pickTier(from, step);
+    cursor.maxPoints = 0;
+    cursor.lttbFinished = false;
+    if (request->hasArg("points")) {
+      unsigned long points = strtoul(request->arg("points").c_str(), nullptr, 10);
+      if (points < 3) points = 3;
+      if (points > History::MAX_CHART_POINTS) points = History::MAX_CHART_POINTS;
+      cursor.maxPoints = static_cast<uint16_t>(points);
+      cursor.tier      = HistoryTier::RAW;
+      cursor.step      = 0;
+      cursor.lttb.begin(from, to, points);
+    }
+    cursor.stage     = HistoryCursor::HEADER;
+    cursor.first     = true;
+    cursor.exhausted = false;
+    cursor.batchLen  = 0;
+    cursor.batchPos  = 0;
+    cursor.textLen   = 0;
+    cursor.textPos   = 0;
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+      [cursor](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+        (void)index;
+        return fillHistory(cursor, buffer, maxLen);
+      });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+  }
+
+  // -------------------------------------------------------------------------
+  // Level events (/api/events)
+  //
+  // {"events":[{"timestamp":..,"type":"refill","delta_cm":..,"level_cm":..}]}
+  // oldest first, streamed one event per step like the history.
+  // -------------------------------------------------------------------------
+  struct EventCursor {
+    size_t next;        // Index of the next event in the log
+    bool   started;
+    bool   done;
+    char   text[128];
+    size_t textLen;
+    size_t textPos;
+  };
+
+  static bool nextEventText(EventCursor& c) {
+    c.textPos = 0;
+    if (c.done) {
+      return false;
+    }
+    if (!c.started) {
+      c.started = true;
+      memcpy(c.text, "{\"events\":[", 11);
+      c.textLen = 11;
+      return true;
+    }
+
+    LevelEvent event;
+    if (eventLog->read(c.next, &event, 1) == 0) {
+      memcpy(c.text, "]}", 2);
+      c.textLen = 2;
+      c.done = true;
+      return true;
+    }
+
+    size_t offset = 0;
+    if (c.next > 0) {
+      c.text[offset++] = ',';
+    }
+    c.next++;
+
+    JsonWriter w(c.text + offset, sizeof(c.text) - offset);
+    w.beginObject()
+       .field("timestamp", static_cast<unsigned long>(event.timestamp))
+       .field("type", levelEventName(event.type))
+       .field("delta_cm", event.deltaCm, 1)
+       .field("level_cm", event.levelCm, 1)
+     .endObject();
+    c.textLen = offset + w.length();
+    return true;
+  }
+
+  static void handleApiEvents(AsyncWebServerRequest* request) {
+    if (rejectOtherTanks(request)) {
+      return;
+    }
+    if (!eventLog) {
+      request->send(503, "application/json", "{\"error\":\"no_event_log\"}");
+      return;
+    }
+
+    EventCursor cursor;
+    cursor.next    = 0;
+    cursor.started = false;
+    cursor.done    = false;
+    cursor.textLen = 0;
+    cursor.textPos = 0;
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+      [cursor](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+        (void)index;
+        size_t out = 0;
+        while (out < maxLen) {
+          if (cursor.textPos == cursor.textLen && !nextEventText(cursor)) {
+            break;
+          }
+          size_t n = cursor.textLen - cursor.textPos;
+          if (n > maxLen - out) n = maxLen - out;
+          memcpy(buffer + out, cursor.text + cursor.textPos, n);
+          cursor.textPos += n;
+          out += n;
+        }
+        return out;
+      });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+  }
+
+  static void handleApiConfig(AsyncWebServerRequest* request) {
     if (!cfg) {
-      server.send(500, "application/json", "{\"error\":\"no_config\"}");
+      request->send(500, "application/json", "{\"error\":\"no_config\"}");
       return;
     }
 
-    if (server.method() == HTTP_GET) {
-      char json[Limits::JSON_BUFFER_LENGTH];
-      snprintf(json, sizeof(json),
-        "{"
-        "\"full_cm\":%.2f,"
-        "\"empty_cm\":%.2f,"
-        "\"warn_cm\":%.2f,"
-        "\"bark_enabled\":%s,"
-        "\"ntfy_enabled\":%s,"
-        "\"ntfy_topic\":\"%s\","
-        "\"language\":\"%s\""
-        "}",
-        cfg->fullDistanceCm,
-        cfg->emptyDistanceCm,
-        cfg->warnDistanceCm,
-        cfg->barkEnabled ? "true" : "false",
-        cfg->ntfyEnabled ? "true" : "false",
-        cfg->ntfyTopic,
-        cfg->language == Language::FRENCH ? "fr" : "en"
-      );
-      server.send(200, "application/json", json);
+    if (request->method() == HTTP_GET) {
+      // An update still waiting for the main loop is what the form just saved
+      xSemaphoreTake(configMutex, portMAX_DELAY);
+      const Config& c = configPending ? pendingConfig : *cfg;
+
+      char json[Limits::CONFIG_JSON_LENGTH];
+      JsonWriter w(json, sizeof(json));
+      w.beginObject()
+         .field("full_cm", c.tanks[0].fullDistanceCm, 2)
+         .field("empty_cm", c.tanks[0].emptyDistanceCm, 2)
+         .field("warn_cm", c.tanks[0].warnDistanceCm, 2)
+         .field("consec_hours", c.consecutiveHoursThreshold)
+         .field("forecast_days", c.forecastAlertDays)
+         .field("cache_age", c.statusMaxAgeS)
+         .field("interval_min", c.measureMinIntervalS)
+         .field("interval_max", c.measureMaxIntervalS)
+         .field("filter", c.levelFilter == 1 ? "kalman" : c.levelFilter == 2 ? "hampel" : "none")
+         .field("filter_q", c.filterProcessNoiseCm, 2)
+         .field("filter_r", c.filterMeasurementNoiseCm, 2)
+         .field("filter_gate", c.filterGateSigma, 1)
+         .field("filter_window", c.filterWindow)
+         .field("tank_shape", TANK_SHAPE_NAMES[c.tankShape])
+         .field("tank_d1", c.tankDim1Cm, 1)
+         .field("tank_d2", c.tankDim2Cm, 1)
+         .field("salt_density", c.saltDensityKgPerL, 2)
+         .field("tank_profile", c.tankProfile)
+         .field("bark_key", c.barkKey)
+         .field("bark_enabled", c.barkEnabled)
+         .field("ntfy_enabled", c.ntfyEnabled)
+         .field("ntfy_topic", c.ntfyTopic)
+         .field("language", c.language == Language::FRENCH ? "fr" : "en");
+
+      w.key("tanks").beginArray();
+      for (uint8_t i = 0; i < Tank::MAX_TANKS; i++) {
+        const TankConfig& tank = c.tanks[i];
+        w.beginObject()
+           .field("name", tank.name)
+           .field("trig", tank.trigPin)
+           .field("echo", tank.echoPin)
+           .field("full_cm", tank.fullDistanceCm, 2)
+           .field("empty_cm", tank.emptyDistanceCm, 2)
+           .field("warn_cm", tank.warnDistanceCm, 2)
+         .endObject();
+      }
+      w.endArray();
+
+      // The chart converts history with the same table as the firmware
+      float table[Tank::LUT_POINTS];
+      w.key("level_table");
+      if (tankPercentTable(0, table)) {
+        w.beginArray();
+        for (int i = 0; i < Tank::LUT_POINTS; i++) {
+          w.value(table[i], 1);
+        }
+        w.endArray();
+      } else {
+        w.nullValue();
+      }
+      w.endObject();
+      xSemaphoreGive(configMutex);
+
+      // Hash of the document itself, so no two configs share an ETag (a
+      // counter would start over after a factory reset)
+      char etag[24];
+      snprintf(etag, sizeof(etag), "\"%08x-%08x\"", static_cast<unsigned>(buildId),
+               static_cast<unsigned>(fnv1a(w.c_str(), w.length())));
+      if (w.ok() && handleConditional(request, etag, 0)) {
+        return;
+      }
+      sendJson(request, w, etag);
     } else {
-      server.send(405, "text/plain", "Method not allowed");
+      request->send(405, "text/plain", "Method not allowed");
     }
   }
 
-  static void handleUpdate() {
+  static void handleUpdate(AsyncWebServerRequest* request) {
     if (otaAuthFailed) {
-      server.sendHeader("Connection", "close");
-      server.send(401, "text/plain", "Unauthorized: Invalid password");
+      AsyncWebServerResponse* response =
+        request->beginResponse(401, "text/plain", "Unauthorized: Invalid password");
+      response->addHeader("Connection", "close");
+      request->send(response);
       otaAuthFailed = false;
       Logger::warn("OTA update rejected: invalid password");
       return;
     }
     
     if (!Update.hasError()) {
-      server.sendHeader("Connection", "close");
-      server.send(200, "text/plain", "OK");
-      server.client().flush();
+      AsyncWebServerResponse* response = request->beginResponse(200, "text/plain", "OK");
+      response->addHeader("Connection", "close");
+      request->send(response);
       
+      // Reboot from the main loop once the response has gone out
       Logger::info("OTA update completed, rebooting in 2 seconds...");
-      delay(2000);
-      ESP.restart();
+      restartAtMs = millis() + 2000;
     } else {
-      server.sendHeader("Connection", "close");
-      server.send(500, "text/plain", "FAIL");
+      AsyncWebServerResponse* response = request->beginResponse(500, "text/plain", "FAIL");
+      response->addHeader("Connection", "close");
+      request->send(response);
       Logger::error("OTA update failed");
     }
   }
 
-  static void handleUpdateUpload() {
-    HTTPUpload& upload = server.upload();
-    
-    if (upload.status == UPLOAD_FILE_START) {
-      esp_task_wdt_reset(); 
+  static void handleUpdateUpload(AsyncWebServerRequest* request, const String& filename,
+                                 size_t index, uint8_t* data, size_t len, bool final) {
+    if (index == 0) {
       otaAuthFailed = false;
       
-      if (!server.authenticate("admin", cfg->otaPassword)) {
+      if (!request->authenticate("admin", cfg->otaPassword)) {
         Logger::warn("OTA authentication failed - invalid password");
         otaAuthFailed = true;
         Update.abort();
         return;
       }
       
-      Logger::infof("OTA Update started: %s", upload.filename.c_str());
+      Logger::infof("OTA Update started: %s", filename.c_str());
       
       if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
         Update.printError(Serial);
         Logger::error("OTA begin failed");
       }
-    } 
-    else if (upload.status == UPLOAD_FILE_WRITE) {
-      esp_task_wdt_reset(); 
-      if (!otaAuthFailed && Update.isRunning()) {
-        size_t written = Update.write(upload.buf, upload.currentSize);
-        if (written != upload.currentSize) {
-          Update.printError(Serial);
-          Logger::errorf("OTA write failed: expected %u, wrote %u", 
-                        upload.currentSize, written);
-        }
-      }
-    } 
-    else if (upload.status == UPLOAD_FILE_END) {
-      esp_task_wdt_reset(); 
-      if (!otaAuthFailed && Update.isRunning()) {
-        if (Update.end(true)) {
-          Logger::infof("OTA Update Success: %u bytes", upload.totalSize);
-        } else {
-          Update.printError(Serial);
-          Logger::error("OTA end failed");
-        }
+    }
+
+    if (len > 0 && !otaAuthFailed && Update.isRunning()) {
+      size_t written = Update.write(data, len);
+      if (written != len) {
+        Update.printError(Serial);
+        Logger::errorf("OTA write failed: expected %u, wrote %u", len, written);
       }
     }
-    else if (upload.status == UPLOAD_FILE_ABORTED) {
-      Update.end();
-      Logger::warn("OTA Update aborted");
+
+    if (final && !otaAuthFailed && Update.isRunning()) {
+      if (Update.end(true)) {
+        Logger::infof("OTA Update Success: %u bytes", index + len);
+      } else {
+        Update.printError(Serial);
+        Logger::error("OTA end failed");
+      }
     }
   }
 
   // -------------------------------------------------------------------------
   // Public methods
   // -------------------------------------------------------------------------
-  void OTA::setDistanceCallback(DistanceCallback cb) {
-    distanceCb = cb;
-    Logger::debug("Distance callback registered");
-  }
-
   void OTA::setPublishCallback(PublishCallback cb) {
     publishCb = cb;
     Logger::debug("Publish callback registered");
@@ -568,10 +1869,49 @@ namespace saltlevel {
     Logger::debug("Config pointer registered");
   }
 
+  void OTA::setForecast(const ForecastState& forecast) {
+    forecastState.publish(forecast);
+  }
+
+  void OTA::setEventLog(EventLog* log) {
+    eventLog = log;
+    Logger::debug("Event log registered");
+  }
+
+  void OTA::setHistory(HistoryStore* h) {
+    history = h;
+    Logger::debug("History store registered");
+  }
+
+  void OTA::setNotificationState(const NotificationState& state, uint8_t tank) {
+    if (tank >= Tank::MAX_TANKS) {
+      return;
+    }
+    NotificationState previous;
+    bool changed = !notificationState[tank].read(previous) ||
+                   previous.warningSent     != state.warningSent ||
+                   previous.consecutiveLow  != state.consecutiveLow ||
+                   previous.consecutiveHigh != state.consecutiveHigh;
+    if (!changed) {
+      return;
+    }
+
+    notificationState[tank].publish(state);
+    if (events.count() > 0) {
+      char json[Limits::JSON_BUFFER_LENGTH];
+      JsonWriter w(json, sizeof(json));
+      writeNotifyJson(w, state, tank);
+      events.send(json, "notify");
+    }
+  }
+
   void OTA::setup() {
     Logger::info("Initializing OTA system...");
     
+    buildId = fnv1a(__DATE__ " " __TIME__);
+    configMutex = xSemaphoreCreateMutex();
     loadConfigFromNvs();
+    rebuildTankModels();
 
     if (!MDNS.begin("saltlevel-esp32")) {
       Logger::error("mDNS startup failed");
@@ -580,38 +1920,53 @@ namespace saltlevel {
       MDNS.addService("http", "tcp", 80);
     }
 
+    // Must come first so it sees every request before the routes do
+    server.addHandler(&connectionGuard);
+
     server.on("/", HTTP_GET, handleRoot);
+
+    size_t assetCount = 0;
+    const StaticAsset* assets = staticAssets(assetCount);
+    for (size_t i = 0; i < assetCount; i++) {
+      server.on(assets[i].path, HTTP_GET, handleStaticAsset);
+    }
+
     server.on("/config", HTTP_POST, handleConfig);
     server.on("/measure", HTTP_GET, handleMeasure);
     server.on("/api/status", HTTP_GET, handleApiStatus);
+    server.on("/api/temperature", HTTP_POST, handleApiTemperature);
+    server.on("/api/tanks", HTTP_GET, handleApiTanks);
+    server.on("/api/notifications", HTTP_GET, handleApiNotifications);
     server.on("/api/config", HTTP_GET, handleApiConfig);
+    server.on("/api/history", HTTP_GET, handleApiHistory);
+    server.on("/api/events", HTTP_GET, handleApiEvents);
     server.on("/update", HTTP_POST, handleUpdate, handleUpdateUpload);
+
+    events.onConnect(onEventClient);
+    server.addHandler(&events);
     
-    server.on("/version", HTTP_GET, []() {
-      String buildTime = String(__DATE__) + " " + String(__TIME__);
+    server.on("/version", HTTP_GET, [](AsyncWebServerRequest* request) {
+      char uptime[24];
+      formatUptime(uptime, sizeof(uptime));
+
       char json[256];
-      snprintf(json, sizeof(json),
-        "{"
-          "\"version\":\"2.3.0\","
-          "\"build\":\"%s\","
-          "\"uptime_seconds\":%lu,"
-          "\"uptime\":\"%s\""
-        "}",
-        buildTime.c_str(),
-        getUptimeSeconds(),
-        getUptimeString().c_str()
-      );
-      server.send(200, "application/json", json);
+      JsonWriter w(json, sizeof(json));
+      w.beginObject()
+         .field("version", "2.3.0")
+         .field("build", __DATE__ " " __TIME__)
+         .field("uptime_seconds", getUptimeSeconds())
+         .field("uptime", uptime)
+       .endObject();
+      sendJson(request, w);
     });
     
-    server.on("/debug/html", HTTP_GET, []() {
-      String page = String(HTML_CONTENT);
-      server.send(200, "text/plain", page);
+    server.on("/debug/html", HTTP_GET, [](AsyncWebServerRequest* request) {
+      request->send_P(200, "text/plain", HTML_CONTENT);
     });
 
-    server.onNotFound([]() {
-      Logger::warnf("404 Not Found: %s", server.uri().c_str());
-      server.send(404, "text/plain", "Not found");
+    server.onNotFound([](AsyncWebServerRequest* request) {
+      Logger::warnf("404 Not Found: %s", request->url().c_str());
+      request->send(404, "text/plain", "Not found");
     });
 
     server.begin();
@@ -620,7 +1975,22 @@ namespace saltlevel {
   }
 
   void OTA::loop() {
-    server.handleClient();
+    // Requests are served by the AsyncTCP task; only deferred work runs here
+    if (publishPending.exchange(false) && publishCb) {
+      publishCb(publishTank, publishDistance);
+    }
+
+    applyPendingConfig();
+    pushEvents();
+
+    unsigned long restartAt = restartAtMs;
+    if (restartAt != 0 && static_cast<long>(millis() - restartAt) >= 0) {
+      if (history) {
+        history->flush();
+      }
+      notifierFlush();
+      ESP.restart();
+    }
   }
 
 } // namespace saltlevel
\ No newline at end of file
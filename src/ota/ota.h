@@ -2,6 +2,10 @@
 #define OTA_H
 
 #include <Arduino.h>
+#include "../constants.h"
+
+class HistoryStore;
+class EventLog;
 
 namespace saltlevel {
 
@@ -11,12 +15,36 @@ namespace saltlevel {
     FRENCH = 1
   };
 
-  // Configuration structure
-  struct Config {
+  // One tank and the sensor above it
+  struct TankConfig {
+    char     name[16];            // Shown in the UI and notifications
+    int8_t   trigPin;             // JSN-SR04T pins, -1 if no tank is fitted
+    int8_t   echoPin;             // (pin changes apply after a restart)
     float    fullDistanceCm;      // Tank FULL at this distance (hardware min)
     float    emptyDistanceCm;     // Tank EMPTY at this distance (max depth)
     float    warnDistanceCm;      // Warning distance threshold
+  };
+
+  // Configuration structure
+  struct Config {
+    TankConfig tanks[Tank::MAX_TANKS];  // tanks[0] is always fitted; history,
+                                        // forecast, events, filter and shape
+                                        // apply to it
     uint8_t  consecutiveHoursThreshold;  // Hours of low level before notification
+    uint8_t  forecastAlertDays;   // Alert when predicted empty within this many days (0 = off)
+    uint16_t statusMaxAgeS;       // Max age of a cached sample served by the API
+    uint16_t measureMinIntervalS; // Adaptive schedule: interval while the level moves
+    uint16_t measureMaxIntervalS; // and once it is stable
+    uint8_t  levelFilter;         // Estimator before the alert logic (LevelFilterType)
+    float    filterProcessNoiseCm;      // Kalman: level drift per sqrt(hour)
+    float    filterMeasurementNoiseCm;  // Kalman: reading noise
+    float    filterGateSigma;     // Outlier threshold in sigmas
+    uint8_t  filterWindow;        // Hampel: window length in readings
+    uint8_t  tankShape;           // Geometry behind percent and volume (TankShape)
+    float    tankDim1Cm;          // Shape dimensions, 0 if unknown (see analysis/tank.h)
+    float    tankDim2Cm;
+    float    saltDensityKgPerL;   // Bulk density for the salt mass
+    char     tankProfile[96];     // Profiled tank: "height:area" pairs
     char     barkKey[128];        // Bark device key
     char     otaPassword[64];     // OTA update password
     char     ntfyTopic[64];       // ntfy topic name
@@ -25,18 +53,40 @@ namespace saltlevel {
     bool     ntfyEnabled;         // Runtime ntfy on/off
   };
 
+  // Low-salt alert state, mirrored to the live event stream
+  struct NotificationState {
+    bool    warningSent;
+    uint8_t consecutiveLow;
+    uint8_t consecutiveHigh;
+  };
+
+  // Consumption forecast, mirrored to /api/status
+  struct ForecastState {
+    bool     valid;
+    float    rateCmPerDay;
+    float    daysUntilEmpty;      // -1 when the level is not dropping
+    uint32_t emptyAt;             // Unix time, 0 if unknown
+  };
+
   // Callback types
-  typedef float (*DistanceCallback)();
-  typedef bool  (*PublishCallback)(float);
+  typedef bool  (*PublishCallback)(uint8_t tank, float distanceCm);
 
   class OTA {
     public:
       void setup();
       void loop();
 
-      void setDistanceCallback(DistanceCallback cb);
       void setPublishCallback(PublishCallback cb);
       void setConfig(Config* cfg);
+      void setHistory(HistoryStore* history);
+      void setEventLog(EventLog* log);
+
+      // Alert state of a tank for /api/tanks; tank 0's is also pushed to
+      // live clients when it changes
+      void setNotificationState(const NotificationState& state, uint8_t tank = 0);
+
+      // Latest consumption forecast for /api/status
+      void setForecast(const ForecastState& forecast);
       
       // Validation
       static bool validateConfig(const Config* cfg);
@@ -0,0 +1,75 @@
+#include "renderer.h"
+#include <string.h>
+
+namespace saltlevel {
+
+  TemplateRenderer::TemplateRenderer(const char* tmpl, size_t len,
+                                     PlaceholderLookup lookup, void* ctx)
+    : tmpl(tmpl), len(len), pos(0), lookup(lookup), ctx(ctx), pending(nullptr) {}
+
+  size_t TemplateRenderer::read(char* buf, size_t maxLen) {
+    size_t out = 0;
+
+    while (out < maxLen) {
+      // Finish a replacement that did not fit into the previous buffer
+      if (pending) {
+        while (*pending && out < maxLen) {
+          buf[out++] = *pending++;
+        }
+        if (*pending) {
+          break;
+        }
+        pending = nullptr;
+        continue;
+      }
+
+      if (pos >= len) {
+        break;
+      }
+
+      // Copy literal text up to the next '{'
+      const char* start = tmpl + pos;
+      size_t remaining = len - pos;
+      const char* brace = static_cast<const char*>(memchr(start, '{', remaining));
+      size_t literal = brace ? static_cast<size_t>(brace - start) : remaining;
+
+      if (literal > 0) {
+        size_t n = literal < (maxLen - out) ? literal : (maxLen - out);
+        memcpy(buf + out, start, n);
+        out += n;
+        pos += n;
+        continue;
+      }
+
+      // At a '{': is it a complete {{KEY}} we can replace?
+      const char* value = nullptr;
+      size_t consumed = 0;
+      if (remaining >= 4 && start[1] == '{') {
+        const char* key = start + 2;
+        size_t limit = remaining - 2;
+        if (limit > MAX_KEY_LENGTH + 2) {
+          limit = MAX_KEY_LENGTH + 2;
+        }
+        for (size_t i = 0; i + 1 < limit; i++) {
+          if (key[i] == '}' && key[i + 1] == '}') {
+            value = lookup ? lookup(key, i, ctx) : nullptr;
+            consumed = i + 4;
+            break;
+          }
+        }
+      }
+
+      if (value) {
+        pos += consumed;
+        pending = value;
+      } else {
+        // Not a placeholder (CSS/JS braces) - emit the brace as-is
+        buf[out++] = *start;
+        pos++;
+      }
+    }
+
+    return out;
+  }
+
+}
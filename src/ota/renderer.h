@@ -0,0 +1,41 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <stddef.h>
+
+namespace saltlevel {
+
+  // Returns the replacement for a {{KEY}} placeholder, or nullptr to emit it
+  // unchanged. key is not NUL-terminated.
+  typedef const char* (*PlaceholderLookup)(const char* key, size_t keyLen, void* ctx);
+
+  /**
+   * Streaming {{KEY}} template renderer.
+   *
+   * Walks the template in place (flash is memory-mapped on the ESP32) and
+   * produces output in caller-sized pieces, so serving a page only needs one
+   * small buffer regardless of the page size. No Arduino dependency.
+   */
+  class TemplateRenderer {
+    public:
+      static const size_t MAX_KEY_LENGTH = 32;
+
+      TemplateRenderer(const char* tmpl, size_t len, PlaceholderLookup lookup, void* ctx);
+
+      // Fill buf with up to maxLen bytes; returns 0 once the template is exhausted
+      size_t read(char* buf, size_t maxLen);
+
+      bool done() const { return pos >= len && pending == nullptr; }
+
+    private:
+      const char*       tmpl;
+      size_t            len;
+      size_t            pos;
+      PlaceholderLookup lookup;
+      void*             ctx;
+      const char*       pending;   // Rest of a replacement not yet emitted
+  };
+
+}
+
+#endif // RENDERER_H
@@ -0,0 +1,237 @@
+#ifndef TRANSLATIONS_H
+#define TRANSLATIONS_H
+
+#include <Arduino.h>
+
+// UI strings substituted for the {{KEY}} placeholders in html_content.h.
+// scripts/build_web.py parses this table at build time to pre-render one
+// page per language, so keep every entry as { "KEY", "english", "french" }.
+namespace saltlevel {
+
+  struct Translation {
+    const char* key;
+    const char* en;
+    const char* fr;
+  };
+
+  static const Translation TRANSLATIONS[] = {
+    // Page and tank settings
+    { "STR_TITLE",
+      "Salt Level Monitor",
+      "Surveillance du niveau de sel" },
+    { "STR_H1",
+      "Salt Level Monitor",
+      "Surveillance du niveau de sel" },
+    { "STR_OTA",
+      "OTA Update",
+      "Mise à jour OTA" },
+    { "STR_TANK_SETTINGS",
+      "Tank Settings",
+      "Réglages du réservoir" },
+    { "STR_NOTIFICATIONS",
+      "Notifications",
+      "Notifications" },
+    { "STR_LANG",
+      "UI language:",
+      "Langue de l'interface :" },
+    { "STR_FULL",
+      "Minimum distance when tank is FULL (hardware limit, cm):",
+      "Distance minimale lorsque le réservoir est PLEIN (limite matérielle, cm) :" },
+    { "STR_EMPTY",
+      "Distance when tank is EMPTY (max depth, cm):",
+      "Distance lorsque le réservoir est VIDE (profondeur max, cm) :" },
+    { "STR_WARN",
+      "Warning distance (cm):",
+      "Distance d'avertissement (cm) :" },
+    { "STR_CONSEC_HOURS",
+      "Consecutive hours before notification:",
+      "Heures consécutives avant notification :" },
+    { "STR_CONSEC_HOURS_HELP",
+      "Number of consecutive hours at low level before sending an alert (1-48)",
+      "Nombre d'heures consécutives de niveau bas avant d'envoyer une alerte (1-48)" },
+    { "STR_FORECAST_DAYS",
+      "Alert days before predicted empty:",
+      "Alerte en jours avant la date de vide prévue :" },
+    { "STR_FORECAST_DAYS_HELP",
+      "Also alert when the consumption trend says the tank empties within this many days (0 = off, 0-60)",
+      "Alerter aussi si la tendance de consommation prévoit un réservoir vide d'ici ce nombre de jours (0 = désactivé, 0-60)" },
+    { "STR_CACHE_AGE",
+      "Max age of a cached reading (s):",
+      "Âge max. d'une mesure en cache (s) :" },
+    { "STR_CACHE_AGE_HELP",
+      "The API reuses the last reading while it is younger than this (0-3600)",
+      "L'API réutilise la dernière mesure si elle est plus récente (0-3600)" },
+    { "STR_INTERVAL_MIN",
+      "Measurement interval while the level changes (s):",
+      "Intervalle de mesure quand le niveau change (s) :" },
+    { "STR_INTERVAL_MAX",
+      "Measurement interval when the level is stable (s):",
+      "Intervalle de mesure quand le niveau est stable (s) :" },
+    { "STR_INTERVAL_HELP",
+      "Measures quickly during a refill and backs off to the longer interval once stable (10-3600)",
+      "Mesure rapidement pendant un remplissage puis revient à l'intervalle long une fois stable (10-3600)" },
+    { "STR_FILTER",
+      "Level filter:",
+      "Filtre du niveau :" },
+    { "STR_FILTER_NONE",
+      "None (raw readings)",
+      "Aucun (mesures brutes)" },
+    { "STR_FILTER_HELP",
+      "Smooths readings and rejects splashes before the low-level alert logic",
+      "Lisse les mesures et écarte les éclaboussures avant la logique d'alerte" },
+    { "STR_FILTER_Q",
+      "Kalman: level drift per sqrt(hour) (cm):",
+      "Kalman : dérive du niveau par racine(heure) (cm) :" },
+    { "STR_FILTER_R",
+      "Kalman: reading noise (cm):",
+      "Kalman : bruit de mesure (cm) :" },
+    { "STR_FILTER_GATE",
+      "Outlier threshold (standard deviations):",
+      "Seuil d'aberration (écarts-types) :" },
+    { "STR_FILTER_WINDOW",
+      "Hampel: window (readings, 3-15):",
+      "Hampel : fenêtre (mesures, 3-15) :" },
+    { "STR_TANK_SHAPE",
+      "Tank shape:",
+      "Forme du bac :" },
+    { "STR_TANK_RECT",
+      "Rectangular",
+      "Rectangulaire" },
+    { "STR_TANK_VCYL",
+      "Cylinder (upright)",
+      "Cylindre (vertical)" },
+    { "STR_TANK_HCYL",
+      "Cylinder (lying)",
+      "Cylindre (couché)" },
+    { "STR_TANK_CONE",
+      "Tapered (truncated cone)",
+      "Évasé (tronc de cône)" },
+    { "STR_TANK_PROFILE",
+      "Custom profile",
+      "Profil personnalisé" },
+    { "STR_TANK_SHAPE_HELP",
+      "Converts the distance into percent, liters and kg of salt",
+      "Convertit la distance en pourcentage, litres et kg de sel" },
+    { "STR_TANK_D1",
+      "Width / diameter / bottom diameter (cm):",
+      "Largeur / diamètre / diamètre du bas (cm) :" },
+    { "STR_TANK_D2",
+      "Length / top diameter (cm):",
+      "Longueur / diamètre du haut (cm) :" },
+    { "STR_TANK_DIM_HELP",
+      "Leave at 0 if unknown: the percentage still follows the shape, but no volume is shown",
+      "Laisser à 0 si inconnu : le pourcentage suit la forme, sans volume affiché" },
+    { "STR_TANK_PROFILE_POINTS",
+      "Custom profile (height cm:area cm², ...):",
+      "Profil personnalisé (hauteur cm:surface cm², ...) :" },
+    { "STR_TANK_PROFILE_HELP",
+      "Cross-section at 2-8 heights above the empty level",
+      "Section à 2-8 hauteurs au-dessus du niveau vide" },
+    { "STR_SALT_DENSITY",
+      "Salt bulk density (kg/L):",
+      "Densité apparente du sel (kg/L) :" },
+    { "STR_TANK",
+      "Tank",
+      "Bac" },
+    { "STR_TANK_NAME",
+      "Tank name:",
+      "Nom du bac :" },
+    { "STR_TRIG_PIN",
+      "Sensor TRIG pin (GPIO):",
+      "Broche TRIG du capteur (GPIO) :" },
+    { "STR_ECHO_PIN",
+      "Sensor ECHO pin (GPIO):",
+      "Broche ECHO du capteur (GPIO) :" },
+    { "STR_PINS_HELP",
+      "Changing a pin restarts the device",
+      "Changer une broche redémarre l'appareil" },
+    { "STR_EXTRA_TANK_HELP",
+      "Optional extra sensor: leave the pins empty if not fitted. Shape, filter and forecast apply to the first tank only",
+      "Capteur supplémentaire facultatif : laisser les broches vides s'il n'est pas monté. Forme, filtre et prévision ne concernent que le premier bac" },
+
+    // Bark
+    { "STR_BARK_KEY",
+      "Bark key (iOS):",
+      "Clé Bark (iOS) :" },
+    { "STR_BARK_ENABLE",
+      "Enable Bark notifications",
+      "Activer les notifications Bark" },
+    { "STR_BARK_PLACEHOLDER",
+      "Optional - iOS only",
+      "Optionnel - pour iOS uniquement" },
+    { "STR_BARK_TOOLTIP_TITLE",
+      "Bark Setup (iOS)",
+      "Configuration Bark (iOS)" },
+    { "STR_BARK_STEP1",
+      "Install Bark app from the App Store",
+      "Installez l'app Bark depuis l'App Store" },
+    { "STR_BARK_STEP2",
+      "Open Bark and copy your device key",
+      "Ouvrez Bark et copiez votre clé d'appareil" },
+    { "STR_BARK_STEP3",
+      "Paste the key below and enable notifications",
+      "Collez la clé ci-dessous et activez les notifications" },
+
+    // ntfy
+    { "STR_NTFY_TOPIC",
+      "ntfy topic (Android/Multi-platform):",
+      "Sujet ntfy (Android/Multi-plateforme) :" },
+    { "STR_NTFY_ENABLE",
+      "Enable ntfy notifications",
+      "Activer les notifications ntfy" },
+    { "STR_NTFY_HELP",
+      "Auto-generated unique topic - use this to subscribe",
+      "Sujet unique généré automatiquement - utilisez-le pour vous abonner" },
+    { "STR_NTFY_TOOLTIP_TITLE",
+      "ntfy Setup (Android)",
+      "Configuration ntfy (Android)" },
+    { "STR_NTFY_STEP1",
+      "Install 'ntfy' app from Google Play Store",
+      "Installez l'app 'ntfy' depuis Google Play" },
+    { "STR_NTFY_STEP2",
+      "Tap '+' to subscribe to a topic",
+      "Appuyez sur '+' pour vous abonner à un sujet" },
+    { "STR_NTFY_STEP3",
+      "Enter the topic shown below",
+      "Entrez le sujet affiché ci-dessous" },
+    { "STR_NTFY_STEP4",
+      "Or visit: https://ntfy.sh/[your-topic]",
+      "Ou visitez : https://ntfy.sh/[votre-sujet]" },
+
+    // Level display, OTA and misc
+    { "STR_OTA_PASSWORD",
+      "OTA password:",
+      "Mot de passe OTA :" },
+    { "STR_SAVE",
+      "Save settings",
+      "Enregistrer les réglages" },
+    { "STR_CURRENT",
+      "Current Level",
+      "Niveau actuel" },
+    { "STR_MEASURE",
+      "Measure now",
+      "Mesurer maintenant" },
+    { "STR_DISTANCE",
+      "Distance:",
+      "Distance :" },
+    { "STR_LEVEL",
+      "Level:",
+      "Remplissage :" },
+    { "STR_TOGGLE_THEME",
+      "Toggle theme",
+      "Changer le thème" },
+    { "STR_HISTORY",
+      "Last 7 days",
+      "7 derniers jours" },
+    { "STR_ALERT_SENT",
+      "Low salt alert sent",
+      "Alerte sel bas envoyée" },
+
+    // Language selector
+    { "LANG_EN_SELECTED", "selected", "" },
+    { "LANG_FR_SELECTED", "", "selected" },
+  };
+
+}
+
+#endif // TRANSLATIONS_H
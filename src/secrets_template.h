@@ -36,6 +36,25 @@
 // Usually you don't need to change this:
 #define BARK_SERVER "https://api.day.app"
 
+// Optional: root certificate (PEM) the Bark and ntfy servers must present.
+// Left undefined, the connection is still encrypted but the server is not
+// verified. Use the root of the chain the server sends (openssl s_client -showcerts).
+// #define BARK_CA_CERT \
+//     "-----BEGIN CERTIFICATE-----\n" \
+//     "...\n" \
+//     "-----END CERTIFICATE-----\n"
+// #define NTFY_CA_CERT "-----BEGIN CERTIFICATE-----\n" ...
+
+
+// ============================================================================
+// Temperature probe (optional)
+// ============================================================================
+
+// Set to true if a DS18B20 is wired to GPIO4 (see Pins::TEMP_PROBE). Its reading
+// corrects the speed of sound; without it a temperature can still be pushed
+// over MQTT (<prefix>/temperature/set) or HTTP (POST /api/temperature)
+#define TEMP_PROBE_ENABLED false
+
 
 // ============================================================================
 // OTA Configuration
@@ -0,0 +1,63 @@
+#include "distance.h"
+#include <algorithm>
+#include <cmath>
+#include "../constants.h"
+
+// 331.3 * sqrt(1 + T / 273.15) m/s, in cm/us, every AIR_TEMP_STEP_C from
+// AIR_TEMP_MIN_C (dry air; humidity adds well under 0.5%)
+static const float SOUND_SPEED_TABLE[] = {
+    0.030608f, 0.030935f, 0.031258f, 0.031578f, 0.031894f, 0.032207f, 0.032518f, // -40 C
+    0.032825f, 0.033130f, 0.033432f, 0.033731f, 0.034028f, 0.034321f, 0.034613f, //  -5 C
+    0.034902f, 0.035189f, 0.035473f, 0.035755f, 0.036035f, 0.036313f, 0.036588f, //  30 C
+};
+static constexpr int SOUND_SPEED_STEPS =
+    sizeof(SOUND_SPEED_TABLE) / sizeof(SOUND_SPEED_TABLE[0]) - 1;
+
+static_assert(SOUND_SPEED_STEPS ==
+              static_cast<int>((Sensor::AIR_TEMP_MAX_C - Sensor::AIR_TEMP_MIN_C) / Sensor::AIR_TEMP_STEP_C),
+              "Speed of sound table does not match the temperature range");
+
+float soundSpeedCmPerUs(float temperatureC) {
+    // fmax/fmin clamp without branching and map NaN to the bound
+    float x = (temperatureC - Sensor::AIR_TEMP_MIN_C) / Sensor::AIR_TEMP_STEP_C;
+    x = std::fmin(std::fmax(x, 0.0f), static_cast<float>(SOUND_SPEED_STEPS));
+
+    // The last interval is extrapolated to its end rather than indexed past it
+    int i = std::min(static_cast<int>(x), SOUND_SPEED_STEPS - 1);
+    float frac = x - i;
+    return SOUND_SPEED_TABLE[i] + frac * (SOUND_SPEED_TABLE[i + 1] - SOUND_SPEED_TABLE[i]);
+}
+
+float echoDurationToCm(uint32_t durationUs, float soundSpeed) {
+    // Sound travels to the salt surface and back, so halve the round trip
+    return (durationUs * soundSpeed) / 2.0f;
+}
+
+float medianOfReadings(float* readings, int count) {
+    if (count <= 0) {
+        return -1.0f;
+    }
+
+    std::sort(readings, readings + count);
+    return readings[count / 2];
+}
+
+float medianAbsoluteDeviation(const float* readings, int count) {
+    if (count <= 0 || count > Sensor::MAX_READING_ATTEMPTS) {
+        return -1.0f;
+    }
+
+    float work[Sensor::MAX_READING_ATTEMPTS];
+    std::copy(readings, readings + count, work);
+    float median = medianOfReadings(work, count);
+
+    for (int i = 0; i < count; i++) {
+        work[i] = std::fabs(readings[i] - median);
+    }
+    return medianOfReadings(work, count);
+}
+
+bool burstSettled(const float* readings, int count) {
+    return count >= Sensor::MIN_READINGS &&
+           medianAbsoluteDeviation(readings, count) <= Sensor::MAX_READING_VARIANCE_CM;
+}
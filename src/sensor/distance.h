@@ -0,0 +1,56 @@
+#ifndef SENSOR_DISTANCE_H
+#define SENSOR_DISTANCE_H
+
+// Pure timing-to-distance helpers. Deliberately free of Arduino headers so
+// they can be compiled and exercised in a host build.
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Speed of sound in air at a given temperature, from a precomputed table
+ * (Sensor::AIR_TEMP_MIN_C to AIR_TEMP_MAX_C in AIR_TEMP_STEP_C steps)
+ * interpolated linearly. Branch-free: out-of-range temperatures, NaN
+ * included, clamp to the ends of the table.
+ *
+ * @param temperatureC Air temperature in the tank
+ * @return Speed of sound in cm/us
+ */
+float soundSpeedCmPerUs(float temperatureC);
+
+/**
+ * Convert an echo pulse width into a one-way distance
+ *
+ * @param durationUs Width of the echo pulse in microseconds
+ * @param soundSpeed Speed of sound in cm/us (see soundSpeedCmPerUs())
+ * @return Distance in cm
+ */
+float echoDurationToCm(uint32_t durationUs, float soundSpeed);
+
+/**
+ * Median of a set of readings (sorts the array in place)
+ *
+ * @param readings Array of distances in cm
+ * @param count Number of valid entries in the array
+ * @return Median distance, or -1 if count is 0
+ */
+float medianOfReadings(float* readings, int count);
+
+/**
+ * Median absolute deviation of a set of readings (a robust spread measure)
+ *
+ * @param readings Array of distances in cm (left untouched)
+ * @param count Number of valid entries, at most Sensor::MAX_READING_ATTEMPTS
+ * @return MAD in cm, or -1 if count is 0
+ */
+float medianAbsoluteDeviation(const float* readings, int count);
+
+/**
+ * Whether a burst has enough agreeing readings to stop pinging
+ *
+ * @return true once there are Sensor::MIN_READINGS valid readings whose
+ *         MAD is within Sensor::MAX_READING_VARIANCE_CM
+ */
+bool burstSettled(const float* readings, int count);
+
+#endif // SENSOR_DISTANCE_H
@@ -0,0 +1,140 @@
+#include "echo.h"
+#include "distance.h"
+#include "../logger.h"
+
+EchoSensor::EchoSensor(int trigPin, int echoPin)
+    : trigPin(trigPin), echoPin(echoPin) {}
+
+void EchoSensor::begin() {
+    pinMode(trigPin, OUTPUT);
+    pinMode(echoPin, INPUT);
+    digitalWrite(trigPin, LOW);
+    attachInterruptArg(digitalPinToInterrupt(echoPin), onEchoEdge, this, CHANGE);
+}
+
+// ---------------------------------------------------------------------------
+// ISR: timestamp both edges of the echo pulse
+// ---------------------------------------------------------------------------
+void IRAM_ATTR EchoSensor::onEchoEdge(void* arg) {
+    EchoSensor* self = static_cast<EchoSensor*>(arg);
+    if (!self->armed) {
+        return;
+    }
+
+    uint32_t now = micros();
+    if (digitalRead(self->echoPin) == HIGH) {
+        self->riseUs = now;
+        self->echoStarted = true;
+    } else if (self->echoStarted) {
+        self->fallUs = now;
+        self->echoComplete = true;
+        self->armed = false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Burst state machine
+// ---------------------------------------------------------------------------
+bool EchoSensor::startBurst(BurstCallback cb, void* ctx) {
+    if (state != State::IDLE) {
+        return false;
+    }
+
+    callback = cb;
+    callbackCtx = ctx;
+    pingsDone = 0;
+    validReadings = 0;
+    burstStartMs = millis();
+    triggerPing();
+    return true;
+}
+
+void EchoSensor::triggerPing() {
+    echoStarted = false;
+    echoComplete = false;
+
+    digitalWrite(trigPin, LOW);
+    delayMicroseconds(2);
+
+    // Arm before the trigger so a fast echo cannot slip past the ISR
+    armed = true;
+    digitalWrite(trigPin, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(trigPin, LOW);
+
+    triggerUs = micros();
+    state = State::WAIT_ECHO;
+}
+
+void EchoSensor::poll() {
+    switch (state) {
+        case State::WAIT_ECHO: {
+            if (echoComplete) {
+                finishPing(fallUs - riseUs);
+                break;
+            }
+
+            // Same budget pulseIn() used: time to the rising edge, then pulse width
+            uint32_t since = echoStarted ? riseUs : triggerUs;
+            if (micros() - since > Timing::SENSOR_TIMEOUT_US) {
+                armed = false;
+                finishPing(0);
+            }
+            break;
+        }
+
+        case State::GAP:
+            if (millis() - gapStartMs >= Timing::SENSOR_READING_DELAY_MS) {
+                triggerPing();
+            }
+            break;
+
+        case State::IDLE:
+        default:
+            break;
+    }
+}
+
+void EchoSensor::finishPing(uint32_t durationUs) {
+    pingsDone++;
+
+    if (durationUs > 0) {
+        float distance = echoDurationToCm(durationUs, soundSpeed);
+        readings[validReadings++] = distance;
+        Logger::debugf("Reading %d: %.2f cm", pingsDone, distance);
+    } else {
+        Logger::debug("Reading timeout");
+    }
+
+    // Stop once the readings agree, or when the ping/time budget runs out
+    if (burstSettled(readings, validReadings) ||
+        pingsDone >= Sensor::MAX_READING_ATTEMPTS ||
+        millis() - burstStartMs >= Timing::BURST_TIME_BUDGET_MS) {
+        finishBurst();
+        return;
+    }
+
+    gapStartMs = millis();
+    state = State::GAP;
+}
+
+void EchoSensor::finishBurst() {
+    float result = medianOfReadings(readings, validReadings);
+
+    if (validReadings == 0) {
+        Logger::warn("All sensor readings failed");
+    } else if (validReadings == 1) {
+        Logger::infof("Single valid reading: %.2f cm (%d pings)", result, pingsDone);
+    } else {
+        Logger::infof("Median of %d readings: %.2f cm (%d pings)",
+                      validReadings, result, pingsDone);
+    }
+
+    // Back to idle first so the callback may start the next burst
+    state = State::IDLE;
+    BurstCallback cb = callback;
+    callback = nullptr;
+    if (cb) {
+        cb(result, callbackCtx);
+    }
+}
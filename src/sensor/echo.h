@@ -0,0 +1,73 @@
+#ifndef ECHO_SENSOR_H
+#define ECHO_SENSOR_H
+
+#include <Arduino.h>
+#include "../constants.h"
+#include "level_sensor.h"
+
+/**
+ * Interrupt-driven JSN-SR04T driver.
+ *
+ * Echo edges are timestamped in a GPIO ISR, and a small state machine
+ * advanced from poll() sequences the pings of a burst, so the caller never
+ * busy-waits on the echo pulse the way pulseIn() does.
+ *
+ * Bursts are adaptive: pinging stops as soon as the valid readings agree
+ * (see burstSettled()), so a quiet tank is measured in two pings while a
+ * noisy one gets up to Sensor::MAX_READING_ATTEMPTS within
+ * Timing::BURST_TIME_BUDGET_MS.
+ */
+class EchoSensor : public LevelSensor {
+public:
+    EchoSensor(int trigPin, int echoPin);
+
+    // Configure pins and attach the echo interrupt
+    void begin() override;
+
+    // Start a burst of pings; returns false if one is already in flight
+    bool startBurst(BurstCallback cb, void* ctx) override;
+
+    // Advance the state machine - call frequently from the owning loop/task
+    void poll() override;
+
+    bool isBusy() const override { return state != State::IDLE; }
+
+    // Speed of sound used to convert echoes in cm/us (see soundSpeedCmPerUs())
+    void setSoundSpeed(float cmPerUs) override { soundSpeed = cmPerUs; }
+
+private:
+    enum class State : uint8_t {
+        IDLE,
+        WAIT_ECHO,
+        GAP
+    };
+
+    static void IRAM_ATTR onEchoEdge(void* arg);
+
+    void triggerPing();
+    void finishPing(uint32_t durationUs);
+    void finishBurst();
+
+    int trigPin;
+    int echoPin;
+
+    State         state = State::IDLE;
+    BurstCallback callback = nullptr;
+    void*         callbackCtx = nullptr;
+    uint32_t      triggerUs = 0;
+    unsigned long gapStartMs = 0;
+    unsigned long burstStartMs = 0;
+    int           pingsDone = 0;
+    int           validReadings = 0;
+    float         soundSpeed = Sensor::SOUND_SPEED_CM_PER_US;
+    float         readings[Sensor::MAX_READING_ATTEMPTS];
+
+    // Written from the ISR
+    volatile bool     armed = false;
+    volatile bool     echoStarted = false;
+    volatile bool     echoComplete = false;
+    volatile uint32_t riseUs = 0;
+    volatile uint32_t fallUs = 0;
+};
+
+#endif // ECHO_SENSOR_H
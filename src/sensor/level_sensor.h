@@ -0,0 +1,33 @@
+#ifndef LEVEL_SENSOR_H
+#define LEVEL_SENSOR_H
+
+// Called once per burst with the median distance, or -1 if every ping failed
+typedef void (*BurstCallback)(float distanceCm, void* ctx);
+
+/**
+ * A distance sensor above one tank, as driven by the measurement task.
+ *
+ * A burst is a short series of pings reduced to one distance. It runs as a
+ * state machine advanced by poll(), so the task can own several sensors
+ * and sequence their bursts (see measurement.cpp).
+ */
+class LevelSensor {
+public:
+    virtual ~LevelSensor() {}
+
+    // Configure pins and interrupts
+    virtual void begin() = 0;
+
+    // Start a burst; returns false if one is already in flight
+    virtual bool startBurst(BurstCallback cb, void* ctx) = 0;
+
+    // Advance the state machine - call frequently while isBusy()
+    virtual void poll() = 0;
+
+    virtual bool isBusy() const = 0;
+
+    // Speed of sound in cm/us for the next burst (see soundSpeedCmPerUs())
+    virtual void setSoundSpeed(float cmPerUs) = 0;
+};
+
+#endif // LEVEL_SENSOR_H
@@ -0,0 +1,112 @@
+#include "temperature.h"
+#include "../constants.h"
+#include "../logger.h"
+#include "../measurement/snapshot.h"
+
+#if TEMP_PROBE_ENABLED
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#endif
+
+// Written from the loop task (probe, MQTT) and the async_tcp task (HTTP),
+// so writers take a mutex to keep the snapshot single-writer; readers,
+// the measurement task among them, stay lock-free
+static Snapshot<TemperatureReading> current;
+static SemaphoreHandle_t            writeMutex = nullptr;
+
+static bool store(float celsius, TemperatureSource source) {
+    if (!(celsius >= Sensor::AIR_TEMP_MIN_C && celsius <= Sensor::AIR_TEMP_MAX_C)) {
+        Logger::warnf("Temperature %.1f C out of range, ignored", celsius);
+        return false;
+    }
+
+    TemperatureReading reading;
+    reading.celsius     = celsius;
+    reading.timestampMs = millis();
+    reading.source      = source;
+
+    xSemaphoreTake(writeMutex, portMAX_DELAY);
+    current.publish(reading);
+    xSemaphoreGive(writeMutex);
+
+    Logger::debugf("Temperature %.1f C (%s)", celsius, temperatureSourceName(source));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// DS18B20 probe
+// ---------------------------------------------------------------------------
+#if TEMP_PROBE_ENABLED
+static OneWire           oneWire(Pins::TEMP_PROBE);
+static DallasTemperature probe(&oneWire);
+static bool              probeFound = false;
+static bool              converting = false;
+static unsigned long     lastRequestMs = 0;
+#endif
+
+void temperatureSetup() {
+    writeMutex = xSemaphoreCreateMutex();
+
+#if TEMP_PROBE_ENABLED
+    probe.begin();
+    probeFound = probe.getDeviceCount() > 0;
+    if (!probeFound) {
+        Logger::warnf("No DS18B20 found on GPIO%d", Pins::TEMP_PROBE);
+        return;
+    }
+
+    // Start conversions and collect them later instead of blocking 750 ms
+    probe.setWaitForConversion(false);
+    probe.requestTemperatures();
+    converting = true;
+    lastRequestMs = millis();
+    Logger::infof("DS18B20 found on GPIO%d", Pins::TEMP_PROBE);
+#endif
+}
+
+void temperatureLoop() {
+#if TEMP_PROBE_ENABLED
+    if (!probeFound) {
+        return;
+    }
+
+    unsigned long now = millis();
+    if (converting) {
+        if (now - lastRequestMs < Timing::TEMPERATURE_CONVERSION_MS) {
+            return;
+        }
+        converting = false;
+
+        float celsius = probe.getTempCByIndex(0);
+        if (celsius == DEVICE_DISCONNECTED_C) {
+            Logger::warn("DS18B20 read failed");
+        } else {
+            store(celsius, TemperatureSource::PROBE);
+        }
+    } else if (now - lastRequestMs >= Timing::TEMPERATURE_READ_INTERVAL_MS) {
+        probe.requestTemperatures();
+        converting = true;
+        lastRequestMs = now;
+    }
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+bool temperaturePush(float celsius) {
+    return store(celsius, TemperatureSource::PUSHED);
+}
+
+bool temperatureCurrent(TemperatureReading& out) {
+    return current.read(out) &&
+           millis() - out.timestampMs < Timing::TEMPERATURE_MAX_AGE_MS;
+}
+
+const char* temperatureSourceName(TemperatureSource source) {
+    switch (source) {
+        case TemperatureSource::PROBE:  return "probe";
+        case TemperatureSource::PUSHED: return "pushed";
+        default:                        return "none";
+    }
+}
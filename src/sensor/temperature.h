@@ -0,0 +1,44 @@
+#ifndef TEMPERATURE_H
+#define TEMPERATURE_H
+
+#include <Arduino.h>
+#include "../secrets.h"
+
+// Where the current air temperature came from
+enum class TemperatureSource : uint8_t {
+    NONE   = 0,   // Nothing yet, or too old: the 20 C speed of sound is used
+    PROBE  = 1,   // DS18B20 on Pins::TEMP_PROBE (TEMP_PROBE_ENABLED)
+    PUSHED = 2    // Pushed over MQTT or HTTP
+};
+
+struct TemperatureReading {
+    float             celsius;
+    uint32_t          timestampMs;  // millis() when it was taken
+    TemperatureSource source;
+};
+
+// Start the DS18B20 if TEMP_PROBE_ENABLED, otherwise nothing
+void temperatureSetup();
+
+// Drive the probe's non-blocking conversions - call from the main loop
+void temperatureLoop();
+
+/**
+ * Accept a temperature pushed from outside (Home Assistant, another sensor)
+ *
+ * @param celsius Air temperature in the tank
+ * @return false if outside Sensor::AIR_TEMP_MIN_C..AIR_TEMP_MAX_C (ignored)
+ */
+bool temperaturePush(float celsius);
+
+/**
+ * Lock-free read of the current temperature, from any task
+ *
+ * @return false if none was received within Timing::TEMPERATURE_MAX_AGE_MS
+ */
+bool temperatureCurrent(TemperatureReading& out);
+
+// "probe", "pushed" or "none"
+const char* temperatureSourceName(TemperatureSource source);
+
+#endif // TEMPERATURE_H
@@ -0,0 +1,268 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "history/codec.h"
+
+// Records per flash block, as History::RAM_RECORDS
+static const size_t BLOCK_RECORDS = 64;
+
+// Block header stored in flash next to each encoded block (see history.h)
+static const size_t BLOCK_HEADER_BYTES = 8;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static HistoryRecord record(uint32_t timestamp, int16_t distanceMm, uint8_t flags) {
+    HistoryRecord r;
+    r.timestamp  = timestamp;
+    r.distanceMm = distanceMm;
+    r.flags      = flags;
+    r.reserved   = 0;
+    return r;
+}
+
+// Encode, decode and compare; returns the encoded length
+static size_t roundTrip(const HistoryRecord* records, size_t count) {
+    uint8_t buf[BLOCK_RECORDS * HISTORY_MAX_ENCODED_RECORD];
+    size_t len = historyEncode(records, count, buf, sizeof(buf));
+    TEST_ASSERT_GREATER_THAN(0, len);
+
+    HistoryDecoder decoder(buf, len, records[0].timestamp, count);
+    HistoryRecord out;
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(decoder.next(out));
+        TEST_ASSERT_EQUAL_UINT32(records[i].timestamp, out.timestamp);
+        TEST_ASSERT_EQUAL_INT(records[i].distanceMm, out.distanceMm);
+        TEST_ASSERT_EQUAL_UINT8(records[i].flags & HISTORY_FLAG_SCHEDULED, out.flags);
+    }
+    TEST_ASSERT_FALSE(decoder.next(out));
+    return len;
+}
+
+static void test_regular_interval_costs_two_bytes(void) {
+    HistoryRecord records[BLOCK_RECORDS];
+    for (size_t i = 0; i < BLOCK_RECORDS; i++) {
+        records[i] = record(1700000000UL + i * 3600, static_cast<int16_t>(400 + i % 3), HISTORY_FLAG_SCHEDULED);
+    }
+    size_t len = roundTrip(records, BLOCK_RECORDS);
+
+    // First record carries the absolute distance (one varint of up to 3
+    // bytes), every later one a zero delta-of-delta and a small change
+    TEST_ASSERT_LESS_OR_EQUAL(2 * BLOCK_RECORDS + 2, len);
+}
+
+static void test_irregular_timestamps_and_signs(void) {
+    // Zigzag has to carry negative delta-of-deltas, negative distances (a
+    // failed burst is -1) and large jumps in both directions (refills)
+    HistoryRecord records[] = {
+        record(1700000000UL, 812, HISTORY_FLAG_SCHEDULED),
+        record(1700003600UL, 815, HISTORY_FLAG_SCHEDULED),
+        record(1700003601UL, 815, 0),                        // On demand, a second later
+        record(1700003601UL, 814, 0),                        // Same second
+        record(1700007200UL, -1, HISTORY_FLAG_SCHEDULED),    // Failed burst
+        record(1700010800UL, 90, HISTORY_FLAG_SCHEDULED),    // Refilled
+        record(1700010860UL, 32767, 0),
+        record(1700010860UL, -32768, 0),
+        record(1800000000UL, 91, HISTORY_FLAG_SCHEDULED),    // Long gap
+        record(1700000000UL, 91, HISTORY_FLAG_SCHEDULED),    // Clock stepped back
+    };
+    roundTrip(records, sizeof(records) / sizeof(records[0]));
+}
+
+static void test_timestamp_wraparound(void) {
+    HistoryRecord records[] = {
+        record(0xFFFFFF00UL, 100, HISTORY_FLAG_SCHEDULED),
+        record(0xFFFFFFF0UL, 100, HISTORY_FLAG_SCHEDULED),
+        record(0x00000010UL, 100, HISTORY_FLAG_SCHEDULED),
+        record(0x00000000UL, 100, HISTORY_FLAG_SCHEDULED),
+    };
+    roundTrip(records, sizeof(records) / sizeof(records[0]));
+}
+
+static void test_only_scheduled_flag_is_kept(void) {
+    HistoryRecord in = record(1700000000UL, 500, 0xFF);
+    uint8_t buf[HISTORY_MAX_ENCODED_RECORD];
+    size_t len = historyEncode(&in, 1, buf, sizeof(buf));
+
+    HistoryDecoder decoder(buf, len, in.timestamp, 1);
+    HistoryRecord out;
+    TEST_ASSERT_TRUE(decoder.next(out));
+    TEST_ASSERT_EQUAL_UINT8(HISTORY_FLAG_SCHEDULED, out.flags);
+    TEST_ASSERT_EQUAL_UINT8(0, out.reserved);
+}
+
+static void test_worst_case_fits_the_bound(void) {
+    // Alternating extremes need the longest varints
+    HistoryRecord records[BLOCK_RECORDS];
+    for (size_t i = 0; i < BLOCK_RECORDS; i++) {
+        records[i] = record(i % 2 ? 0xFFFFFFFFUL : 0, i % 2 ? 32767 : -32768, HISTORY_FLAG_SCHEDULED);
+    }
+    size_t len = roundTrip(records, BLOCK_RECORDS);
+    TEST_ASSERT_LESS_OR_EQUAL(BLOCK_RECORDS * HISTORY_MAX_ENCODED_RECORD, len);
+}
+
+static void test_encode_fails_when_out_of_space(void) {
+    HistoryRecord records[4];
+    for (size_t i = 0; i < 4; i++) {
+        records[i] = record(1700000000UL + i * 3600, 400, HISTORY_FLAG_SCHEDULED);
+    }
+    uint8_t buf[32];
+    size_t len = historyEncode(records, 4, buf, sizeof(buf));
+    TEST_ASSERT_GREATER_THAN(0, len);
+    TEST_ASSERT_EQUAL_size_t(0, historyEncode(records, 4, buf, len - 1));
+    TEST_ASSERT_EQUAL_size_t(0, historyEncode(records, 0, buf, sizeof(buf)));
+}
+
+static void test_decoder_stops_on_bad_data(void) {
+    HistoryRecord records[3];
+    for (size_t i = 0; i < 3; i++) {
+        records[i] = record(1700000000UL + i * 3600, 400, HISTORY_FLAG_SCHEDULED);
+    }
+    uint8_t buf[32];
+    size_t len = historyEncode(records, 3, buf, sizeof(buf));
+    HistoryRecord out;
+
+    // Count limits the records even if more bytes follow
+    HistoryDecoder counted(buf, len, records[0].timestamp, 2);
+    TEST_ASSERT_TRUE(counted.next(out));
+    TEST_ASSERT_TRUE(counted.next(out));
+    TEST_ASSERT_FALSE(counted.next(out));
+
+    // Truncated block
+    HistoryDecoder truncated(buf, len - 1, records[0].timestamp, 3);
+    TEST_ASSERT_TRUE(truncated.next(out));
+    TEST_ASSERT_TRUE(truncated.next(out));
+    TEST_ASSERT_FALSE(truncated.next(out));
+    TEST_ASSERT_FALSE(truncated.next(out));
+
+    // A varint longer than five bytes (e.g. erased flash, all 0xFF)
+    uint8_t erased[16];
+    memset(erased, 0xFF, sizeof(erased));
+    HistoryDecoder garbage(erased, sizeof(erased), 0, 1);
+    TEST_ASSERT_FALSE(garbage.next(out));
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark: a synthetic year, encoded block by block as the store does
+// ---------------------------------------------------------------------------
+static uint32_t lcgState = 12345;
+
+static uint32_t lcg() {
+    lcgState = lcgState * 1664525UL + 1013904223UL;
+    return lcgState >> 8;
+}
+
+// Salt slowly dissolving, a refill every six weeks, a few mm of echo
+// noise and the odd on-demand reading or failed burst between scheduled ones
+static std::vector<HistoryRecord> syntheticYear(uint32_t intervalS) {
+    std::vector<HistoryRecord> out;
+    const uint32_t start = 1704067200UL;   // 2024-01-01
+    const uint32_t refillS = 42UL * 86400UL;
+    for (uint32_t t = start; t < start + 365UL * 86400UL; t += intervalS) {
+        uint32_t sinceRefill = (t - start) % refillS;
+        int level = 150 + static_cast<int>(sinceRefill / 4000);   // ~2 cm a day
+        int noise = static_cast<int>(lcg() % 5) - 2;
+        uint32_t roll = lcg() % 1000;
+        out.push_back(record(t, roll == 0 ? -1 : static_cast<int16_t>(level + noise), HISTORY_FLAG_SCHEDULED));
+        if (roll < 3) {
+            out.push_back(record(t + 1 + lcg() % (intervalS - 1), static_cast<int16_t>(level + noise), 0));
+        }
+    }
+    return out;
+}
+
+struct CodecStats {
+    size_t samples;
+    size_t storedBytes;      // Encoded blocks plus their headers
+    double decodeMsPerYear;
+};
+
+static CodecStats benchmark(const std::vector<HistoryRecord>& records) {
+    CodecStats stats = { records.size(), 0, 0.0 };
+    std::vector<uint8_t> blocks;
+    std::vector<size_t> lengths;
+    uint8_t buf[BLOCK_RECORDS * HISTORY_MAX_ENCODED_RECORD];
+
+    for (size_t i = 0; i < records.size(); i += BLOCK_RECORDS) {
+        size_t count = records.size() - i < BLOCK_RECORDS ? records.size() - i : BLOCK_RECORDS;
+        size_t len = historyEncode(&records[i], count, buf, sizeof(buf));
+        TEST_ASSERT_GREATER_THAN(0, len);
+        blocks.insert(blocks.end(), buf, buf + len);
+        lengths.push_back(len);
+        stats.storedBytes += BLOCK_HEADER_BYTES + len;
+    }
+
+    const int rounds = 20;
+    size_t decoded = 0;
+    int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        size_t offset = 0;
+        for (size_t b = 0; b < lengths.size(); b++) {
+            size_t first = b * BLOCK_RECORDS;
+            size_t count = records.size() - first < BLOCK_RECORDS ? records.size() - first : BLOCK_RECORDS;
+            HistoryDecoder decoder(&blocks[offset], lengths[b], records[first].timestamp, count);
+            HistoryRecord rec;
+            while (decoder.next(rec)) {
+                checksum += rec.distanceMm;
+                decoded++;
+            }
+            offset += lengths[b];
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL_size_t(rounds * records.size(), decoded);
+    TEST_ASSERT_TRUE(checksum != 0);
+    stats.decodeMsPerYear = seconds * 1000.0 / rounds;
+
+    // Spot check the decoded values against the input
+    HistoryDecoder decoder(&blocks[0], lengths[0], records[0].timestamp, BLOCK_RECORDS);
+    HistoryRecord rec;
+    for (size_t i = 0; i < BLOCK_RECORDS && i < records.size(); i++) {
+        TEST_ASSERT_TRUE(decoder.next(rec));
+        TEST_ASSERT_EQUAL_UINT32(records[i].timestamp, rec.timestamp);
+        TEST_ASSERT_EQUAL_INT(records[i].distanceMm, rec.distanceMm);
+    }
+    return stats;
+}
+
+static void report(const char* name, const CodecStats& s) {
+    double perSample = static_cast<double>(s.storedBytes) / s.samples;
+    char line[200];
+    snprintf(line, sizeof(line),
+             "%s: %zu samples, %zu B stored, %.2f B/sample (raw record %zu B, %.1fx), "
+             "decode %.1f ms/year, %.1f M samples/s",
+             name, s.samples, s.storedBytes, perSample, sizeof(HistoryRecord),
+             sizeof(HistoryRecord) / perSample, s.decodeMsPerYear,
+             s.samples / s.decodeMsPerYear / 1000.0);
+    TEST_MESSAGE(line);
+}
+
+static void test_benchmark_year_hourly(void) {
+    CodecStats s = benchmark(syntheticYear(3600));
+    report("hourly", s);
+    TEST_ASSERT_LESS_THAN(3 * s.samples, s.storedBytes);
+}
+
+static void test_benchmark_year_per_minute(void) {
+    CodecStats s = benchmark(syntheticYear(60));
+    report("per-minute", s);
+    TEST_ASSERT_LESS_THAN(3 * s.samples, s.storedBytes);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_regular_interval_costs_two_bytes);
+    RUN_TEST(test_irregular_timestamps_and_signs);
+    RUN_TEST(test_timestamp_wraparound);
+    RUN_TEST(test_only_scheduled_flag_is_kept);
+    RUN_TEST(test_worst_case_fits_the_bound);
+    RUN_TEST(test_encode_fails_when_out_of_space);
+    RUN_TEST(test_decoder_stops_on_bad_data);
+    RUN_TEST(test_benchmark_year_hourly);
+    RUN_TEST(test_benchmark_year_per_minute);
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+#include <unity.h>
+#include <cmath>
+#include "analysis/consumption.h"
+
+static const uint32_t T0 = 1704067200UL;   // 2024-01-01
+static const uint32_t HOUR = 3600;
+static const float EMPTY_CM = 60.0f;
+
+static uint32_t lcgState;
+
+// Roughly normal noise (sum of uniforms), 1 sigma = sigma
+static float noise(float sigma) {
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        lcgState = lcgState * 1664525UL + 1013904223UL;
+        sum += (lcgState >> 8) / 16777216.0f - 0.5f;
+    }
+    return sum * sigma * 1.732f;
+}
+
+void setUp(void) {
+    lcgState = 12345;
+}
+
+void tearDown(void) {}
+
+// Hourly readings of a level moving rateCmPerDay from startCm
+static uint32_t feed(ConsumptionEstimator& est, uint32_t from, uint32_t hours,
+                     float startCm, float rateCmPerDay, float sigma, int* refills = nullptr) {
+    uint32_t t = from;
+    for (uint32_t h = 0; h < hours; h++) {
+        t = from + h * HOUR;
+        float cm = startCm + rateCmPerDay * h / 24.0f + noise(sigma);
+        if (est.add(t, cm) && refills) {
+            (*refills)++;
+        }
+    }
+    return t;
+}
+
+static void test_clean_line(void) {
+    ConsumptionEstimator est;
+    uint32_t last = feed(est, T0, 10 * 24, 20.0f, 0.5f, 0.0f);
+
+    ConsumptionEstimate e;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.5f, e.rateCmPerDay);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 20.0f + 0.5f * (10 * 24 - 1) / 24.0f, e.levelCm);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, (EMPTY_CM - e.levelCm) / 0.5f, e.daysUntilEmpty);
+    TEST_ASSERT_EQUAL_UINT32(last, est.lastTimestamp());
+    TEST_ASSERT_TRUE(e.emptyAt > last);
+}
+
+static void test_needs_samples_and_span(void) {
+    ConsumptionEstimator est;
+    ConsumptionEstimate e;
+    TEST_ASSERT_FALSE(est.estimate(EMPTY_CM, e));
+
+    // Plenty of readings, but within an hour
+    for (uint32_t i = 0; i < 60; i++) {
+        est.add(T0 + i * 60, 20.0f);
+    }
+    TEST_ASSERT_FALSE(est.estimate(EMPTY_CM, e));
+
+    // A day, but too few readings
+    ConsumptionEstimator sparse;
+    for (uint32_t i = 0; i < 5; i++) {
+        sparse.add(T0 + i * 6 * HOUR, 20.0f + i * 0.1f);
+    }
+    TEST_ASSERT_FALSE(sparse.estimate(EMPTY_CM, e));
+}
+
+static void test_noise_and_glitches(void) {
+    // 1 cm of noise plus an echo glitch every ~2 days, alternating sides
+    ConsumptionEstimator est;
+    for (uint32_t h = 0; h < 21 * 24; h++) {
+        float cm = 15.0f + 0.8f * h / 24.0f + noise(1.0f);
+        if (h % 47 == 20) {
+            cm += (h / 47) % 2 ? 25.0f : -25.0f;
+        }
+        TEST_ASSERT_FALSE(est.add(T0 + h * HOUR, cm));
+    }
+
+    ConsumptionEstimate e;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.08f, 0.8f, e.rateCmPerDay);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 15.0f + 0.8f * 21, e.levelCm);
+}
+
+static void test_refill_restarts_fit(void) {
+    ConsumptionEstimator est;
+    int refills = 0;
+    uint32_t last = feed(est, T0, 30 * 24, 15.0f, 1.0f, 0.5f, &refills);
+    TEST_ASSERT_EQUAL_INT(0, refills);
+
+    // Topped up to 12 cm, then used at a different rate
+    uint32_t refillAt = last + HOUR;
+    feed(est, refillAt, 12, 12.0f, 0.4f, 0.5f, &refills);
+    TEST_ASSERT_EQUAL_INT(1, refills);
+
+    // Right after the refill there is not enough new data
+    ConsumptionEstimate e;
+    TEST_ASSERT_FALSE(est.estimate(EMPTY_CM, e));
+
+    feed(est, refillAt + 12 * HOUR, 14 * 24, 12.0f + 0.2f, 0.4f, 0.5f, &refills);
+    TEST_ASSERT_EQUAL_INT(1, refills);
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.06f, 0.4f, e.rateCmPerDay);
+}
+
+static void test_single_low_reading_is_not_a_refill(void) {
+    ConsumptionEstimator est;
+    uint32_t last = feed(est, T0, 5 * 24, 30.0f, 1.0f, 0.0f);
+    TEST_ASSERT_FALSE(est.add(last + HOUR, 10.0f));
+    TEST_ASSERT_FALSE(est.add(last + 2 * HOUR, 35.0f + 2.0f / 24.0f));
+
+    ConsumptionEstimate e;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, e.rateCmPerDay);
+}
+
+static void test_lasting_jump_up_restarts_without_refill(void) {
+    ConsumptionEstimator est;
+    uint32_t last = feed(est, T0, 5 * 24, 30.0f, 1.0f, 0.0f);
+    TEST_ASSERT_FALSE(est.add(last + HOUR, 45.0f));
+    TEST_ASSERT_FALSE(est.add(last + 2 * HOUR, 45.0f));
+
+    // The old line is gone: not enough readings since the restart
+    ConsumptionEstimate e;
+    TEST_ASSERT_FALSE(est.estimate(EMPTY_CM, e));
+}
+
+static void test_follows_a_change_in_usage(void) {
+    // Readings weigh exp(-age / TAU_DAYS): six weeks later the old rate is
+    // down to a few percent of the fit
+    ConsumptionEstimator est;
+    uint32_t last = feed(est, T0, 30 * 24, 10.0f, 0.5f, 0.3f);
+    feed(est, last + HOUR, 45 * 24, 10.0f + 15.0f, 1.5f, 0.3f);
+
+    ConsumptionEstimate e;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 1.5f, e.rateCmPerDay);
+}
+
+static void test_no_forecast_without_consumption(void) {
+    ConsumptionEstimator est;
+    feed(est, T0, 5 * 24, 30.0f, 0.0f, 0.0f);
+
+    ConsumptionEstimate e;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, e.rateCmPerDay);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, e.daysUntilEmpty);
+    TEST_ASSERT_EQUAL_UINT32(0, e.emptyAt);
+
+    // Already at or past empty
+    TEST_ASSERT_TRUE(est.estimate(25.0f, e));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, e.daysUntilEmpty);
+    TEST_ASSERT_EQUAL_UINT32(est.lastTimestamp(), e.emptyAt);
+}
+
+static void test_out_of_order_readings_are_ignored(void) {
+    ConsumptionEstimator est;
+    uint32_t last = feed(est, T0, 3 * 24, 20.0f, 1.0f, 0.0f);
+    ConsumptionEstimate before;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, before));
+
+    TEST_ASSERT_FALSE(est.add(last, 0.0f));
+    TEST_ASSERT_FALSE(est.add(last - HOUR, 0.0f));
+    ConsumptionEstimate after;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, after));
+    TEST_ASSERT_EQUAL_FLOAT(before.rateCmPerDay, after.rateCmPerDay);
+    TEST_ASSERT_EQUAL_UINT32(last, est.lastTimestamp());
+}
+
+static void test_long_run_stays_conditioned(void) {
+    // A year without a refill, as a slowly used tank might go: the
+    // relative time axis keeps the float sums from losing the slope
+    ConsumptionEstimator est;
+    feed(est, T0, 365 * 24, 5.0f, 0.1f, 0.3f);
+
+    ConsumptionEstimate e;
+    TEST_ASSERT_TRUE(est.estimate(EMPTY_CM, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.1f, e.rateCmPerDay);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 5.0f + 0.1f * 365, e.levelCm);
+    TEST_ASSERT_TRUE(std::isfinite(e.daysUntilEmpty));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_line);
+    RUN_TEST(test_needs_samples_and_span);
+    RUN_TEST(test_noise_and_glitches);
+    RUN_TEST(test_refill_restarts_fit);
+    RUN_TEST(test_single_low_reading_is_not_a_refill);
+    RUN_TEST(test_lasting_jump_up_restarts_without_refill);
+    RUN_TEST(test_follows_a_change_in_usage);
+    RUN_TEST(test_no_forecast_without_consumption);
+    RUN_TEST(test_out_of_order_readings_are_ignored);
+    RUN_TEST(test_long_run_stays_conditioned);
+    return UNITY_END();
+}
@@ -0,0 +1,150 @@
+#include <unity.h>
+#include <cmath>
+#include "sensor/distance.h"
+#include "constants.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_echo_duration_is_halved_round_trip(void) {
+    // 2915 us at 0.0343 cm/us is 50 cm there and back
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 49.99f, echoDurationToCm(2915, Sensor::SOUND_SPEED_CM_PER_US));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, echoDurationToCm(0, Sensor::SOUND_SPEED_CM_PER_US));
+}
+
+static void test_median_odd_count(void) {
+    float readings[] = {42.0f, 40.0f, 41.0f};
+    TEST_ASSERT_EQUAL_FLOAT(41.0f, medianOfReadings(readings, 3));
+    // Sorted in place
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, readings[0]);
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, readings[2]);
+}
+
+static void test_median_even_count_takes_upper(void) {
+    float readings[] = {30.0f, 10.0f, 40.0f, 20.0f};
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, medianOfReadings(readings, 4));
+}
+
+static void test_median_single_and_empty(void) {
+    float one[] = {12.5f};
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, medianOfReadings(one, 1));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, medianOfReadings(one, 0));
+}
+
+static void test_median_ignores_one_outlier(void) {
+    // A splash echo among three pings does not move the result
+    float readings[] = {45.1f, 12.0f, 45.3f};
+    TEST_ASSERT_EQUAL_FLOAT(45.1f, medianOfReadings(readings, 3));
+}
+
+static void test_mad_of_agreeing_readings(void) {
+    const float readings[] = {45.0f, 45.4f, 44.8f, 45.2f, 60.0f};
+    // Median 45.2, deviations 0.2 0.2 0.4 0 14.8
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.2f, medianAbsoluteDeviation(readings, 5));
+    // Input left untouched
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, readings[4]);
+}
+
+static void test_mad_rejects_bad_counts(void) {
+    float readings[Sensor::MAX_READING_ATTEMPTS + 1] = {};
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, medianAbsoluteDeviation(readings, 0));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, medianAbsoluteDeviation(readings, Sensor::MAX_READING_ATTEMPTS + 1));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, medianAbsoluteDeviation(readings, Sensor::MAX_READING_ATTEMPTS));
+}
+
+static void test_burst_needs_min_readings(void) {
+    const float readings[] = {45.0f, 45.0f};
+    TEST_ASSERT_FALSE(burstSettled(readings, Sensor::MIN_READINGS - 1));
+    TEST_ASSERT_TRUE(burstSettled(readings, Sensor::MIN_READINGS));
+}
+
+static void test_burst_settles_within_variance(void) {
+    const float close[] = {45.0f, 45.0f + Sensor::MAX_READING_VARIANCE_CM};
+    TEST_ASSERT_TRUE(burstSettled(close, 2));
+
+    const float apart[] = {45.0f, 48.0f};
+    TEST_ASSERT_FALSE(burstSettled(apart, 2));
+
+    // A third reading that agrees with one of them settles the burst
+    const float third[] = {45.0f, 48.0f, 45.2f};
+    TEST_ASSERT_TRUE(burstSettled(third, 3));
+}
+
+// Dry-air speed of sound, in cm/us
+static float soundSpeedReference(float celsius) {
+    return 331.3f * std::sqrt(1.0f + celsius / 273.15f) * 1e-4f;
+}
+
+static void test_sound_speed_spot_checks(void) {
+    TEST_ASSERT_FLOAT_WITHIN(2e-6f, soundSpeedReference(0.0f), soundSpeedCmPerUs(0.0f));
+    TEST_ASSERT_FLOAT_WITHIN(2e-6f, soundSpeedReference(20.0f), soundSpeedCmPerUs(20.0f));
+    TEST_ASSERT_FLOAT_WITHIN(2e-6f, soundSpeedReference(35.0f), soundSpeedCmPerUs(35.0f));
+
+    // The fallback constant is the 20 C value
+    TEST_ASSERT_FLOAT_WITHIN(5e-5f, Sensor::SOUND_SPEED_CM_PER_US, soundSpeedCmPerUs(20.0f));
+}
+
+static void test_sound_speed_interpolates_between_entries(void) {
+    // Linear interpolation over 5 C steps stays within a few ppm of the curve
+    for (float t = Sensor::AIR_TEMP_MIN_C; t <= Sensor::AIR_TEMP_MAX_C; t += 0.7f) {
+        TEST_ASSERT_FLOAT_WITHIN(2e-6f, soundSpeedReference(t), soundSpeedCmPerUs(t));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(2e-6f, soundSpeedReference(Sensor::AIR_TEMP_MAX_C),
+                             soundSpeedCmPerUs(Sensor::AIR_TEMP_MAX_C));
+
+    // Halfway between two entries is their mean
+    float mid = (soundSpeedCmPerUs(10.0f) + soundSpeedCmPerUs(15.0f)) / 2.0f;
+    TEST_ASSERT_FLOAT_WITHIN(1e-7f, mid, soundSpeedCmPerUs(12.5f));
+}
+
+static void test_sound_speed_is_monotonic(void) {
+    float previous = soundSpeedCmPerUs(Sensor::AIR_TEMP_MIN_C);
+    for (float t = Sensor::AIR_TEMP_MIN_C + 0.25f; t <= Sensor::AIR_TEMP_MAX_C; t += 0.25f) {
+        float speed = soundSpeedCmPerUs(t);
+        TEST_ASSERT_TRUE(speed > previous);
+        previous = speed;
+    }
+}
+
+static void test_sound_speed_clamps_at_both_ends(void) {
+    float coldest = soundSpeedCmPerUs(Sensor::AIR_TEMP_MIN_C);
+    float hottest = soundSpeedCmPerUs(Sensor::AIR_TEMP_MAX_C);
+    TEST_ASSERT_FLOAT_WITHIN(2e-6f, soundSpeedReference(Sensor::AIR_TEMP_MIN_C), coldest);
+
+    TEST_ASSERT_EQUAL_FLOAT(coldest, soundSpeedCmPerUs(Sensor::AIR_TEMP_MIN_C - 0.1f));
+    TEST_ASSERT_EQUAL_FLOAT(coldest, soundSpeedCmPerUs(-273.15f));
+    TEST_ASSERT_EQUAL_FLOAT(coldest, soundSpeedCmPerUs(-INFINITY));
+    TEST_ASSERT_EQUAL_FLOAT(hottest, soundSpeedCmPerUs(Sensor::AIR_TEMP_MAX_C + 0.1f));
+    TEST_ASSERT_EQUAL_FLOAT(hottest, soundSpeedCmPerUs(1000.0f));
+    TEST_ASSERT_EQUAL_FLOAT(hottest, soundSpeedCmPerUs(INFINITY));
+
+    // NaN (a failed conversion) lands on a bound rather than propagating
+    TEST_ASSERT_TRUE(std::isfinite(soundSpeedCmPerUs(NAN)));
+}
+
+static void test_compensation_shifts_readings(void) {
+    // The same 50 cm echo read with the 20 C constant in a 0 C garage is
+    // off by almost 2 cm; with the compensated speed it is exact
+    uint32_t echoUs = static_cast<uint32_t>(2.0f * 50.0f / soundSpeedReference(0.0f) + 0.5f);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 50.0f, echoDurationToCm(echoUs, soundSpeedCmPerUs(0.0f)));
+    TEST_ASSERT_GREATER_THAN_FLOAT(1.5f, echoDurationToCm(echoUs, Sensor::SOUND_SPEED_CM_PER_US) - 50.0f);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_echo_duration_is_halved_round_trip);
+    RUN_TEST(test_median_odd_count);
+    RUN_TEST(test_median_even_count_takes_upper);
+    RUN_TEST(test_median_single_and_empty);
+    RUN_TEST(test_median_ignores_one_outlier);
+    RUN_TEST(test_mad_of_agreeing_readings);
+    RUN_TEST(test_mad_rejects_bad_counts);
+    RUN_TEST(test_burst_needs_min_readings);
+    RUN_TEST(test_burst_settles_within_variance);
+    RUN_TEST(test_sound_speed_spot_checks);
+    RUN_TEST(test_sound_speed_interpolates_between_entries);
+    RUN_TEST(test_sound_speed_is_monotonic);
+    RUN_TEST(test_sound_speed_clamps_at_both_ends);
+    RUN_TEST(test_compensation_shifts_readings);
+    return UNITY_END();
+}
@@ -0,0 +1,140 @@
+#include <unity.h>
+#include "analysis/events.h"
+#include "constants.h"
+
+static const uint32_t T0 = 1704067200UL;   // 2024-01-01
+static const uint32_t HOUR = 3600;
+
+static LevelEventDetector detector;
+static uint32_t lastTimestamp;
+
+void setUp(void) {
+    detector.reset();
+    lastTimestamp = T0;
+}
+
+void tearDown(void) {}
+
+// Next reading an hour after the last; true if it produced an event
+static bool feed(float distanceCm, LevelEvent& out) {
+    lastTimestamp += HOUR;
+    return detector.add(lastTimestamp, distanceCm, out);
+}
+
+// Readings that must not produce an event
+static void feedQuiet(float distanceCm, int count) {
+    LevelEvent e;
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_FALSE(feed(distanceCm, e));
+    }
+}
+
+static void test_refill(void) {
+    feedQuiet(40.0f, 5);
+
+    LevelEvent e;
+    TEST_ASSERT_FALSE(feed(28.0f, e));    // Held until the next reading
+    uint32_t dropAt = lastTimestamp;
+    TEST_ASSERT_TRUE(feed(28.4f, e));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(LevelEventType::REFILL), static_cast<int>(e.type));
+    TEST_ASSERT_EQUAL_UINT32(dropAt, e.timestamp);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -11.8f, e.deltaCm);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 28.2f, e.levelCm);
+
+    // The reference has moved: the new level is quiet
+    feedQuiet(28.2f, 5);
+}
+
+static void test_regeneration_step(void) {
+    feedQuiet(40.0f, 5);
+
+    LevelEvent e;
+    TEST_ASSERT_FALSE(feed(41.5f, e));
+    TEST_ASSERT_TRUE(feed(41.5f, e));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(LevelEventType::REGENERATION), static_cast<int>(e.type));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.5f, e.deltaCm);
+    feedQuiet(41.5f, 3);
+}
+
+static void test_small_lasting_drop_is_not_an_event(void) {
+    // Salt settling: lasting, but short of a refill
+    feedQuiet(40.0f, 5);
+    feedQuiet(38.0f, 2);
+    feedQuiet(38.0f, 3);
+}
+
+static void test_glitch(void) {
+    feedQuiet(40.0f, 5);
+
+    LevelEvent e;
+    TEST_ASSERT_FALSE(feed(18.0f, e));    // Condensation echo
+    uint32_t glitchAt = lastTimestamp;
+    TEST_ASSERT_TRUE(feed(40.1f, e));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(LevelEventType::GLITCH), static_cast<int>(e.type));
+    TEST_ASSERT_EQUAL_UINT32(glitchAt, e.timestamp);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -22.0f, e.deltaCm);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, e.levelCm);
+    feedQuiet(40.0f, 3);
+}
+
+static void test_unconfirmed_holds(void) {
+    feedQuiet(40.0f, 5);
+
+    // Too small to report as a glitch, and not repeated
+    LevelEvent e;
+    TEST_ASSERT_FALSE(feed(41.5f, e));
+    TEST_ASSERT_FALSE(feed(40.0f, e));
+
+    // Departs the other way next: the held reading was a glitch, and the
+    // new one is held in turn rather than confirming anything
+    TEST_ASSERT_FALSE(feed(46.0f, e));
+    TEST_ASSERT_TRUE(feed(34.0f, e));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(LevelEventType::GLITCH), static_cast<int>(e.type));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 6.0f, e.deltaCm);
+    TEST_ASSERT_TRUE(feed(40.0f, e));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(LevelEventType::GLITCH), static_cast<int>(e.type));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -6.0f, e.deltaCm);
+
+    // Same way, but too far apart to agree on a level
+    feedQuiet(40.0f, 3);
+    TEST_ASSERT_FALSE(feed(20.0f, e));
+    TEST_ASSERT_TRUE(feed(30.0f, e));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(LevelEventType::GLITCH), static_cast<int>(e.type));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -20.0f, e.deltaCm);
+    TEST_ASSERT_TRUE(feed(40.0f, e));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -10.0f, e.deltaCm);
+
+    // A reading held when the stream stops is dropped with a reset
+    feedQuiet(40.0f, 3);
+    TEST_ASSERT_FALSE(feed(25.0f, e));
+    detector.reset();
+    feedQuiet(25.0f, 3);
+}
+
+static void test_slow_drift_is_quiet(void) {
+    // 0.3 cm between readings, far faster than salt is used, with a
+    // little noise: the reference follows it without ever seeing a step
+    LevelEvent e;
+    for (int h = 0; h < 3 * 24; h++) {
+        float noise = ((h * 7919) % 5) * 0.05f - 0.1f;
+        TEST_ASSERT_FALSE(feed(20.0f + 0.3f * h + noise, e));
+    }
+}
+
+static void test_event_names(void) {
+    TEST_ASSERT_EQUAL_STRING("refill", levelEventName(LevelEventType::REFILL));
+    TEST_ASSERT_EQUAL_STRING("regeneration", levelEventName(LevelEventType::REGENERATION));
+    TEST_ASSERT_EQUAL_STRING("glitch", levelEventName(LevelEventType::GLITCH));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_refill);
+    RUN_TEST(test_regeneration_step);
+    RUN_TEST(test_small_lasting_drop_is_not_an_event);
+    RUN_TEST(test_glitch);
+    RUN_TEST(test_unconfirmed_holds);
+    RUN_TEST(test_slow_drift_is_quiet);
+    RUN_TEST(test_event_names);
+    return UNITY_END();
+}
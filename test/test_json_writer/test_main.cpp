@@ -0,0 +1,257 @@
+#include <unity.h>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include "json/json_writer.h"
+
+// Heap use of the code under test
+static size_t heapAllocations = 0;
+static size_t heapBytes = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    heapBytes += size;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+static char buf[256];
+
+void setUp(void) {
+    memset(buf, 'x', sizeof(buf));
+}
+
+void tearDown(void) {}
+
+static void test_commas_and_nesting(void) {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginObject()
+       .field("a", 1)
+       .key("list").beginArray().value(1).value(2).beginObject().endObject().endArray()
+       .key("empty").beginArray().endArray()
+       .field("ok", true)
+     .endObject();
+    TEST_ASSERT_TRUE(w.ok());
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"list\":[1,2,{}],\"empty\":[],\"ok\":true}", buf);
+    TEST_ASSERT_EQUAL_size_t(strlen(buf), w.length());
+}
+
+static void test_string_escaping(void) {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray()
+       .value("say \"hi\"\\")
+       .value("line\nfeed\r\ttab\b\f")
+       .value("\x01\x1f")
+       .value("caf\xc3\xa9")
+       .value(static_cast<const char*>(nullptr))
+     .endArray();
+    TEST_ASSERT_TRUE(w.ok());
+    TEST_ASSERT_EQUAL_STRING(
+        "[\"say \\\"hi\\\"\\\\\",\"line\\nfeed\\r\\ttab\\b\\f\",\"\\u0001\\u001f\",\"caf\xc3\xa9\",null]",
+        buf);
+}
+
+static void test_keys_are_escaped(void) {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginObject().field("a\"b", 0).endObject();
+    TEST_ASSERT_EQUAL_STRING("{\"a\\\"b\":0}", buf);
+}
+
+static void test_integers(void) {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray().value(0).value(-7).value(LONG_MIN).value(ULONG_MAX).value(4294967295UL).endArray();
+    char expected[128];
+    snprintf(expected, sizeof(expected), "[0,-7,%ld,%lu,4294967295]", LONG_MIN, ULONG_MAX);
+    TEST_ASSERT_EQUAL_STRING(expected, buf);
+}
+
+static void test_fixed_point_floats(void) {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray()
+       .value(42.5f, 2)
+       .value(0.125f, 2)     // Half away from zero
+       .value(-1.5f, 0)
+       .value(-0.004f, 2)    // Rounds to zero: no "-0.00"
+       .value(3.14159f, 9)   // Clamped to MAX_DECIMALS
+       .value(1234567.0f, 1)
+     .endArray();
+    TEST_ASSERT_TRUE(w.ok());
+    TEST_ASSERT_EQUAL_STRING("[42.50,0.13,-2,0.00,3.141590,1234567.0]", buf);
+}
+
+static void test_non_finite_floats_write_null(void) {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray().value(NAN, 1).value(INFINITY, 1).value(-INFINITY, 1).value(2e9f, 1).endArray();
+    TEST_ASSERT_EQUAL_STRING("[null,null,null,null]", buf);
+}
+
+static void test_overflow_is_sticky(void) {
+    char small[16];
+    JsonWriter w(small, sizeof(small));
+    w.beginObject().field("name", "much too long for this").endObject();
+    TEST_ASSERT_TRUE(w.overflowed());
+    TEST_ASSERT_FALSE(w.ok());
+    size_t length = w.length();
+    TEST_ASSERT_LESS_THAN(sizeof(small), length);
+    TEST_ASSERT_EQUAL_size_t(strlen(small), length);
+
+    // Later output that would fit is not appended after the cut
+    w.value(1);
+    TEST_ASSERT_EQUAL_size_t(length, w.length());
+    TEST_ASSERT_TRUE(w.overflowed());
+
+    w.reset();
+    w.beginObject().endObject();
+    TEST_ASSERT_TRUE(w.ok());
+    TEST_ASSERT_EQUAL_STRING("{}", small);
+}
+
+static void test_exact_fit(void) {
+    char exact[3];   // "{}" and its NUL
+    JsonWriter w(exact, sizeof(exact));
+    w.beginObject().endObject();
+    TEST_ASSERT_TRUE(w.ok());
+    TEST_ASSERT_EQUAL_STRING("{}", exact);
+}
+
+static void test_unbalanced_documents_are_not_ok(void) {
+    JsonWriter open(buf, sizeof(buf));
+    open.beginObject();
+    TEST_ASSERT_FALSE(open.ok());
+    TEST_ASSERT_FALSE(open.overflowed());
+
+    JsonWriter extra(buf, sizeof(buf));
+    extra.beginArray().endArray().endArray();
+    TEST_ASSERT_TRUE(extra.overflowed());
+
+    JsonWriter deep(buf, sizeof(buf));
+    for (int i = 0; i <= JsonWriter::MAX_DEPTH; i++) {
+        deep.beginArray();
+    }
+    TEST_ASSERT_TRUE(deep.overflowed());
+}
+
+static void test_zero_capacity(void) {
+    JsonWriter w(nullptr, 0);
+    w.beginObject().endObject();
+    TEST_ASSERT_FALSE(w.ok());
+    TEST_ASSERT_EQUAL_size_t(0, w.length());
+}
+
+// A /api/status document, as the handlers write it and as the old
+// snprintf code did
+struct Status {
+    float       distance, percent, full, empty, warn;
+    const char* topic;
+    int         rssi;
+    unsigned long uptime, interval;
+};
+
+static size_t writeWithJsonWriter(const Status& s, char* out, size_t len) {
+    JsonWriter w(out, len);
+    w.beginObject()
+       .field("tank", 0)
+       .field("distance", s.distance, 2)
+       .field("percent", s.percent, 1)
+       .field("full_cm", s.full, 2)
+       .field("empty_cm", s.empty, 2)
+       .field("warn_cm", s.warn, 2)
+       .field("bark_enabled", false)
+       .field("ntfy_enabled", true)
+       .field("ntfy_topic", s.topic)
+       .field("language", "en")
+       .field("wifi_rssi", s.rssi)
+       .field("uptime_seconds", s.uptime)
+       .field("interval_s", s.interval)
+     .endObject();
+    return w.length();
+}
+
+static size_t writeWithSnprintf(const Status& s, char* out, size_t len) {
+    int n = snprintf(out, len,
+        "{\"tank\":0,\"distance\":%.2f,\"percent\":%.1f,\"full_cm\":%.2f,\"empty_cm\":%.2f,"
+        "\"warn_cm\":%.2f,\"bark_enabled\":false,\"ntfy_enabled\":true,\"ntfy_topic\":\"%s\","
+        "\"language\":\"en\",\"wifi_rssi\":%d,\"uptime_seconds\":%lu,\"interval_s\":%lu}",
+        s.distance, s.percent, s.full, s.empty, s.warn, s.topic, s.rssi, s.uptime, s.interval);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+// Throughput and heap of both against the old response path, which also
+// copied every body into a heap String
+static void test_benchmark_against_snprintf(void) {
+    Status s = { 41.37f, 44.2f, 20.0f, 58.0f, 45.0f, "saltlevel-abc123", -61, 86400, 3600 };
+    char a[512];
+    char b[512];
+    writeWithJsonWriter(s, a, sizeof(a));
+    writeWithSnprintf(s, b, sizeof(b));
+    TEST_ASSERT_EQUAL_STRING(b, a);
+
+    const int rounds = 200000;
+    size_t bytes = 0;
+    size_t allocations = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        s.uptime = i;
+        bytes += writeWithJsonWriter(s, a, sizeof(a));
+    }
+    double writerSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t writerAllocations = heapAllocations - allocations;
+    double writerRate = bytes / writerSeconds;
+
+    bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        s.uptime = i;
+        bytes += writeWithSnprintf(s, b, sizeof(b));
+    }
+    double snprintfRate = bytes / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    allocations = heapAllocations;
+    size_t heapBefore = heapBytes;
+    for (int i = 0; i < rounds; i++) {
+        size_t n = writeWithSnprintf(s, b, sizeof(b));
+        std::string body(b, n);
+        bytes += body.size();
+    }
+    size_t copyAllocations = heapAllocations - allocations;
+    size_t copyBytes = heapBytes - heapBefore;
+
+    TEST_ASSERT_EQUAL_size_t(0, writerAllocations);
+
+    char line[200];
+    snprintf(line, sizeof(line),
+             "JsonWriter %.1f MB/s, 0 allocations; snprintf %.1f MB/s; "
+             "body copied to the heap: %zu allocations, %zu B per response",
+             writerRate / 1e6, snprintfRate / 1e6, copyAllocations / rounds, copyBytes / rounds);
+    TEST_MESSAGE(line);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_commas_and_nesting);
+    RUN_TEST(test_string_escaping);
+    RUN_TEST(test_keys_are_escaped);
+    RUN_TEST(test_integers);
+    RUN_TEST(test_fixed_point_floats);
+    RUN_TEST(test_non_finite_floats_write_null);
+    RUN_TEST(test_overflow_is_sticky);
+    RUN_TEST(test_exact_fit);
+    RUN_TEST(test_unbalanced_documents_are_not_ok);
+    RUN_TEST(test_zero_capacity);
+    RUN_TEST(test_benchmark_against_snprintf);
+    return UNITY_END();
+}
@@ -0,0 +1,368 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdio>
+#include "analysis/level_filter.h"
+#include "sensor/distance.h"
+
+static const LevelFilterConfig KALMAN = {
+    LevelFilterType::KALMAN, Filter::PROCESS_NOISE_CM, Filter::MEASUREMENT_NOISE_CM,
+    Filter::GATE_SIGMA, Filter::DEFAULT_WINDOW
+};
+static const LevelFilterConfig HAMPEL = {
+    LevelFilterType::HAMPEL, Filter::PROCESS_NOISE_CM, Filter::MEASUREMENT_NOISE_CM,
+    Filter::GATE_SIGMA, Filter::DEFAULT_WINDOW
+};
+static const LevelFilterConfig NONE = { LevelFilterType::NONE, 0.0f, 0.0f, 0.0f, 0 };
+static const LevelFilterConfig DEFAULT_FILTER = {
+    static_cast<LevelFilterType>(Filter::DEFAULT_TYPE), Filter::PROCESS_NOISE_CM,
+    Filter::MEASUREMENT_NOISE_CM, Filter::GATE_SIGMA, Filter::DEFAULT_WINDOW
+};
+
+static uint32_t lcgState;
+
+static float uniform() {
+    lcgState = lcgState * 1664525UL + 1013904223UL;
+    return (lcgState >> 8) / 16777216.0f;
+}
+
+// Roughly normal (sum of uniforms), 1 sigma = sigma
+static float noise(float sigma) {
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        sum += uniform() - 0.5f;
+    }
+    return sum * sigma * 1.732f;
+}
+
+void setUp(void) {
+    lcgState = 2024;
+}
+
+void tearDown(void) {}
+
+// ---------------------------------------------------------------------------
+// Filters
+// ---------------------------------------------------------------------------
+static void test_none_passes_readings_through(void) {
+    LevelEstimator est;
+    est.configure(NONE);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, est.update(40.0f, 1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(90.0f, est.update(90.0f, 1.0f));
+    TEST_ASSERT_FALSE(est.rejected());
+}
+
+static void test_kalman_smooths_noise(void) {
+    KalmanLevelFilter k;
+    k.reset();
+    float worst = 0.0f;
+    for (int i = 0; i < 200; i++) {
+        float out = k.update(40.0f + noise(1.0f), 1.0f, KALMAN);
+        if (i >= 20 && fabsf(out - 40.0f) > worst) worst = fabsf(out - 40.0f);
+    }
+    // Steady-state gain ~0.26: about half the reading noise gets through
+    TEST_ASSERT_LESS_THAN_FLOAT(1.5f, worst);
+}
+
+static void test_kalman_gates_single_outlier(void) {
+    KalmanLevelFilter k;
+    k.reset();
+    for (int i = 0; i < 10; i++) k.update(40.0f, 1.0f, KALMAN);
+    TEST_ASSERT_FALSE(k.rejected());
+
+    float out = k.update(15.0f, 1.0f, KALMAN);   // Condensation echo
+    TEST_ASSERT_TRUE(k.rejected());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, out);
+
+    out = k.update(40.2f, 1.0f, KALMAN);
+    TEST_ASSERT_FALSE(k.rejected());
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 40.0f, out);
+}
+
+static void test_kalman_follows_refill(void) {
+    KalmanLevelFilter k;
+    k.reset();
+    for (int i = 0; i < 10; i++) k.update(50.0f, 1.0f, KALMAN);
+
+    // Rejected until MAX_CONSECUTIVE_REJECTS readings agree, then taken
+    float out = 0.0f;
+    for (uint8_t i = 1; i < Filter::MAX_CONSECUTIVE_REJECTS; i++) {
+        out = k.update(20.0f, 1.0f, KALMAN);
+        TEST_ASSERT_TRUE(k.rejected());
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, out);
+    }
+    out = k.update(20.0f, 1.0f, KALMAN);
+    TEST_ASSERT_FALSE(k.rejected());
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, out);
+}
+
+static void test_kalman_scattered_rejects_do_not_reinit(void) {
+    // Stray echoes that disagree with each other are never taken as a level
+    KalmanLevelFilter k;
+    k.reset();
+    for (int i = 0; i < 10; i++) k.update(50.0f, 1.0f, KALMAN);
+    const float glitches[] = { 20.0f, 30.0f, 12.0f, 25.0f, 35.0f };
+    for (size_t i = 0; i < sizeof(glitches) / sizeof(glitches[0]); i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, k.update(glitches[i], 1.0f, KALMAN));
+        TEST_ASSERT_TRUE(k.rejected());
+    }
+}
+
+static void test_kalman_longer_distance_must_persist(void) {
+    // Hours of condensation reading long: the salt did not vanish
+    KalmanLevelFilter k;
+    k.reset();
+    for (int i = 0; i < 10; i++) k.update(40.0f, 1.0f, KALMAN);
+    for (uint8_t i = 1; i < Filter::MAX_REJECTS_RISING; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, k.update(55.0f, 1.0f, KALMAN));
+        TEST_ASSERT_TRUE(k.rejected());
+    }
+
+    // A day of it (a remounted sensor) is taken
+    TEST_ASSERT_EQUAL_FLOAT(55.0f, k.update(55.0f, 1.0f, KALMAN));
+    TEST_ASSERT_FALSE(k.rejected());
+}
+
+static void test_kalman_long_gap_widens_gate(void) {
+    // After a day without readings the level may have moved more than the
+    // hourly gate allows; the prediction step has to account for it
+    KalmanLevelFilter k;
+    k.reset();
+    for (int i = 0; i < 10; i++) k.update(40.0f, 1.0f, KALMAN);
+    k.update(45.0f, 48.0f, KALMAN);
+    TEST_ASSERT_FALSE(k.rejected());
+}
+
+static void test_hampel_replaces_spike_with_median(void) {
+    HampelLevelFilter h;
+    h.reset();
+    const float readings[] = { 40.0f, 40.3f, 39.8f, 40.1f, 39.9f, 40.2f };
+    for (size_t i = 0; i < sizeof(readings) / sizeof(readings[0]); i++) {
+        TEST_ASSERT_EQUAL_FLOAT(readings[i], h.update(readings[i], HAMPEL));
+        TEST_ASSERT_FALSE(h.rejected());
+    }
+    float out = h.update(65.0f, HAMPEL);
+    TEST_ASSERT_TRUE(h.rejected());
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 40.05f, out);
+}
+
+static void test_hampel_follows_lasting_step(void) {
+    HampelLevelFilter h;
+    h.reset();
+    for (int i = 0; i < 7; i++) h.update(50.0f, HAMPEL);
+
+    // Once the new level holds the majority of the window it is the median
+    float out = 0.0f;
+    for (int i = 0; i < Filter::DEFAULT_WINDOW / 2 + 1; i++) {
+        out = h.update(20.0f, HAMPEL);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, out);
+    TEST_ASSERT_FALSE(h.rejected());
+}
+
+static void test_hampel_window_is_clamped(void) {
+    LevelFilterConfig wide = HAMPEL;
+    wide.window = 200;
+    HampelLevelFilter h;
+    h.reset();
+    for (int i = 0; i < 100; i++) {
+        h.update(40.0f + (i % 2) * 0.2f, wide);
+    }
+    h.update(80.0f, wide);
+    TEST_ASSERT_TRUE(h.rejected());
+
+    LevelFilterConfig narrow = HAMPEL;
+    narrow.window = 0;
+    h.reset();
+    h.update(40.0f, narrow);
+    h.update(40.0f, narrow);
+    h.update(80.0f, narrow);
+    TEST_ASSERT_TRUE(h.rejected());
+}
+
+static void test_reconfigure_restarts_filter(void) {
+    LevelEstimator est;
+    est.configure(KALMAN);
+    for (int i = 0; i < 10; i++) est.update(50.0f, 1.0f);
+
+    // Same type: state kept, the step is gated
+    est.configure(KALMAN);
+    est.update(20.0f, 1.0f);
+    TEST_ASSERT_TRUE(est.rejected());
+
+    // Switching away and back starts afresh on the next reading
+    est.configure(HAMPEL);
+    est.configure(KALMAN);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, est.update(20.0f, 1.0f));
+    TEST_ASSERT_FALSE(est.rejected());
+}
+
+// ---------------------------------------------------------------------------
+// Replay: hourly bursts as the firmware takes them, fed to the alert rule
+// ---------------------------------------------------------------------------
+static const float WARN_CM = 45.0f;
+static const uint8_t CONSECUTIVE_HOURS = Notification::CONSECUTIVE_LOW_THRESHOLD;
+static const uint32_t HOURS = 120 * 24;
+
+// True distance: salt used at 0.5 cm/day, refilled every 50 days
+static float trueLevel(uint32_t hour) {
+    return 30.0f + 0.5f * ((hour % (50 * 24)) / 24.0f);
+}
+
+// One burst: the median of three pings (what readDistanceCm() returned).
+// Pings see 0.5 cm of noise and the odd condensation (short) or multipath
+// (long) echo, which the median takes care of. On humid mornings a droplet
+// on the transducer can spoil a whole burst, which it cannot; on some cold
+// nights a film of condensation makes every burst read long for hours.
+static float burst(uint32_t hour, bool humidMorning, uint32_t fogUntil) {
+    float level = trueLevel(hour);
+    if (hour < fogUntil) {
+        return level + 12.0f + noise(1.0f);
+    }
+    if (humidMorning && hour % 24 >= 5 && hour % 24 < 9 && uniform() < 0.3f) {
+        return level + 8.0f + 12.0f * uniform();
+    }
+    float pings[3];
+    for (int i = 0; i < 3; i++) {
+        float u = uniform();
+        if (u < 0.02f) {
+            pings[i] = 5.0f + 20.0f * uniform();
+        } else if (u < 0.04f) {
+            pings[i] = level + 10.0f + 20.0f * uniform();
+        } else {
+            pings[i] = level + noise(0.5f);
+        }
+    }
+    return medianOfReadings(pings, 3);
+}
+
+struct ReplayStats {
+    uint32_t falseLow;        // Counted low while the level was clearly OK
+    uint32_t falseOk;         // Counted OK while clearly low (resets the count)
+    uint32_t falseAlerts;     // Alerts raised while the level was clearly OK
+    uint32_t alerts;
+    uint32_t worstDelayH;     // Longest wait from a real crossing to its first alert
+};
+
+static ReplayStats replay(const LevelFilterConfig& cfg) {
+    lcgState = 7;
+    LevelEstimator est;
+    est.configure(cfg);
+
+    ReplayStats s = { 0, 0, 0, 0, 0 };
+    // As handleNotifications(): a warning needs CONSECUTIVE_HOURS low
+    // readings in a row and is re-armed by as many OK ones
+    uint8_t consecutiveLow = 0;
+    uint8_t consecutiveOk = 0;
+    bool warned = false;
+    bool humidMorning = false;
+    uint32_t fogUntil = 0;
+    uint32_t crossedAt = 0;
+    bool crossed = false;
+    bool alertedSinceCrossing = false;
+
+    for (uint32_t h = 0; h < HOURS; h++) {
+        if (h % 24 == 0) {
+            humidMorning = uniform() < 0.3f;
+        }
+        // A film from 22:00 lasting 6-12 hours, one night in five
+        if (h % 24 == 22 && uniform() < 0.2f) {
+            fogUntil = h + 6 + static_cast<uint32_t>(7.0f * uniform());
+        }
+        float truth = trueLevel(h);
+        float distance = est.update(burst(h, humidMorning, fogUntil), 1.0f);
+
+        if (truth >= WARN_CM && !crossed) {
+            crossed = true;
+            crossedAt = h;
+            alertedSinceCrossing = false;
+        }
+        if (truth < WARN_CM) {
+            crossed = false;
+        }
+
+        bool low = distance >= WARN_CM;
+        if (low && truth < WARN_CM - 1.0f) s.falseLow++;
+        if (!low && truth >= WARN_CM + 1.0f) s.falseOk++;
+
+        if (low) {
+            consecutiveOk = 0;
+            if (consecutiveLow < 255) consecutiveLow++;
+            if (!warned && consecutiveLow >= CONSECUTIVE_HOURS) {
+                warned = true;
+                s.alerts++;
+                if (truth < WARN_CM - 1.0f) {
+                    s.falseAlerts++;
+                }
+                if (crossed && !alertedSinceCrossing) {
+                    alertedSinceCrossing = true;
+                    if (h - crossedAt > s.worstDelayH) {
+                        s.worstDelayH = h - crossedAt;
+                    }
+                }
+            }
+        } else {
+            consecutiveLow = 0;
+            if (consecutiveOk < 255) consecutiveOk++;
+            if (consecutiveOk >= CONSECUTIVE_HOURS) {
+                warned = false;
+            }
+        }
+    }
+    return s;
+}
+
+static void report(const char* name, const ReplayStats& s) {
+    char line[200];
+    snprintf(line, sizeof(line),
+             "%-13s false low %3u h, false OK %3u h, alerts %u (%u false), worst delay %u h",
+             name, static_cast<unsigned>(s.falseLow), static_cast<unsigned>(s.falseOk),
+             static_cast<unsigned>(s.alerts), static_cast<unsigned>(s.falseAlerts),
+             static_cast<unsigned>(s.worstDelayH));
+    TEST_MESSAGE(line);
+}
+
+static void test_replay_false_alert_rate(void) {
+    ReplayStats median = replay(NONE);
+    ReplayStats kalman = replay(KALMAN);
+    ReplayStats hampel = replay(HAMPEL);
+    ReplayStats chosen = replay(DEFAULT_FILTER);
+    report("median-of-3", median);
+    report("kalman", kalman);
+    report("hampel", hampel);
+
+    // The trace has to provoke the raw readings, or this proves nothing
+    TEST_ASSERT_GREATER_THAN(0, median.falseAlerts);
+
+    // The filter the firmware ships with has to earn its place. A night of
+    // condensation outlasts the alert threshold and the Hampel window
+    // alike (Hampel even holds the long distance a few readings after the
+    // film clears, so it is not asserted on here); only the Kalman
+    // filter's slow acceptance of a longer distance keeps it out.
+    TEST_ASSERT_LESS_THAN(median.falseAlerts, chosen.falseAlerts);
+    TEST_ASSERT_EQUAL_UINT32(0, kalman.falseAlerts);
+    TEST_ASSERT_LESS_THAN(median.falseLow, kalman.falseLow);
+    TEST_ASSERT_LESS_OR_EQUAL(median.falseOk, kalman.falseOk);
+
+    // Real crossings still alert, and not later than without a filter
+    TEST_ASSERT_GREATER_OR_EQUAL(2, kalman.alerts);
+    TEST_ASSERT_GREATER_OR_EQUAL(2, hampel.alerts);
+    TEST_ASSERT_LESS_OR_EQUAL(median.worstDelayH, kalman.worstDelayH);
+    TEST_ASSERT_LESS_OR_EQUAL(median.worstDelayH, hampel.worstDelayH);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_none_passes_readings_through);
+    RUN_TEST(test_kalman_smooths_noise);
+    RUN_TEST(test_kalman_gates_single_outlier);
+    RUN_TEST(test_kalman_follows_refill);
+    RUN_TEST(test_kalman_scattered_rejects_do_not_reinit);
+    RUN_TEST(test_kalman_longer_distance_must_persist);
+    RUN_TEST(test_kalman_long_gap_widens_gate);
+    RUN_TEST(test_hampel_replaces_spike_with_median);
+    RUN_TEST(test_hampel_follows_lasting_step);
+    RUN_TEST(test_hampel_window_is_clamped);
+    RUN_TEST(test_reconfigure_restarts_filter);
+    RUN_TEST(test_replay_false_alert_rate);
+    return UNITY_END();
+}
@@ -0,0 +1,158 @@
+#include <unity.h>
+#include <vector>
+#include "history/lttb.h"
+
+static const uint32_t T0 = 1704067200UL;   // 2024-01-01
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Run the downsampler the way /api/history does: pop after every add
+static std::vector<LttbPoint> downsample(const std::vector<LttbPoint>& in,
+                                         uint32_t from, uint32_t to, size_t points) {
+    LttbDownsampler lttb;
+    std::vector<LttbPoint> out;
+    LttbPoint p;
+    lttb.begin(from, to, points);
+    for (size_t i = 0; i < in.size(); i++) {
+        lttb.add(in[i].timestamp, in[i].value);
+        while (lttb.pop(p)) out.push_back(p);
+    }
+    lttb.finish();
+    while (lttb.pop(p)) out.push_back(p);
+    return out;
+}
+
+// Hourly distance over a year: rising ~2 cm a day, refilled every 6 weeks
+static std::vector<LttbPoint> sawtooth() {
+    std::vector<LttbPoint> out;
+    for (uint32_t h = 0; h < 365 * 24; h++) {
+        uint32_t sinceRefill = h % (42 * 24);
+        LttbPoint p = { T0 + h * 3600, 15.0f + sinceRefill / 12.0f + ((h * 7919) % 5) * 0.1f };
+        out.push_back(p);
+    }
+    return out;
+}
+
+static void test_first_and_last_kept_in_order(void) {
+    std::vector<LttbPoint> in = sawtooth();
+    std::vector<LttbPoint> out = downsample(in, in.front().timestamp, in.back().timestamp, 200);
+
+    TEST_ASSERT_GREATER_THAN(150, out.size());
+    TEST_ASSERT_LESS_OR_EQUAL(200, out.size());
+    TEST_ASSERT_EQUAL_UINT32(in.front().timestamp, out.front().timestamp);
+    TEST_ASSERT_EQUAL_UINT32(in.back().timestamp, out.back().timestamp);
+    for (size_t i = 1; i < out.size(); i++) {
+        TEST_ASSERT_GREATER_THAN(out[i - 1].timestamp, out[i].timestamp);
+    }
+}
+
+static void test_points_are_input_samples(void) {
+    std::vector<LttbPoint> in = sawtooth();
+    std::vector<LttbPoint> out = downsample(in, in.front().timestamp, in.back().timestamp, 100);
+    for (size_t i = 0; i < out.size(); i++) {
+        size_t index = (out[i].timestamp - T0) / 3600;
+        TEST_ASSERT_EQUAL_UINT32(in[index].timestamp, out[i].timestamp);
+        TEST_ASSERT_EQUAL_FLOAT(in[index].value, out[i].value);
+    }
+}
+
+static void test_refills_survive(void) {
+    // Every refill drops the distance from its peak back to ~15 cm. The
+    // points kept around it must span (nearly) the whole drop; averaging
+    // each bucket would cut it down.
+    std::vector<LttbPoint> in = sawtooth();
+    std::vector<LttbPoint> out = downsample(in, in.front().timestamp, in.back().timestamp, 200);
+
+    for (uint32_t refill = 42 * 24; refill < in.size(); refill += 42 * 24) {
+        float drop = in[refill - 1].value - in[refill].value;
+        float nearPeak = 0.0f;
+        float nearTrough = 1e9f;
+        for (size_t i = 0; i < out.size(); i++) {
+            uint32_t hour = (out[i].timestamp - T0) / 3600;
+            if (hour + 24 * 4 >= refill && hour < refill + 24 * 4) {
+                if (out[i].value > nearPeak) nearPeak = out[i].value;
+                if (out[i].value < nearTrough) nearTrough = out[i].value;
+            }
+        }
+        TEST_ASSERT_GREATER_THAN_FLOAT(0.9f * drop, nearPeak - nearTrough);
+    }
+}
+
+static void test_isolated_spike_is_kept(void) {
+    std::vector<LttbPoint> in;
+    for (uint32_t i = 0; i < 1000; i++) {
+        LttbPoint p = { T0 + i * 60, i == 537 ? 5.0f : 40.0f };
+        in.push_back(p);
+    }
+    std::vector<LttbPoint> out = downsample(in, T0, T0 + 999 * 60, 20);
+    bool found = false;
+    for (size_t i = 0; i < out.size(); i++) {
+        if (out[i].timestamp == T0 + 537 * 60) {
+            TEST_ASSERT_EQUAL_FLOAT(5.0f, out[i].value);
+            found = true;
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+}
+
+static void test_fewer_samples_than_points(void) {
+    std::vector<LttbPoint> in;
+    for (uint32_t i = 0; i < 5; i++) {
+        LttbPoint p = { T0 + i * 86400, static_cast<float>(i) };
+        in.push_back(p);
+    }
+    std::vector<LttbPoint> out = downsample(in, T0, T0 + 4 * 86400, 100);
+    TEST_ASSERT_EQUAL_size_t(5, out.size());
+    for (size_t i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_UINT32(in[i].timestamp, out[i].timestamp);
+    }
+}
+
+static void test_empty_buckets_yield_nothing(void) {
+    // Two clusters at the ends of the range, a gap in between
+    std::vector<LttbPoint> in;
+    for (uint32_t i = 0; i < 50; i++) {
+        LttbPoint p = { T0 + i * 60, 20.0f + i % 3 };
+        in.push_back(p);
+    }
+    for (uint32_t i = 0; i < 50; i++) {
+        LttbPoint p = { T0 + 30 * 86400 + i * 60, 30.0f + i % 3 };
+        in.push_back(p);
+    }
+    std::vector<LttbPoint> out = downsample(in, T0, T0 + 31 * 86400, 100);
+    TEST_ASSERT_LESS_OR_EQUAL(10, out.size());
+    TEST_ASSERT_EQUAL_UINT32(in.front().timestamp, out.front().timestamp);
+    TEST_ASSERT_EQUAL_UINT32(in.back().timestamp, out.back().timestamp);
+}
+
+static void test_degenerate_input(void) {
+    std::vector<LttbPoint> none;
+    TEST_ASSERT_EQUAL_size_t(0, downsample(none, T0, T0 + 3600, 10).size());
+
+    std::vector<LttbPoint> one(1);
+    one[0].timestamp = T0;
+    one[0].value = 12.5f;
+    std::vector<LttbPoint> out = downsample(one, T0, T0 + 3600, 10);
+    TEST_ASSERT_EQUAL_size_t(1, out.size());
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, out[0].value);
+
+    // The whole 32-bit range (span wraps to 0)
+    std::vector<LttbPoint> in = sawtooth();
+    out = downsample(in, 0, 0xFFFFFFFFUL, 50);
+    TEST_ASSERT_GREATER_THAN(1, out.size());
+    TEST_ASSERT_EQUAL_UINT32(in.back().timestamp, out.back().timestamp);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_and_last_kept_in_order);
+    RUN_TEST(test_points_are_input_samples);
+    RUN_TEST(test_refills_survive);
+    RUN_TEST(test_isolated_spike_is_kept);
+    RUN_TEST(test_fewer_samples_than_points);
+    RUN_TEST(test_empty_buckets_yield_nothing);
+    RUN_TEST(test_degenerate_input);
+    return UNITY_END();
+}
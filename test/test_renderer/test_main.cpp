@@ -0,0 +1,162 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include "ota/renderer.h"
+
+using saltlevel::TemplateRenderer;
+
+// Heap use of the code under test (the renderer itself must not allocate)
+static size_t heapBytes = 0;
+static size_t heapPeak = 0;
+
+void* operator new(size_t size) {
+    heapBytes += size;
+    if (heapBytes > heapPeak) heapPeak = heapBytes;
+    size_t* p = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+    if (!p) throw std::bad_alloc();
+    *p = size;
+    return p + 1;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    size_t* p = static_cast<size_t*>(ptr) - 1;
+    heapBytes -= *p;
+    free(p);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+static const char* lookup(const char* key, size_t keyLen, void* ctx) {
+    (void)ctx;
+    static const struct { const char* key; const char* value; } TABLE[] = {
+        { "TITLE", "Salt Level" },
+        { "LONG",  "a replacement that is longer than the read buffer" },
+        { "EMPTY", "" },
+    };
+    for (size_t i = 0; i < sizeof(TABLE) / sizeof(TABLE[0]); i++) {
+        if (strncmp(TABLE[i].key, key, keyLen) == 0 && TABLE[i].key[keyLen] == '\0') {
+            return TABLE[i].value;
+        }
+    }
+    return nullptr;
+}
+
+static std::string render(const char* tmpl, size_t chunk) {
+    TemplateRenderer renderer(tmpl, strlen(tmpl), lookup, nullptr);
+    std::string out;
+    char buf[64];
+    size_t n;
+    while ((n = renderer.read(buf, chunk)) > 0) {
+        out.append(buf, n);
+    }
+    TEST_ASSERT_TRUE(renderer.done());
+    return out;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_substitutes_placeholders(void) {
+    TEST_ASSERT_EQUAL_STRING("<title>Salt Level</title>", render("<title>{{TITLE}}</title>", 64).c_str());
+    TEST_ASSERT_EQUAL_STRING("[]", render("[{{EMPTY}}]", 64).c_str());
+}
+
+static void test_unknown_and_partial_placeholders_pass_through(void) {
+    TEST_ASSERT_EQUAL_STRING("{{NOPE}}", render("{{NOPE}}", 64).c_str());
+    TEST_ASSERT_EQUAL_STRING("a {{TITLE", render("a {{TITLE", 64).c_str());
+    TEST_ASSERT_EQUAL_STRING("{}", render("{}", 64).c_str());
+}
+
+static void test_css_and_js_braces_are_kept(void) {
+    const char* css = "h1{color:red}function f(){return {a:1};}{{TITLE}}";
+    TEST_ASSERT_EQUAL_STRING("h1{color:red}function f(){return {a:1};}Salt Level",
+                             render(css, 64).c_str());
+}
+
+static void test_key_longer_than_limit_is_not_looked_up(void) {
+    std::string key(TemplateRenderer::MAX_KEY_LENGTH + 1, 'K');
+    std::string tmpl = "{{" + key + "}}";
+    TEST_ASSERT_EQUAL_STRING(tmpl.c_str(), render(tmpl.c_str(), 64).c_str());
+}
+
+static void test_output_is_independent_of_chunk_size(void) {
+    const char* tmpl = "<p>{{LONG}}</p>{{TITLE}}{x}{{EMPTY}}{{TITLE}}";
+    std::string whole = render(tmpl, 64);
+    TEST_ASSERT_EQUAL_STRING(
+        "<p>a replacement that is longer than the read buffer</p>Salt Level{x}Salt Level",
+        whole.c_str());
+    for (size_t chunk = 1; chunk < 16; chunk++) {
+        TEST_ASSERT_EQUAL_STRING(whole.c_str(), render(tmpl, chunk).c_str());
+    }
+}
+
+// Render time and heap of a page the size of the UI template, against the
+// old approach of copying the template into a string and replacing in place
+static void test_benchmark_against_materialized_page(void) {
+    std::string tmpl;
+    while (tmpl.size() < 11000) {
+        tmpl += "<div class=\"row\"><label>{{TITLE}}</label><input name=\"x\"></div>\n";
+        tmpl += ".card{padding:8px}{{LONG}}\n";
+    }
+    const int rounds = 2000;
+
+    heapPeak = heapBytes;
+    size_t base = heapBytes;
+    size_t streamed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        TemplateRenderer renderer(tmpl.data(), tmpl.size(), lookup, nullptr);
+        char buf[1460];   // One TCP segment
+        size_t n;
+        while ((n = renderer.read(buf, sizeof(buf))) > 0) {
+            streamed += n;
+        }
+    }
+    double streamSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t streamHeap = heapPeak - base;
+
+    heapPeak = heapBytes;
+    size_t materialized = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        std::string page(tmpl);
+        static const char* KEYS[] = { "{{TITLE}}", "{{LONG}}" };
+        for (const char* key : KEYS) {
+            const char* value = lookup(key + 2, strlen(key) - 4, nullptr);
+            size_t at;
+            while ((at = page.find(key)) != std::string::npos) {
+                page.replace(at, strlen(key), value);
+            }
+        }
+        materialized += page.size();
+    }
+    double materializedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t materializedHeap = heapPeak - base;
+
+    TEST_ASSERT_EQUAL_size_t(materialized, streamed);
+    TEST_ASSERT_EQUAL_size_t(0, streamHeap);
+
+    char line[160];
+    snprintf(line, sizeof(line), "streamed: %.1f MB/s, peak heap %zu B; materialized: %.1f MB/s, peak heap %zu B",
+             streamed / streamSeconds / 1e6, streamHeap,
+             materialized / materializedSeconds / 1e6, materializedHeap);
+    TEST_MESSAGE(line);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_substitutes_placeholders);
+    RUN_TEST(test_unknown_and_partial_placeholders_pass_through);
+    RUN_TEST(test_css_and_js_braces_are_kept);
+    RUN_TEST(test_key_longer_than_limit_is_not_looked_up);
+    RUN_TEST(test_output_is_independent_of_chunk_size);
+    RUN_TEST(test_benchmark_against_materialized_page);
+    return UNITY_END();
+}
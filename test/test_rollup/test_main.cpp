@@ -0,0 +1,139 @@
+#include <unity.h>
+#include <cmath>
+#include "history/rollup.h"
+
+static const uint32_t HOUR = 3600;
+static const uint32_t WEEK = 604800;
+static const uint32_t MONDAY = 345600;   // 1970-01-05, as HistoryStore aligns weeks
+static const uint32_t T0 = 1704067200UL; // 2024-01-01 00:00 UTC, a Monday
+
+static RollupBucket storage[4];
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_welford_matches_two_pass(void) {
+    RollupTier tier(HOUR, 0, storage, 4);
+    const int16_t values[] = { 412, 418, 409, 430, 415, 411 };
+    const size_t n = sizeof(values) / sizeof(values[0]);
+    for (size_t i = 0; i < n; i++) {
+        tier.add(T0 + i * 60, values[i]);
+    }
+
+    double mean = 0;
+    for (size_t i = 0; i < n; i++) mean += values[i];
+    mean /= n;
+    double ss = 0;
+    for (size_t i = 0; i < n; i++) ss += (values[i] - mean) * (values[i] - mean);
+
+    RollupBucket b;
+    TEST_ASSERT_EQUAL_size_t(1, tier.read(0, 0xFFFFFFFFUL, &b, 1));
+    TEST_ASSERT_EQUAL_UINT32(T0, b.start);
+    TEST_ASSERT_EQUAL_UINT16(n, b.count);
+    TEST_ASSERT_EQUAL_INT(409, b.minMm);
+    TEST_ASSERT_EQUAL_INT(430, b.maxMm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, static_cast<float>(mean), b.meanMm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, static_cast<float>(std::sqrt(ss / (n - 1))), b.stddevMm());
+}
+
+static void test_single_reading_has_no_spread(void) {
+    RollupTier tier(HOUR, 0, storage, 4);
+    tier.add(T0 + 10, 500);
+    RollupBucket b;
+    TEST_ASSERT_EQUAL_size_t(1, tier.read(T0, T0, &b, 1));
+    TEST_ASSERT_EQUAL_FLOAT(500.0f, b.meanMm);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, b.stddevMm());
+}
+
+static void test_buckets_are_aligned(void) {
+    RollupTier weeks(WEEK, MONDAY, storage, 4);
+    weeks.add(T0 + 3 * 86400 + 5, 100);   // Thursday
+    weeks.add(T0 + 7 * 86400, 110);       // Next Monday, midnight: new bucket
+    RollupBucket b[2];
+    TEST_ASSERT_EQUAL_size_t(2, weeks.read(0, 0xFFFFFFFFUL, b, 2));
+    TEST_ASSERT_EQUAL_UINT32(T0, b[0].start);
+    TEST_ASSERT_EQUAL_UINT32(T0 + WEEK, b[1].start);
+}
+
+static void test_ring_recycles_oldest(void) {
+    RollupTier tier(HOUR, 0, storage, 4);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFUL, tier.oldestStart());
+    for (uint32_t h = 0; h < 6; h++) {
+        tier.add(T0 + h * HOUR, static_cast<int16_t>(100 + h));
+    }
+    TEST_ASSERT_EQUAL_UINT32(T0 + 2 * HOUR, tier.oldestStart());
+
+    RollupBucket b[8];
+    TEST_ASSERT_EQUAL_size_t(4, tier.read(0, 0xFFFFFFFFUL, b, 8));
+    for (size_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT32(T0 + (i + 2) * HOUR, b[i].start);
+        TEST_ASSERT_EQUAL_INT(102 + i, b[i].minMm);
+    }
+
+    // Older than the ring: dropped
+    tier.add(T0, 999);
+    TEST_ASSERT_EQUAL_size_t(4, tier.read(0, 0xFFFFFFFFUL, b, 8));
+    TEST_ASSERT_EQUAL_INT(102, b[0].maxMm);
+}
+
+static void test_late_reading_folds_into_its_bucket(void) {
+    // After a clock step back a reading can land in an older bucket still
+    // held; one falling into a gap between buckets is dropped
+    RollupTier tier(HOUR, 0, storage, 4);
+    tier.add(T0, 100);
+    tier.add(T0 + 3 * HOUR, 130);
+    tier.add(T0 + 30, 110);
+    tier.add(T0 + HOUR + 30, 999);
+
+    RollupBucket b[4];
+    TEST_ASSERT_EQUAL_size_t(2, tier.read(0, 0xFFFFFFFFUL, b, 4));
+    TEST_ASSERT_EQUAL_UINT16(2, b[0].count);
+    TEST_ASSERT_EQUAL_FLOAT(105.0f, b[0].meanMm);
+    TEST_ASSERT_EQUAL_UINT16(1, b[1].count);
+}
+
+static void test_read_range_and_paging(void) {
+    RollupTier tier(HOUR, 0, storage, 4);
+    for (uint32_t h = 0; h < 4; h++) {
+        tier.add(T0 + h * HOUR + 600, 100);
+    }
+    RollupBucket b[4];
+
+    // Buckets overlapping [from, to], not just starting in it
+    TEST_ASSERT_EQUAL_size_t(2, tier.read(T0 + HOUR + 1800, T0 + 2 * HOUR, b, 4));
+    TEST_ASSERT_EQUAL_UINT32(T0 + HOUR, b[0].start);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 2 * HOUR, b[1].start);
+
+    // Paging with from = last.start + width() visits each bucket once
+    uint32_t from = 0;
+    size_t seen = 0;
+    size_t n;
+    while ((n = tier.read(from, 0xFFFFFFFFUL, b, 1)) > 0) {
+        TEST_ASSERT_EQUAL_UINT32(T0 + seen * HOUR, b[0].start);
+        seen++;
+        from = b[0].start + tier.width();
+    }
+    TEST_ASSERT_EQUAL_size_t(4, seen);
+}
+
+static void test_clear(void) {
+    RollupTier tier(HOUR, 0, storage, 4);
+    tier.add(T0, 100);
+    tier.clear();
+    RollupBucket b;
+    TEST_ASSERT_EQUAL_size_t(0, tier.read(0, 0xFFFFFFFFUL, &b, 1));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFUL, tier.oldestStart());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_welford_matches_two_pass);
+    RUN_TEST(test_single_reading_has_no_spread);
+    RUN_TEST(test_buckets_are_aligned);
+    RUN_TEST(test_ring_recycles_oldest);
+    RUN_TEST(test_late_reading_folds_into_its_bucket);
+    RUN_TEST(test_read_range_and_paging);
+    RUN_TEST(test_clear);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+#include <unity.h>
+#include "measurement/scheduler.h"
+#include "constants.h"
+
+static const uint32_t MIN_MS = 60000UL;
+static const uint32_t MAX_MS = 3600000UL;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_starts_at_the_hourly_interval(void) {
+    IntervalScheduler s;
+    TEST_ASSERT_EQUAL_UINT32(Timing::MEASURE_INTERVAL_MS, s.interval());
+    s.setBounds(MIN_MS, MAX_MS);
+    TEST_ASSERT_EQUAL_UINT32(MAX_MS, s.update(40.0f));
+    TEST_ASSERT_EQUAL_UINT32(MAX_MS, s.update(40.2f));
+}
+
+static void test_change_drops_to_minimum(void) {
+    IntervalScheduler s;
+    s.setBounds(MIN_MS, MAX_MS);
+    s.update(40.0f);
+
+    // Just under the threshold is still quiet
+    TEST_ASSERT_EQUAL_UINT32(MAX_MS, s.update(40.0f + Sensor::ADAPTIVE_CHANGE_CM * 0.9f));
+
+    // Measured from the previous reading, not the first: a drop...
+    TEST_ASSERT_EQUAL_UINT32(MIN_MS, s.update(40.0f - Sensor::ADAPTIVE_CHANGE_CM * 0.2f));
+
+    // ...or a rise of exactly the threshold
+    IntervalScheduler up;
+    up.setBounds(MIN_MS, MAX_MS);
+    up.update(30.0f);
+    TEST_ASSERT_EQUAL_UINT32(MIN_MS, up.update(30.0f + Sensor::ADAPTIVE_CHANGE_CM));
+}
+
+static void test_quiet_readings_double_up_to_maximum(void) {
+    IntervalScheduler s;
+    s.setBounds(MIN_MS, MAX_MS);
+    s.update(40.0f);
+    TEST_ASSERT_EQUAL_UINT32(MIN_MS, s.update(30.0f));
+
+    uint32_t expected = MIN_MS;
+    while (expected < MAX_MS) {
+        expected = expected * 2 > MAX_MS ? MAX_MS : expected * 2;
+        TEST_ASSERT_EQUAL_UINT32(expected, s.update(30.0f));
+    }
+    TEST_ASSERT_EQUAL_UINT32(MAX_MS, s.update(30.0f));
+    TEST_ASSERT_EQUAL_UINT32(MAX_MS, s.interval());
+}
+
+static void test_no_overflow_near_uint32_max(void) {
+    // Doubling must saturate rather than wrap
+    IntervalScheduler s;
+    s.setBounds(MIN_MS, 0xFFFFFFF0UL);
+    s.update(40.0f);
+    uint32_t last = 0;
+    for (int i = 0; i < 40; i++) {
+        uint32_t next = s.update(40.0f);
+        TEST_ASSERT_TRUE(next >= last);
+        last = next;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFF0UL, last);
+}
+
+static void test_set_bounds_clamps(void) {
+    IntervalScheduler s;
+    s.setBounds(MIN_MS, MAX_MS);
+    s.update(40.0f);
+    s.update(30.0f);
+    TEST_ASSERT_EQUAL_UINT32(MIN_MS, s.interval());
+
+    // A higher minimum lifts the current interval
+    s.setBounds(5 * MIN_MS, MAX_MS);
+    TEST_ASSERT_EQUAL_UINT32(5 * MIN_MS, s.interval());
+    TEST_ASSERT_EQUAL_UINT32(5 * MIN_MS, s.update(20.0f));
+
+    // A lower maximum caps it
+    s.update(20.0f);
+    s.update(20.0f);
+    s.setBounds(MIN_MS, 8 * MIN_MS);
+    TEST_ASSERT_EQUAL_UINT32(8 * MIN_MS, s.interval());
+
+    // A maximum below the minimum is raised to it
+    s.setBounds(10 * MIN_MS, MIN_MS);
+    TEST_ASSERT_EQUAL_UINT32(10 * MIN_MS, s.interval());
+    TEST_ASSERT_EQUAL_UINT32(10 * MIN_MS, s.update(20.0f));
+    TEST_ASSERT_EQUAL_UINT32(10 * MIN_MS, s.update(0.0f));
+}
+
+static void test_failed_burst_changes_nothing(void) {
+    IntervalScheduler s;
+    s.setBounds(MIN_MS, MAX_MS);
+    s.update(40.0f);
+    s.update(30.0f);
+    TEST_ASSERT_EQUAL_UINT32(2 * MIN_MS, s.update(30.0f));
+
+    // Neither backs off nor counts as a change
+    TEST_ASSERT_EQUAL_UINT32(2 * MIN_MS, s.update(-1.0f));
+    TEST_ASSERT_EQUAL_UINT32(2 * MIN_MS, s.update(-1.0f));
+    TEST_ASSERT_EQUAL_UINT32(4 * MIN_MS, s.update(30.0f));
+
+    // The next good reading is compared with the last good one
+    s.update(-1.0f);
+    TEST_ASSERT_EQUAL_UINT32(MIN_MS, s.update(35.0f));
+
+    // Failures before any reading: no change is seen on the first one
+    IntervalScheduler fresh;
+    fresh.setBounds(MIN_MS, MAX_MS);
+    fresh.update(-1.0f);
+    TEST_ASSERT_EQUAL_UINT32(MAX_MS, fresh.update(12.0f));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_at_the_hourly_interval);
+    RUN_TEST(test_change_drops_to_minimum);
+    RUN_TEST(test_quiet_readings_double_up_to_maximum);
+    RUN_TEST(test_no_overflow_near_uint32_max);
+    RUN_TEST(test_set_bounds_clamps);
+    RUN_TEST(test_failed_burst_changes_nothing);
+    return UNITY_END();
+}
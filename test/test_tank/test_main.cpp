@@ -0,0 +1,240 @@
+#include <unity.h>
+#include <cmath>
+#include "analysis/tank.h"
+
+static const float PI_F = 3.14159265f;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// 10 cm (full) to 70 cm (empty) from the sensor: 60 cm of fill height
+static TankGeometry geometry(TankShape shape, float dim1, float dim2) {
+    TankGeometry g = {};
+    g.shape             = shape;
+    g.fullCm            = 10.0f;
+    g.emptyCm           = 70.0f;
+    g.dim1Cm            = dim1;
+    g.dim2Cm            = dim2;
+    g.saltDensityKgPerL = Tank::DEFAULT_SALT_DENSITY_KG_PER_L;
+    return g;
+}
+
+// Level at `fill` (0-1) of the height above empty
+static TankLevel levelAt(const TankModel& model, float fill) {
+    TankLevel out;
+    model.convert(70.0f - 60.0f * fill, out);
+    return out;
+}
+
+static void test_rectangular_is_linear(void) {
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::RECTANGULAR, 40.0f, 50.0f)));
+
+    TankLevel level = levelAt(model, 0.5f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, level.percent);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 40.0f * 50.0f * 30.0f / 1000.0f, level.liters);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 60.0f * Tank::DEFAULT_SALT_DENSITY_KG_PER_L, level.saltKg);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.5f, levelAt(model, 0.125f).percent);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, levelAt(model, 1.0f).percent);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, levelAt(model, 0.0f).percent);
+}
+
+static void test_vertical_cylinder_volume(void) {
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::VERTICAL_CYLINDER, 40.0f, 0.0f)));
+    float liters = PI_F * 20.0f * 20.0f * 60.0f / 1000.0f;
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, liters, levelAt(model, 1.0f).liters);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, liters / 4.0f, levelAt(model, 0.25f).liters);
+}
+
+static void test_horizontal_cylinder_segments(void) {
+    // Diameter equal to the fill height, 100 cm long
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::HORIZONTAL_CYLINDER, 60.0f, 100.0f)));
+
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 50.0f, levelAt(model, 0.5f).percent);
+
+    // Circular segment a quarter of the diameter deep: (theta - sin theta) / 2 pi
+    float theta = 2.0f * std::acos(0.5f);
+    float quarter = (theta - std::sin(theta)) / (2.0f * PI_F) * 100.0f;
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, quarter, levelAt(model, 0.25f).percent);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 100.0f - quarter, levelAt(model, 0.75f).percent);
+
+    float liters = PI_F * 30.0f * 30.0f * 100.0f / 1000.0f;
+    TEST_ASSERT_FLOAT_WITHIN(liters * 0.001f, liters, levelAt(model, 1.0f).liters);
+}
+
+static void test_cone_frustum_volume(void) {
+    // 30 cm across at the bottom, 50 cm at the top
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::CONE, 30.0f, 50.0f)));
+    float liters = PI_F * 60.0f / 12.0f * (30.0f * 30.0f + 30.0f * 50.0f + 50.0f * 50.0f) / 1000.0f;
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, liters, levelAt(model, 1.0f).liters);
+
+    // Narrow at the bottom: half the height holds less than half the salt
+    TEST_ASSERT_TRUE(levelAt(model, 0.5f).percent < 45.0f);
+}
+
+static void test_profile_volume(void) {
+    TankGeometry g = geometry(TankShape::PROFILE, 0.0f, 0.0f);
+    g.profilePoints = static_cast<uint8_t>(parseTankProfile("0:1000,60:3000", g.profile, Tank::MAX_PROFILE_POINTS));
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(g));
+
+    // Mean area 2000 cm2 over 60 cm; the lower half holds (1000 + 2000) / 2 x 30
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 120.0f, levelAt(model, 1.0f).liters);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 45.0f, levelAt(model, 0.5f).liters);
+}
+
+static void test_unknown_dimensions_give_percent_only(void) {
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::RECTANGULAR, 0.0f, 0.0f)));
+    TankLevel level = levelAt(model, 0.5f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, level.percent);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.liters);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.saltKg);
+
+    // A horizontal cylinder without a diameter spans the fill range
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::HORIZONTAL_CYLINDER, 0.0f, 0.0f)));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 50.0f, levelAt(model, 0.5f).percent);
+    TEST_ASSERT_TRUE(levelAt(model, 0.25f).percent < 22.0f);
+}
+
+static void test_clamps_outside_the_fill_range(void) {
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::RECTANGULAR, 40.0f, 50.0f)));
+    TankLevel level;
+    model.convert(95.0f, level);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, level.percent);
+    model.convert(2.0f, level);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 100.0f, level.percent);
+
+    // A failed reading
+    model.convert(-1.0f, level);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.percent);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.liters);
+}
+
+static void test_invalid_geometry(void) {
+    TankModel model;
+    TankGeometry g = geometry(TankShape::RECTANGULAR, 40.0f, 50.0f);
+    g.fullCm = g.emptyCm;
+    TEST_ASSERT_FALSE(model.build(g));
+
+    TankLevel level;
+    model.convert(40.0f, level);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.percent);
+    float table[Tank::LUT_POINTS];
+    TEST_ASSERT_FALSE(model.percentTable(table));
+
+    // A profile needs two points
+    TankGeometry p = geometry(TankShape::PROFILE, 0.0f, 0.0f);
+    p.profilePoints = 1;
+    p.profile[0].heightCm = 0.0f;
+    p.profile[0].areaCm2 = 1000.0f;
+    TEST_ASSERT_FALSE(model.build(p));
+
+    // NaN dimensions from a bad config
+    g = geometry(TankShape::RECTANGULAR, 40.0f, 50.0f);
+    g.emptyCm = NAN;
+    TEST_ASSERT_FALSE(model.build(g));
+}
+
+static void test_percent_table(void) {
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::HORIZONTAL_CYLINDER, 60.0f, 100.0f)));
+    float table[Tank::LUT_POINTS];
+    TEST_ASSERT_TRUE(model.percentTable(table));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, table[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 100.0f, table[Tank::LUT_POINTS - 1]);
+    for (int i = 1; i < Tank::LUT_POINTS; i++) {
+        TEST_ASSERT_TRUE(table[i] > table[i - 1]);
+    }
+}
+
+static void test_shared_models(void) {
+    // Tank 1 is never published here
+    TankLevel level;
+    tankLevel(1, 40.0f, level);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.percent);
+    float table[Tank::LUT_POINTS];
+    TEST_ASSERT_FALSE(tankPercentTable(1, table));
+
+    TankModel model;
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::RECTANGULAR, 40.0f, 50.0f)));
+    tankSetModel(0, model);
+    tankLevel(0, 40.0f, level);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, level.percent);
+    TEST_ASSERT_TRUE(tankPercentTable(0, table));
+
+    // Republishing replaces it
+    TEST_ASSERT_TRUE(model.build(geometry(TankShape::CONE, 30.0f, 50.0f)));
+    tankSetModel(0, model);
+    tankLevel(0, 40.0f, level);
+    TEST_ASSERT_TRUE(level.percent < 45.0f);
+
+    // A tank whose sensor was removed gets an empty model
+    tankSetModel(0, TankModel());
+    tankLevel(0, 40.0f, level);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.percent);
+    TEST_ASSERT_FALSE(tankPercentTable(0, table));
+
+    // Out of range
+    tankSetModel(Tank::MAX_TANKS, model);
+    tankLevel(Tank::MAX_TANKS, 40.0f, level);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, level.percent);
+}
+
+static void test_parse_profile(void) {
+    TankProfilePoint points[Tank::MAX_PROFILE_POINTS];
+    TEST_ASSERT_EQUAL_INT(3, parseTankProfile("0:1200,30:1800,60:2000", points, Tank::MAX_PROFILE_POINTS));
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, points[1].heightCm);
+    TEST_ASSERT_EQUAL_FLOAT(1800.0f, points[1].areaCm2);
+
+    TEST_ASSERT_EQUAL_INT(2, parseTankProfile("0:1.5e3, 42.5:1800", points, Tank::MAX_PROFILE_POINTS));
+    TEST_ASSERT_EQUAL_FLOAT(1500.0f, points[0].areaCm2);
+    TEST_ASSERT_EQUAL_FLOAT(42.5f, points[1].heightCm);
+
+    TEST_ASSERT_EQUAL_INT(0, parseTankProfile("", points, Tank::MAX_PROFILE_POINTS));
+}
+
+static void test_parse_profile_rejects(void) {
+    TankProfilePoint points[Tank::MAX_PROFILE_POINTS];
+    const char* bad[] = {
+        "abc",
+        "10",               // No area
+        "10:",
+        ":100",
+        "0:100;10:200",     // Wrong separator
+        "0:100,10:200x",
+        "0:100,0:200",      // Height must increase
+        "20:100,10:200",
+        "0:-5",             // Negative area
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(-1, parseTankProfile(bad[i], points, Tank::MAX_PROFILE_POINTS));
+    }
+
+    // More pairs than fit
+    TEST_ASSERT_EQUAL_INT(2, parseTankProfile("0:1,1:1", points, 2));
+    TEST_ASSERT_EQUAL_INT(-1, parseTankProfile("0:1,1:1,2:1", points, 2));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rectangular_is_linear);
+    RUN_TEST(test_vertical_cylinder_volume);
+    RUN_TEST(test_horizontal_cylinder_segments);
+    RUN_TEST(test_cone_frustum_volume);
+    RUN_TEST(test_profile_volume);
+    RUN_TEST(test_unknown_dimensions_give_percent_only);
+    RUN_TEST(test_clamps_outside_the_fill_range);
+    RUN_TEST(test_invalid_geometry);
+    RUN_TEST(test_percent_table);
+    RUN_TEST(test_shared_models);
+    RUN_TEST(test_parse_profile);
+    RUN_TEST(test_parse_profile_rejects);
+    return UNITY_END();
+}